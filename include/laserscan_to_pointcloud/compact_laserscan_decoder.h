@@ -0,0 +1,62 @@
+#pragma once
+
+/**\file compact_laserscan_decoder.h
+ * \brief Conversion of CompactLaserScans (uint16 millimeter ranges) into the LaserScans projected by the assembler
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <macros>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </macros>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// std includes
+#include <stdint.h>
+#include <map>
+
+// ROS includes
+#include <sensor_msgs/LaserScan.h>
+
+// external includes
+#include <Eigen/Core>
+
+// project includes
+#include <laserscan_to_pointcloud/CompactLaserScan.h>
+#include <laserscan_to_pointcloud/CompactLaserScanGeometry.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+namespace laserscan_to_pointcloud {
+// #######################################################################   CompactLaserScanDecoder   #########################################################################
+/**
+ * \brief Builds the LaserScan of a CompactLaserScan using the geometry (angles, time increment and range limits) received for its geometry_id.
+ * Ranges and intensities are converted to float in one vectorized pass over the integer arrays (beams without return become 0, which is rejected by the range cutoff).
+ */
+class CompactLaserScanDecoder {
+	// ========================================================================   <public-section>   ===========================================================================
+	public:
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		CompactLaserScanDecoder() {}
+		virtual ~CompactLaserScanDecoder() {}
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <CompactLaserScanDecoder-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		inline void addGeometry(const CompactLaserScanGeometry& geometry) { geometries_[geometry.geometry_id] = geometry; }
+		inline bool hasGeometry(uint32_t geometry_id) const { return geometries_.find(geometry_id) != geometries_.end(); }
+
+		/** Returns the LaserScan of the compact scan (reused in the next call when no one else holds it) or NULL when its geometry was not received yet */
+		sensor_msgs::LaserScanConstPtr decode(const CompactLaserScan& compact_laser_scan);
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </CompactLaserScanDecoder-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+	// ========================================================================   </public-section>   ==========================================================================
+
+
+	// ========================================================================   <protected-section>   ========================================================================
+	protected:
+		std::map<uint32_t, CompactLaserScanGeometry> geometries_;
+		sensor_msgs::LaserScanPtr laser_scan_;
+	// ========================================================================   </protected-section>  ========================================================================
+};
+} /* namespace laserscan_to_pointcloud */
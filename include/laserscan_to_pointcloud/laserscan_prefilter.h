@@ -0,0 +1,90 @@
+#pragma once
+
+/**\file laserscan_prefilter.h
+ * \brief Scan space filters (shadow / veiling points, median outliers and intensity thresholds) computed before the LaserScan projection
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <macros>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </macros>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// std includes
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+// ROS includes
+#include <sensor_msgs/LaserScan.h>
+
+// external includes
+#include <Eigen/Core>
+
+// project includes
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+namespace laserscan_to_pointcloud {
+// #########################################################################   LaserScanPrefilter   ############################################################################
+/**
+ * \brief Computes a validity mask for the measurements of a LaserScan using its ranges and intensities arrays, without copying the LaserScan.
+ * - shadow filter: rejects the measurements whose angle to a neighbor (within shadow_window beams) is outside [min_angle, max_angle] (veiling points in depth discontinuities)
+ * - median filter: rejects the measurements whose range differs more than max_range_difference from the median of the 2 * median_window + 1 measurements around them
+ * - intensity thresholds: rejects the measurements with intensity below min_intensity or above max_intensity (thresholds <= 0 are disabled)
+ */
+class LaserScanPrefilter {
+	// ========================================================================   <public-section>   ===========================================================================
+	public:
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		LaserScanPrefilter();
+		virtual ~LaserScanPrefilter() {}
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <LaserScanPrefilter-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		/** Computes the validity mask of all the measurements of the laser scan. Returns false (without updating the mask) when no filter is enabled. */
+		bool computeValidityMask(const sensor_msgs::LaserScan& laser_scan);
+		inline bool isMeasurementValid(size_t measurement_index) const { return validity_mask_(measurement_index); }
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </LaserScanPrefilter-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <gets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		inline bool isEnabled() const { return isShadowFilterEnabled() || isMedianFilterEnabled() || isIntensityFilterEnabled(); }
+		inline bool isShadowFilterEnabled() const { return shadow_window_ > 0; }
+		inline bool isMedianFilterEnabled() const { return median_window_ > 0; }
+		inline bool isIntensityFilterEnabled() const { return min_intensity_ > 0.0f || max_intensity_ > 0.0f; }
+		inline const Eigen::Array<bool, Eigen::Dynamic, 1>& getValidityMask() const { return validity_mask_; }
+		inline size_t getNumberOfRejectedMeasurements() const { return number_of_rejected_measurements_; }
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </gets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <sets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		/** Angles (in radians) between the laser ray and the line to the neighbor measurement (window of 0 disables the filter) */
+		void setShadowFilter(double min_angle, double max_angle, size_t shadow_window);
+		inline void setMedianFilter(size_t median_window, double max_range_difference) { median_window_ = median_window; median_max_range_difference_ = (float)max_range_difference; }
+		inline void setIntensityThresholds(double min_intensity, double max_intensity) { min_intensity_ = (float)min_intensity; max_intensity_ = (float)max_intensity; }
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </sets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+	// ========================================================================   </public-section>   ==========================================================================
+
+
+	// ========================================================================   <protected-section>   ========================================================================
+	protected:
+		void rejectShadowMeasurements(const Eigen::Map<const Eigen::ArrayXf>& ranges, float angle_increment);
+		void rejectMedianOutliers(const Eigen::Map<const Eigen::ArrayXf>& ranges);
+
+		size_t shadow_window_;
+		float shadow_sin_min_angle_, shadow_cos_min_angle_;
+		float shadow_sin_max_angle_, shadow_cos_max_angle_;
+		size_t median_window_;
+		float median_max_range_difference_;
+		float min_intensity_;
+		float max_intensity_;
+
+		Eigen::Array<bool, Eigen::Dynamic, 1> rejected_measurements_;
+		Eigen::Array<bool, Eigen::Dynamic, 1> validity_mask_;
+		std::vector<float> median_window_ranges_;
+		size_t number_of_rejected_measurements_;
+	// ========================================================================   </protected-section>  ========================================================================
+};
+} /* namespace laserscan_to_pointcloud */
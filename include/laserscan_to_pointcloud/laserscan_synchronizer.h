@@ -0,0 +1,83 @@
+#pragma once
+
+/**\file laserscan_synchronizer.h
+ * \brief Approximate time synchronizer of LaserScans received in several topics
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <macros>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </macros>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// std includes
+#include <vector>
+#include <algorithm>
+
+// ROS includes
+#include <ros/ros.h>
+#include <sensor_msgs/LaserScan.h>
+
+// external includes
+
+// project includes
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+namespace laserscan_to_pointcloud {
+// ########################################################################   LaserScanSynchronizer   ##########################################################################
+/**
+ * \brief Groups LaserScans from several topics (one preallocated slot for each topic index) using an approximate time policy.
+ * A group is complete when all slots are filled and the time difference between the oldest and newest scan is within the maximum skew.
+ * Scans that are replaced in their slot or that are too old in relation to the newest scan (including scans that arrive out of order) are dropped and counted per topic.
+ */
+class LaserScanSynchronizer {
+	// ========================================================================   <public-section>   ===========================================================================
+	public:
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		LaserScanSynchronizer(size_t number_of_topics = 0, double max_time_skew = 0.1);
+		virtual ~LaserScanSynchronizer() {}
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <LaserScanSynchronizer-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		/**
+		 * Adds a LaserScan to the slot of its topic.
+		 * @return true if a complete group of synchronized LaserScans is available in getSynchronizedLaserScans()
+		 */
+		bool addLaserScan(size_t topic_index, const sensor_msgs::LaserScanConstPtr& laser_scan);
+		void clearSynchronizedLaserScans();
+		void resetNumberOfDroppedLaserScans();
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </LaserScanSynchronizer-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <gets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		inline const std::vector<sensor_msgs::LaserScanConstPtr>& getSynchronizedLaserScans() const { return laser_scans_slots_; }
+		inline size_t getNumberOfTopics() const { return laser_scans_slots_.size(); }
+		inline size_t getNumberOfFilledSlots() const { return number_of_filled_slots_; }
+		inline size_t getNumberOfDroppedLaserScans(size_t topic_index) const { return number_of_dropped_laser_scans_[topic_index]; }
+		inline size_t getTotalNumberOfDroppedLaserScans() const { return total_number_of_dropped_laser_scans_; }
+		inline double getMaxTimeSkew() const { return max_time_skew_.toSec(); }
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </gets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <sets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		void setNumberOfTopics(size_t number_of_topics);
+		inline void setMaxTimeSkew(double max_time_skew) { max_time_skew_.fromSec(max_time_skew); }
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </sets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+	// ========================================================================   </public-section>   ==========================================================================
+
+
+	// ========================================================================   <protected-section>   ========================================================================
+	protected:
+		void dropLaserScan(size_t topic_index);
+		void countDroppedLaserScan(size_t topic_index);
+
+		std::vector<sensor_msgs::LaserScanConstPtr> laser_scans_slots_;
+		std::vector<size_t> number_of_dropped_laser_scans_;
+		size_t number_of_filled_slots_;
+		size_t total_number_of_dropped_laser_scans_;
+		ros::Duration max_time_skew_;
+	// ========================================================================   </protected-section>  ========================================================================
+};
+} /* namespace laserscan_to_pointcloud */
@@ -51,9 +51,10 @@ class LaserScanToPCLPointcloud : public LaserScanToPointcloud {
 
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <LaserScanToPCLPointcloud-virtual-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 		virtual void initNewPointCloud(size_t number_of_reserved_points = 684) /*override*/;
-		virtual void addMeasureToPointCloud(const tf2::Vector3& point, float intensity) /*override*/;
-		virtual void setupPointCloudForNewLaserScan(size_t number_laser_scan_points) /*override*/;
+		virtual void addMeasureToPointCloud(const tf2::Vector3& point, float intensity, size_t measurement_index, float range) /*override*/;
+		virtual void setupPointCloudForNewLaserScan(size_t number_laser_scan_points, size_t number_of_additional_echoes) /*override*/;
 		virtual void finishLaserScanIntegration() /*override*/;
+		virtual void finishPointCloud() /*override*/;
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </LaserScanToPCLPointcloud-virtual-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <gets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -16,10 +16,17 @@
 // std includes
 #include <cmath>
 #include <string>
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <stdint.h>
+#include <string.h>
 
 // ROS includes
 #include <ros/ros.h>
 #include <sensor_msgs/LaserScan.h>
+#include <sensor_msgs/MultiEchoLaserScan.h>
+#include <sensor_msgs/PointCloud2.h>
 #include <geometry_msgs/TransformStamped.h>
 #include <tf2/LinearMath/Quaternion.h>
 #include <tf2/LinearMath/Vector3.h>
@@ -32,13 +39,18 @@
 // project includes
 #include <laserscan_to_pointcloud/tf_collector.h>
 #include <laserscan_to_pointcloud/polar_to_cartesian_matrix_cache.h>
+#include <laserscan_to_pointcloud/laserscan_prefilter.h>
+#include <laserscan_to_pointcloud/multi_echo_laserscan_selector.h>
+#include <laserscan_to_pointcloud/region_of_interest.h>
+#include <laserscan_to_pointcloud/self_filter.h>
+#include <laserscan_to_pointcloud/range_image_builder.h>
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 
 namespace laserscan_to_pointcloud {
 // ########################################################################   LaserScanToPointcloud   ##########################################################################
 /**
- * \brief PointCloud2 builder from LaserScans
+ * \brief PointCloud2 builder from LaserScans (and from PointCloud2 of 3D lidars with per point time, deskewed with the same TF slices interpolation)
  */
 class LaserScanToPointcloud {
 	// ========================================================================   <public-section>   ===========================================================================
@@ -60,15 +72,30 @@ class LaserScanToPointcloud {
 
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <LaserScanToPointcloud-virtual-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 		virtual void initNewPointCloud(size_t number_of_reserved_points = 684) = 0;
-		virtual void addMeasureToPointCloud(const tf2::Vector3& point, float intensity) = 0;
-		virtual void setupPointCloudForNewLaserScan(size_t number_laser_scan_points) = 0;
+		virtual void addMeasureToPointCloud(const tf2::Vector3& point, float intensity, size_t measurement_index, float range) = 0; ///> measurement_index is the index of the beam in the LaserScan
+		virtual void addInvalidMeasureToPointCloud() {} ///> called for each discarded beam (allows organized clouds to keep a placeholder for it)
+		virtual void setupPointCloudForNewLaserScan(size_t number_laser_scan_points, size_t number_of_additional_echoes) = 0; ///> additional echoes are projected after the selected echo of their beam (with isProjectingAdditionalEcho())
 		virtual void finishLaserScanIntegration() = 0;
+		virtual void finishPointCloud() = 0;
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </LaserScanToPointcloud-virtual-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <LaserScanToPointcloud-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
-		bool integrateLaserScanWithShpericalLinearInterpolation(const sensor_msgs::LaserScanConstPtr& laser_scan);
+		/**
+		 * Projects the LaserScan into the current cloud.
+		 * When multi_echo_laser_scan is given, laser_scan must be the one returned by getMultiEchoLaserScanSelector().selectEchoes() for it
+		 * and with MultiEchoLaserScanSelector::ECHO_POLICY_ALL the remaining echoes of each projected beam are transformed with the transform of the beam.
+		 */
+		bool integrateLaserScanWithShpericalLinearInterpolation(const sensor_msgs::LaserScanConstPtr& laser_scan, const sensor_msgs::MultiEchoLaserScan* multi_echo_laser_scan = NULL);
+		/**
+		 * Deskews and projects a PointCloud2 (float32 x, y, z and optional intensity) into the current cloud as if it was a LaserScan with one beam per point.
+		 * The pose of each point is interpolated between the sensor poses of the TF slices around its time (time field in seconds after the cloud stamp, multiplied by the time field scale).
+		 * Clouds without the time field are transformed with the sensor pose at their stamp.
+		 */
+		bool integratePointCloudWithShpericalLinearInterpolation(const sensor_msgs::PointCloud2ConstPtr& pointcloud);
 		bool lookForTransformWithRecovery(tf2::Vector3& translation_out, tf2::Quaternion& rotation_out, const std::string& target_frame, const std::string& source_frame, const ros::Time& time, const ros::Duration& timeout = ros::Duration(0.2));
 		bool lookForTransformWithRecovery(tf2::Transform& point_transform_out, const std::string& target_frame, const std::string& source_frame, const ros::Time& time, const ros::Duration& timeout = ros::Duration(0.2));
+		/** Updates the poses of the self filter primitives in the target frame (keeps the previous pose of the primitives whose TF is not available) */
+		bool updateSelfFilterPrimitivesPoses(const ros::Time& time, const ros::Duration& timeout = ros::Duration(0.2));
 		bool updatePointTransformWithMotionEstimation(tf2::Transform& motion_estimation_transform_in_out, tf2::Vector3& translation_in_out, tf2::Quaternion& rotation_in_out, const std::string& motion_estimation_target_frame, const std::string& motion_estimation_source_frame, const ros::Time& time, const ros::Duration& timeout = ros::Duration(0.2));
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </LaserScanToPointcloud-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -84,9 +111,23 @@ class LaserScanToPointcloud {
 		inline size_t getNumberOfPointcloudsCreated() const { return number_of_pointclouds_created_; }
 		inline size_t getNumberOfPointsInCloud() const { return number_of_points_in_cloud_; }
 		inline size_t getNumberOfScansAssembledInCurrentPointcloud() const { return number_of_scans_assembled_in_current_pointcloud_; }
+		inline const ros::Time& getCurrentLaserScanStartTime() const { return current_laser_scan_start_time_; }
+		inline const ros::Time& getCurrentLaserScanEndTime() const { return current_laser_scan_end_time_; }
+		inline double getCurrentLaserScanTimeIncrement() const { return current_laser_scan_time_increment_; }
+		inline size_t getCurrentLaserScanNumberOfBeams() const { return current_laser_scan_number_of_beams_; } ///> beams of the LaserScan (or points of the PointCloud2) being added, before the beam subsampling
+		inline size_t getLaserId() const { return laser_id_; }
+		inline size_t getCurrentEchoIndex() const { return current_echo_index_; } ///> echo of the measurement being added (0 for LaserScans)
+		inline bool isProjectingAdditionalEcho() const { return projecting_additional_echo_; } ///> true while adding the echoes after the selected echo of a beam
+		inline bool isIntegratingPointCloud() const { return integrating_pointcloud_; } ///> true while adding the points of a PointCloud2
+		inline double getCurrentPointTimeOffset() const { return current_point_time_offset_; } ///> seconds since getCurrentLaserScanStartTime() of the PointCloud2 point being added
+		inline const std::string& getPointCloudTimeField() const { return pointcloud_time_field_; }
+		inline double getPointCloudTimeFieldScale() const { return pointcloud_time_field_scale_; }
 		inline ros::Duration getTfLookupTimeout() const { return tf_lookup_timeout_; }
 		inline int getNumberOfTfQueriesForSphericalInterpolation() const { return number_of_tf_queries_for_spherical_interpolation_; }
 		inline bool isRemoveInvalidMeasurements() const { return remove_invalid_measurements_; }
+		inline size_t getBeamDecimationStride() const { return beam_decimation_stride_; }
+		inline double getTargetAngularResolution() const { return target_angular_resolution_; }
+		inline double getRangeAdaptivePointSpacing() const { return range_adaptive_point_spacing_; }
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </gets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <sets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -100,16 +141,52 @@ class LaserScanToPointcloud {
 		inline void incrementNumberOfPointCloudsCreated() { ++number_of_pointclouds_created_; }
 		inline void resetNumberOfPointsInCloud() { number_of_points_in_cloud_ = 0; }
 		inline void resetNumberOfScansAsembledInCurrentCloud() { number_of_scans_assembled_in_current_pointcloud_ = 0; }
+		/** Id of the laser (for example, the index of its topic) of the next LaserScans to be integrated */
+		inline void setLaserId(size_t laser_id) { laser_id_ = laser_id; }
 		inline void setTFLookupTimeout(double tf_lookup_timeout) { tf_lookup_timeout_.fromSec(tf_lookup_timeout); }
 		inline TFCollector& getTfCollector() { return tf_collector_; }
+		inline LaserScanPrefilter& getLaserScanPrefilter() { return laserscan_prefilter_; } ///> measurements rejected by the prefilter are not projected
+		inline RegionOfInterest& getRegionOfInterest() { return region_of_interest_; } ///> points outside the region (in the target frame) are discarded before reaching the cloud
+		inline SelfFilter& getSelfFilter() { return self_filter_; } ///> points inside the robot collision primitives are discarded before reaching the cloud
+		inline RangeImageBuilder& getRangeImageBuilder() { return range_image_builder_; } ///> when enabled, the range images are restarted with the first LaserScan of each cloud
+		inline MultiEchoLaserScanSelector& getMultiEchoLaserScanSelector() { return multi_echo_laserscan_selector_; }
 		inline void setNumberOfTfQueriesForSphericalInterpolation(int number_of_tf_queries_for_spherical_interpolation) { number_of_tf_queries_for_spherical_interpolation_ = number_of_tf_queries_for_spherical_interpolation; }
 		inline void setRemoveInvalidMeasurements(bool removeInvalidMeasurements) { remove_invalid_measurements_ = removeInvalidMeasurements; }
+		/** Only projects one in every beam_decimation_stride measurements of each LaserScan */
+		inline void setBeamDecimationStride(size_t beam_decimation_stride) { beam_decimation_stride_ = std::max(beam_decimation_stride, (size_t)1); }
+		/** Selects the LaserScan measurements closest to a grid with target_angular_resolution radians (0 projects all the measurements) */
+		inline void setTargetAngularResolution(double target_angular_resolution) { target_angular_resolution_ = target_angular_resolution; }
+		/** Skips the measurements that would be closer than range_adaptive_point_spacing meters (arc length at their range) to the previous projected measurement (0 disables) */
+		inline void setRangeAdaptivePointSpacing(double range_adaptive_point_spacing) { range_adaptive_point_spacing_ = range_adaptive_point_spacing; }
+		/** Name of the PointCloud2 field with the time of each point (empty disables the deskew) */
+		inline void setPointCloudTimeField(const std::string& pointcloud_time_field) { pointcloud_time_field_ = pointcloud_time_field; }
+		/** Converts the values of the time field to seconds (for example, 1e-9 for nanoseconds) */
+		inline void setPointCloudTimeFieldScale(double pointcloud_time_field_scale) { pointcloud_time_field_scale_ = pointcloud_time_field_scale; }
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </sets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 	// ========================================================================   </public-section>   ==========================================================================
 
 
 	// ========================================================================   <protected-section>   ========================================================================
 	protected:
+		inline bool isTransformedPointAccepted(const tf2::Vector3& transformed_point) const {
+			return (!remove_invalid_measurements_ || (boost::math::isfinite(transformed_point.x()) && boost::math::isfinite(transformed_point.y()) && boost::math::isfinite(transformed_point.z()))) &&
+					region_of_interest_.contains(transformed_point) && !self_filter_.contains(transformed_point);
+		}
+
+		/** Looks for the sensor pose at slice_time_in_out, skipping to the next slices while their TF is not available (returns false after the last slice) */
+		bool lookForNextSliceTransform(size_t& slice_number_in_out, ros::Time& slice_time_in_out, const ros::Duration& slice_time_increment, const std::string& laser_frame, tf2::Transform& motion_estimation_transform_in_out, tf2::Vector3& translation_in_out, tf2::Quaternion& rotation_in_out);
+		/** Collects the sensor poses of all the TF slices of the scan being integrated (and the self filter primitives poses at each slice, without waiting for their TF after the first slice) */
+		void collectSlicesTransforms(bool interpolate_tfs, const ros::Time& scan_start_time, double scan_duration, const ros::Time& tf_query_time, const std::string& laser_frame, tf2::Transform& motion_estimation_transform_in_out, const tf2::Transform& point_transform);
+		bool collectSelfFilterPrimitivesFramesTransforms(const ros::Time& time, const ros::Duration& timeout);
+		void applySliceSelfFilterPrimitivesPoses(size_t slice_index);
+		/** Interpolates the sensor pose at time_offset seconds after the scan start between the collected slices (moving the slice cursor and the self filter primitives poses to the slice before time_offset) */
+		void interpolateSlicesTransforms(double time_offset, size_t& slice_index_in_out, tf2::Transform& point_transform_out);
+		static double readPointField(const uint8_t* field_data, uint8_t datatype);
+		static size_t getPointFieldDatatypeSize(uint8_t datatype); ///> 0 for unknown datatypes
+		static bool isPointFieldInsidePoint(const sensor_msgs::PointField* field, size_t point_step);
+		static const sensor_msgs::PointField* findPointField(const sensor_msgs::PointCloud2& pointcloud, const std::string& name);
+		/** The rows of PointCloud2 with height > 1 are indexed with their row_step (which may include padding) */
+		static inline const uint8_t* getPointData(const uint8_t* data, size_t point_index, size_t width, size_t point_step, size_t row_step) { return data + (point_index / width) * row_step + (point_index % width) * point_step; }
 	// ========================================================================   </protected-section>  ========================================================================
 
 	// ========================================================================   <private-section>   ==========================================================================
@@ -126,11 +203,35 @@ class LaserScanToPointcloud {
 		int number_of_tf_queries_for_spherical_interpolation_;
 		ros::Duration tf_lookup_timeout_;
 		bool remove_invalid_measurements_;
+		size_t beam_decimation_stride_;
+		double target_angular_resolution_;
+		double range_adaptive_point_spacing_;
+		std::string pointcloud_time_field_;
+		double pointcloud_time_field_scale_;
+		LaserScanPrefilter laserscan_prefilter_;
+		RegionOfInterest region_of_interest_;
+		SelfFilter self_filter_;
+		RangeImageBuilder range_image_builder_;
+		MultiEchoLaserScanSelector multi_echo_laserscan_selector_;
 
 		// state fields
 		size_t number_of_pointclouds_created_;
 		size_t number_of_points_in_cloud_;
 		size_t number_of_scans_assembled_in_current_pointcloud_;
+		ros::Time current_laser_scan_start_time_;
+		ros::Time current_laser_scan_end_time_;
+		double current_laser_scan_time_increment_;
+		size_t current_laser_scan_number_of_beams_;
+		size_t laser_id_;
+		size_t current_echo_index_;
+		bool projecting_additional_echo_;
+		bool integrating_pointcloud_;
+		double current_point_time_offset_;
+		std::vector<double> slices_time_offsets_; ///> seconds since the start of the LaserScan or PointCloud2 being integrated
+		std::vector<tf2::Vector3> slices_translations_;
+		std::vector<tf2::Quaternion> slices_rotations_;
+		std::vector<tf2::Transform> slices_self_filter_frames_transforms_; ///> getNumberOfPrimitives() frame transforms per slice
+		std::vector<bool> slices_self_filter_frames_transforms_valid_;
 		PolarToCartesianCache polar_to_cartesian_cache_;
 
 		// communication fields
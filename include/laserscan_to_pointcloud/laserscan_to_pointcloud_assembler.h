@@ -15,8 +15,8 @@
 #include <vector>
 #include <string>
 #include <sstream>
+#include <utility>
 #include <algorithm>
-#include <map>
 #include <cmath>
 
 // ROS includes
@@ -25,17 +25,34 @@
 #include <tf2/LinearMath/Quaternion.h>
 #include <tf2/LinearMath/Vector3.h>
 #include <sensor_msgs/LaserScan.h>
+#include <sensor_msgs/MultiEchoLaserScan.h>
 #include <sensor_msgs/PointCloud2.h>
+#include <sensor_msgs/Image.h>
 #include <sensor_msgs/Imu.h>
 #include <geometry_msgs/Twist.h>
 #include <geometry_msgs/Vector3.h>
 #include <nav_msgs/Odometry.h>
+#include <nav_msgs/Path.h>
 #include <dynamic_reconfigure/server.h>
 
 // external libs includes
+#include <boost/thread/recursive_mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/shared_array.hpp>
+#include <boost/circular_buffer.hpp>
 
 // project includes
 #include <laserscan_to_pointcloud/laserscan_to_ros_pointcloud.h>
+#include <laserscan_to_pointcloud/pointcloud_message_pool.h>
+#include <laserscan_to_pointcloud/laserscan_synchronizer.h>
+#include <laserscan_to_pointcloud/compact_laserscan_decoder.h>
+#include <laserscan_to_pointcloud/shared_memory_pointcloud.h>
+#include <laserscan_to_pointcloud/pointcloud_compression.h>
+#include <laserscan_to_pointcloud/SharedMemoryPointCloud.h>
+#include <laserscan_to_pointcloud/CompressedPointCloud.h>
+#include <laserscan_to_pointcloud/PointCloudChunk.h>
 #include <laserscan_to_pointcloud/LaserScanToPointcloudAssemblerConfig.h>
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -49,9 +66,41 @@ class LaserScanToPointcloudAssembler {
 	// ========================================================================   <public-section>   ===========================================================================
 	public:
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <typedefs>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		/** Copy of the assembled cloud in another frame, which must be static relative to the target frame (each scan is moved from the target frame with the rigid transform between the frames at the scan time) */
+		struct AdditionalTargetFrame {
+			std::string frame_id_;
+			ros::Publisher publisher_;
+			sensor_msgs::PointCloud2Ptr pointcloud_;
+			PointCloudMessagePool pointcloud_pool_;
+			size_t number_of_dropped_scans_;
+		};
+
+		/** Input message kept by lazy processing while no one subscribes the clouds (only the pointer of its input type is set) */
+		struct LazyProcessingInput {
+			LazyProcessingInput() : topic_index_(0) {}
+			LazyProcessingInput(const sensor_msgs::LaserScanConstPtr& laser_scan, size_t topic_index) : laser_scan_(laser_scan), topic_index_(topic_index) {}
+			LazyProcessingInput(const sensor_msgs::MultiEchoLaserScanConstPtr& multi_echo_laser_scan, size_t topic_index) : multi_echo_laser_scan_(multi_echo_laser_scan), topic_index_(topic_index) {}
+			LazyProcessingInput(const sensor_msgs::PointCloud2ConstPtr& pointcloud, size_t topic_index) : pointcloud_(pointcloud), topic_index_(topic_index) {}
+			LazyProcessingInput(const laserscan_to_pointcloud::CompactLaserScanConstPtr& compact_laser_scan, size_t topic_index) : compact_laser_scan_(compact_laser_scan), topic_index_(topic_index) {}
+
+			sensor_msgs::LaserScanConstPtr laser_scan_;
+			sensor_msgs::MultiEchoLaserScanConstPtr multi_echo_laser_scan_;
+			sensor_msgs::PointCloud2ConstPtr pointcloud_;
+			laserscan_to_pointcloud::CompactLaserScanConstPtr compact_laser_scan_;
+			size_t topic_index_;
+		};
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </typedefs>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <enums>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		/** Degradation steps applied to LaserScans that are older than a fraction of max_laser_scan_age (each level includes the previous ones) */
+		enum LoadSheddingLevel {
+			LOAD_SHEDDING_NONE = 0,
+			LOAD_SHEDDING_BEAM_DECIMATION,
+			LOAD_SHEDDING_FEWER_INTERPOLATION_SLICES,
+			LOAD_SHEDDING_SKIP_INTENSITY,
+			LOAD_SHEDDING_DROP_LASER_SCAN,
+			LOAD_SHEDDING_NUMBER_OF_LEVELS
+		};
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </enums>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constants>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -62,10 +111,53 @@ class LaserScanToPointcloudAssembler {
 		virtual ~LaserScanToPointcloudAssembler();
 
 		void setupLaserScansSubscribers(std::string laser_scan_topics);
+		void setupMultiEchoLaserScansSubscribers(std::string multi_echo_laser_scan_topics);
+		void setupPointCloudsSubscribers(std::string pointcloud_topics);
+		void setupCompactLaserScansSubscribers(std::string compact_laser_scan_topics);
 		void setupRecoveryInitialPose();
+		void setupLevelsOfDetail(std::string level_of_detail_voxel_sizes, std::string level_of_detail_pointcloud_publish_topics);
+		void updateLevelsOfDetailWithSubscribers();
+		ros::Publisher advertisePointCloudPublisher(const std::string& pointcloud_publish_topic);
+		/** Advertises the cloud topic and the topics derived from it (shared memory descriptors, chunks, additional target frames and compressed clouds) */
+		void advertisePointCloudPublishers();
+		bool hasPointCloudSubscribers();
+		bool hasMainPointCloudSubscribers();
+		void processPointCloudSubscriberConnection(const ros::SingleSubscriberPublisher& subscriber_publisher);
+		/** With lazy processing, keeps the input in the history while no one subscribes the clouds (returns true), or processes the history before the input (returns false) */
+		bool deferLazyProcessingInput(const LazyProcessingInput& input);
+		void processLazyProcessingHistory();
 		void startAssemblingLaserScans();
 		void stopAssemblingLaserScans();
-		void processLaserScan(const sensor_msgs::LaserScanConstPtr& laser_scan);
+		/** Stops the recovery pose setup from waiting for TFs and makes a startAssemblingLaserScans() that is still running return without subscribing */
+		void cancelStartup();
+		bool isStartupCancelled();
+		void processLaserScan(const sensor_msgs::LaserScanConstPtr& laser_scan, size_t laser_scan_topic_index = 0);
+		void processMultiEchoLaserScan(const sensor_msgs::MultiEchoLaserScanConstPtr& multi_echo_laser_scan, size_t multi_echo_laser_scan_topic_index = 0);
+		void processPointCloud(const sensor_msgs::PointCloud2ConstPtr& pointcloud, size_t pointcloud_topic_index = 0);
+		void processCompactLaserScan(const laserscan_to_pointcloud::CompactLaserScanConstPtr& compact_laser_scan, size_t compact_laser_scan_topic_index = 0);
+		void processCompactLaserScanGeometry(const laserscan_to_pointcloud::CompactLaserScanGeometryConstPtr& compact_laser_scan_geometry, size_t compact_laser_scan_topic_index = 0);
+		/** When multi_echo_laser_scan is given, laser_scan has its selected echoes (see MultiEchoLaserScanSelector) */
+		void integrateLaserScan(const sensor_msgs::LaserScanConstPtr& laser_scan, const sensor_msgs::MultiEchoLaserScan* multi_echo_laser_scan = NULL);
+		void integrateLaserScanInRollingWindow(const sensor_msgs::LaserScanConstPtr& laser_scan, bool publish_pointcloud, const sensor_msgs::MultiEchoLaserScan* multi_echo_laser_scan = NULL);
+		/** Deskews a PointCloud2 from a 3D lidar and integrates it as one scan of the current cloud (or of the rolling window) */
+		void integratePointCloud(const sensor_msgs::PointCloud2ConstPtr& pointcloud);
+		void startNewPointCloudIfNeeded(size_t number_of_points_per_scan);
+		void publishPointCloudIfAssembled(const ros::Time& scan_end_time);
+		void publishRollingWindowPointCloud(const ros::Time& scan_end_time, bool publish_pointcloud);
+		LoadSheddingLevel computeLoadSheddingLevel(const ros::Time& scan_stamp) const;
+		bool applyLoadSheddingPolicy(const ros::Time& scan_stamp);
+		void publishPointCloud(const ros::Time& pointcloud_stamp);
+		void publishPointCloudInSharedMemory(const sensor_msgs::PointCloud2& pointcloud);
+		void publishPointCloudChunk(const ros::Time& chunk_stamp, bool end_of_cloud);
+		void setupAdditionalTargetFrames(std::string additional_target_frames);
+		void startAdditionalTargetFramesPointClouds();
+		void addLastScanToAdditionalTargetFrames(const ros::Time& scan_time);
+		void publishAdditionalTargetFramesPointClouds(const ros::Time& pointcloud_stamp);
+		void queuePointCloudForCompression(const sensor_msgs::PointCloud2ConstPtr& pointcloud);
+		void compressPointClouds();
+		void stopPointCloudCompression();
+		void armCloudAssemblyTimeoutTimer();
+		void processCloudAssemblyTimeout(const ros::SteadyTimerEvent& timer_event);
 		void adjustAssemblyConfiguration(const geometry_msgs::Vector3& linear_velocity, const geometry_msgs::Vector3& angular_velocity);
 		void adjustAssemblyConfigurationFromTwist(const geometry_msgs::TwistConstPtr& twist);
 		void adjustAssemblyConfigurationFromOdometry(const nav_msgs::OdometryConstPtr& odometry);
@@ -92,6 +184,9 @@ class LaserScanToPointcloudAssembler {
 	private:
 		// assembler config fields
 		std::string laser_scan_topics_;
+		std::string multi_echo_laser_scan_topics_;
+		std::string pointcloud_topics_;
+		std::string compact_laser_scan_topics_;
 		std::string pointcloud_publish_topic_;
 		int number_of_scans_to_assemble_per_cloud_;
 		ros::Duration timeout_for_cloud_assembly_;
@@ -105,15 +200,34 @@ class LaserScanToPointcloudAssembler {
 		double max_linear_velocity_;
 		double max_angular_velocity_;
 
+		// load shedding
+		ros::Duration max_laser_scan_age_;
+		int load_shedding_beam_decimation_stride_;
+		int laser_scans_subscribers_queue_size_;
+		int number_of_tf_queries_for_spherical_interpolation_;
+		LoadSheddingLevel current_load_shedding_level_;
+		std::vector<size_t> number_of_laser_scans_in_each_load_shedding_level_;
+		size_t number_of_pointclouds_dropped_by_age_;
+
+		// lazy processing (the input messages are only kept in a history while no one subscribes the clouds)
+		bool lazy_processing_;
+		boost::circular_buffer<LazyProcessingInput> lazy_processing_history_;
+
 		// laserscan_to_pointcloud_ config fields
 		LaserScanToROSPointcloud laserscan_to_pointcloud_;
 		bool include_laser_intensity_;
+		bool publish_pointcloud_;
 		bool enforce_reception_of_laser_scans_in_all_topics_;
-		std::map<std::string, sensor_msgs::LaserScanConstPtr> laser_scans_for_each_topic_frame_id_;
+		LaserScanSynchronizer laser_scan_synchronizer_;
+		size_t number_of_synchronization_drops_reported_;
 
 		// state fieds
 		size_t number_droped_laserscans_;
 		bool timeout_for_cloud_assembly_reached_;
+		bool pointcloud_published_;
+		ros::Time last_laser_scan_end_time_;
+		ros::SteadyTime cloud_assembly_deadline_;
+		boost::recursive_mutex assembler_mutex_; ///> serializes scan processing, reconfiguration and configuration updates (callbacks can run in multiple threads when used as nodelet)
 		ros::Time imu_last_message_stamp_;
 		geometry_msgs::Vector3 imu_linear_velocity;
 
@@ -121,11 +235,51 @@ class LaserScanToPointcloudAssembler {
 		ros::NodeHandlePtr node_handle_;
 		ros::NodeHandlePtr private_node_handle_;
 		std::vector<ros::Subscriber> laserscan_subscribers_;
+		std::vector<std::string> laserscan_topics_names_;
+		std::vector<ros::Subscriber> multi_echo_laserscan_subscribers_;
+		std::vector<ros::Subscriber> pointcloud_subscribers_;
+		std::vector<ros::Subscriber> compact_laserscan_subscribers_;
+		std::vector<ros::Subscriber> compact_laserscan_geometry_subscribers_;
+		std::vector<CompactLaserScanDecoder> compact_laserscan_decoders_;
 		ros::Publisher pointcloud_publisher_;
+		std::vector<std::string> level_of_detail_pointcloud_publish_topics_;
+		std::vector<ros::Publisher> level_of_detail_pointcloud_publishers_;
+		std::string range_image_publish_topic_;
+		ros::Publisher range_image_publisher_;
+		ros::Publisher range_image_intensity_publisher_;
+		ros::Publisher range_image_poses_publisher_;
+		SharedMemoryPointCloudPublisher shared_memory_pointcloud_publisher_;
+		ros::Publisher shared_memory_descriptor_publisher_;
+		ros::Publisher compressed_pointcloud_publisher_;
+		ros::Publisher pointcloud_chunks_publisher_;
+		ros::SteadyTimer cloud_assembly_timeout_timer_;
 		ros::Subscriber twist_subscriber_;
 		ros::Subscriber odometry_subscriber_;
 		ros::Subscriber imu_subscriber_;
 
+		// clouds in other frames built from the points projected into the target frame
+		std::vector<AdditionalTargetFrame> additional_target_frames_;
+
+		// streaming of the points of each LaserScan while the cloud is assembled
+		bool publish_pointcloud_chunks_;
+		uint32_t number_of_pointcloud_chunks_in_current_cloud_;
+
+		// compressed clouds (encoded in their own thread, which only takes the most recent cloud)
+		bool publish_compressed_pointcloud_;
+		PointCloudCompressor pointcloud_compressor_;
+		boost::thread compression_thread_;
+		boost::mutex compression_mutex_;
+		boost::condition_variable compression_condition_;
+		sensor_msgs::PointCloud2ConstPtr pointcloud_to_compress_;
+		boost::shared_array<uint8_t> pointcloud_to_compress_wire_buffer_; ///> keeps the data of wire buffer clouds from being recycled
+		const uint8_t* pointcloud_to_compress_data_;
+		bool compression_thread_shutdown_;
+		size_t number_of_pointclouds_skipped_by_compression_;
+
+		// startup (startAssemblingLaserScans can run in its own thread and wait several seconds for TFs)
+		boost::mutex startup_mutex_;
+		bool startup_cancelled_;
+
 		dynamic_reconfigure::Server<laserscan_to_pointcloud::LaserScanToPointcloudAssemblerConfig> dynamic_reconfigure_server_;
 	// ========================================================================   </private-section>  ==========================================================================
 };
@@ -1,7 +1,7 @@
 #pragma once
 
 /**\file laserscan_to_pointcloud_nodelet.h
- * \brief Description...
+ * \brief Nodelet wrapper of the LaserScanToPointcloudAssembler
  *
  * @version 1.0
  * @author Carlos Miguel Correia da Costa
@@ -14,10 +14,17 @@
 // std includes
 
 // ROS includes
+#include <ros/ros.h>
+#include <ros/callback_queue.h>
+#include <ros/spinner.h>
+#include <nodelet/nodelet.h>
 
 // external libs includes
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/thread.hpp>
 
 // project includes
+#include <laserscan_to_pointcloud/laserscan_to_pointcloud_assembler.h>
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>  </includes>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -25,9 +32,11 @@
 namespace laserscan_to_pointcloud {
 // ####################################################################   laserscan_to_pointcloud_nodelet   ####################################################################
 /**
- * \brief Description...
+ * \brief Nodelet that runs the LaserScanToPointcloudAssembler inside a nodelet manager.
+ * LaserScans are received and PointCloud2 are published as shared pointers, so no serialization happens between nodelets in the same manager.
+ * The assembler callbacks run in a dedicated multi-threaded callback queue (not the manager shared queues).
  */
-class LaserScanToPointcloudNodelet {
+class LaserScanToPointcloudNodelet : public nodelet::Nodelet {
 	// ========================================================================   <public-section>   ===========================================================================
 	public:
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <typedefs>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -42,6 +51,7 @@ class LaserScanToPointcloudNodelet {
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 		LaserScanToPointcloudNodelet();
 		virtual ~LaserScanToPointcloudNodelet();
+		virtual void onInit() /*override*/;
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <LaserScanToPointcloudNodelet-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -60,6 +70,12 @@ class LaserScanToPointcloudNodelet {
 
 	// ========================================================================   <private-section>   ==========================================================================
 	private:
+		ros::CallbackQueue callback_queue_; ///> declared first to be destroyed after the node handles and the assembler that use it
+		boost::shared_ptr<LaserScanToPointcloudAssembler> laserscan_to_pointcloud_assembler_;
+		ros::NodeHandlePtr node_handle_;
+		ros::NodeHandlePtr private_node_handle_;
+		boost::shared_ptr<ros::AsyncSpinner> callback_queue_spinner_;
+		boost::thread assembler_startup_thread_;
 	// ========================================================================   </private-section>  ==========================================================================
 };
 } /* namespace laserscan_to_pointcloud */
@@ -13,6 +13,8 @@
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>  <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 // std includes
 #include <stddef.h>
+#include <vector>
+#include <limits>
 
 // ROS includes
 #include <sensor_msgs/PointCloud2.h>
@@ -23,9 +25,28 @@
 
 // project includes
 #include <laserscan_to_pointcloud/laserscan_to_pointcloud.h>
+#include <laserscan_to_pointcloud/pointcloud2_wire_buffer.h>
+#include <laserscan_to_pointcloud/pointcloud_layout.h>
+#include <laserscan_to_pointcloud/pointcloud_message_pool.h>
+#include <laserscan_to_pointcloud/pointcloud_segment_ring.h>
+#include <laserscan_to_pointcloud/voxel_hash_grid.h>
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 namespace laserscan_to_pointcloud {
+// ######################################################################   PointCloudLevelOfDetail   #########################################################################
+/**
+ * \brief Voxel grid of one level of detail and the pool of the messages in which its clouds are published
+ */
+struct PointCloudLevelOfDetail {
+		PointCloudLevelOfDetail(double voxel_size) : voxel_grid_(voxel_size), enabled_(true) {}
+		virtual ~PointCloudLevelOfDetail() {}
+
+		VoxelHashGrid voxel_grid_;
+		PointCloudMessagePool pointcloud_pool_;
+		bool enabled_;
+};
+
+
 // ######################################################################   laserscan_to_ros_pointcloud   ######################################################################
 /**
  * \brief Description...
@@ -49,21 +70,112 @@ class LaserScanToROSPointcloud : public LaserScanToPointcloud {
 
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <LaserScanToROSPointcloud-virtual-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 		virtual void initNewPointCloud(size_t number_of_reserved_points = 684) /*override*/;
-		virtual void addMeasureToPointCloud(const tf2::Vector3& point, float intensity) /*override*/;
-		virtual void setupPointCloudForNewLaserScan(size_t number_laser_scan_points) /*override*/;
+		virtual void addMeasureToPointCloud(const tf2::Vector3& point, float intensity, size_t measurement_index, float range) /*override*/;
+		virtual void setupPointCloudForNewLaserScan(size_t number_laser_scan_points, size_t number_of_additional_echoes) /*override*/;
 		virtual void finishLaserScanIntegration()/*override*/;
+		virtual void finishPointCloud() /*override*/;
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </LaserScanToROSPointcloud-virtual-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <LaserScanToROSPointcloud-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		void updatePointCloudLayout();
+		/** Voxels whose centroid can not be represented in the layout are skipped */
+		static void writeVoxelCentroidsToPointCloud(const VoxelHashGrid& voxel_grid, sensor_msgs::PointCloud2& pointcloud, const PointCloudLayout& layout);
+
+		/** Writes the voxel centroids into data (with space for all the voxels) and returns the number of points written */
+		static size_t writeVoxelCentroids(const VoxelHashGrid& voxel_grid, uint8_t* data, const PointCloudLayout& layout);
+
+		/**
+		 * Builds the cloud of a level of detail after finishPointCloud() (with the same header as the main cloud).
+		 * @return NULL if the level is disabled
+		 */
+		sensor_msgs::PointCloud2Ptr buildLevelOfDetailPointCloud(size_t level_of_detail);
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </LaserScanToROSPointcloud-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <gets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 		inline sensor_msgs::PointCloud2Ptr getPointcloud() { return pointcloud_; }
+		inline const PointCloudLayout& getPointCloudLayout() const { return pointcloud_layout_; }
+		inline const ros::Time& getPointCloudStartTime() const { return pointcloud_start_time_; } ///> start time of the first LaserScan of the current cloud (reference of the time fields)
 		inline bool isIncludeLaserIntensity() const { return include_laser_intensity_; }
+		inline bool isVoxelGridEnabled() const { return voxel_grid_.getVoxelSize() > 0.0; }
+		inline bool isPointCloudDataEnabled() const { return pointcloud_data_enabled_; }
+		inline const VoxelHashGrid& getVoxelGrid() const { return voxel_grid_; }
+		inline size_t getNumberOfLevelsOfDetail() const { return levels_of_detail_.size(); }
+		inline const PointCloudLevelOfDetail& getLevelOfDetail(size_t level_of_detail) const { return levels_of_detail_[level_of_detail]; }
+		inline PointCloudMessagePool& getPointcloudPool() { return pointcloud_pool_; }
+		inline bool isWireBufferEnabled() const { return wire_buffer_enabled_; }
+		inline const PointCloud2WireBuffer& getWireBuffer() const { return wire_buffer_; } ///> has the serialized cloud after finishPointCloud() when the wire buffer is enabled
+		inline const PointCloudSegmentRing& getPointcloudSegmentRing() const { return pointcloud_segment_ring_; }
+		/** Points (with the layout of the main cloud) written by the last integrated LaserScan, valid until the next LaserScan (NULL in voxel grid mode or when the main cloud is disabled) */
+		inline const uint8_t* getLastLaserScanData() const { return last_laser_scan_data_; }
+		inline size_t getLastLaserScanNumberOfPoints() const { return last_laser_scan_number_of_points_; }
+		inline bool isRollingWindowEnabled() const { return rolling_window_duration_ > ros::Duration(0); }
+		inline bool isOrganizedPointCloud() const { return organized_pointcloud_; }
+		inline bool isOrganizedLayoutInUse() const { return organized_layout_; }
+		inline const ros::Duration& getRollingWindowDuration() const { return rolling_window_duration_; }
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </gets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <sets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		/** Takes effect in the next initNewPointCloud() (in sliding window mode the segments with the previous layout are discarded in the next LaserScan) */
 		void setIncludeLaserIntensity(bool include_laser_intensity);
+
+		/**
+		 * Sets the time span of the sliding window cloud (zero disables the sliding window).
+		 * In sliding window mode each LaserScan is projected into its own segment of a ring buffer and finishPointCloud() builds the cloud
+		 * from all the segments that were not evicted (the ones older than the start time of the newest LaserScan minus the window duration).
+		 */
+		void setRollingWindowDuration(double rolling_window_duration);
+
+		/**
+		 * Sets the size of the voxels used to merge the points of the current cloud (zero disables the voxel grid).
+		 * In voxel grid mode each voxel is published as the centroid of its points, with their average intensity and their number in the field count.
+		 * Sliding window clouds are not merged into voxels.
+		 */
+		void setVoxelSize(double voxel_size);
+
+		/**
+		 * Sets the voxel sizes (in ascending order) of the levels of detail built from the same points as the main cloud.
+		 * Only the finest enabled level is filled with the projected points and each coarser enabled level is derived from the previous enabled one.
+		 * Levels of detail are not built for sliding window clouds.
+		 */
+		void setLevelsOfDetail(const std::vector<double>& voxel_sizes);
+
+		/** When disabled (and not in sliding window mode) the points only go to the levels of detail and the main cloud is left empty. Must be set before initNewPointCloud() */
+		inline void setPointCloudDataEnabled(bool pointcloud_data_enabled) { pointcloud_data_enabled_ = pointcloud_data_enabled; }
+
+		/**
+		 * Organized clouds have one row per LaserScan (height = number of scans) and one column per beam (width), with the beam index as column.
+		 * The discarded and subsampled beams are kept as NaN points (is_dense = false), so neighbor beams can be found by index.
+		 * All LaserScans should have the same number of beams (the width is set by the first LaserScan of each cloud).
+		 * Ignored in voxel grid and sliding window modes. Must be set before initNewPointCloud().
+		 */
+		void setOrganizedPointCloud(bool organized_pointcloud);
+
+		/**
+		 * Selects the encoding of the coordinates of the points of the main cloud and of the levels of detail.
+		 * With PointCloudLayout::POSITION_INT16 each coordinate is stored as (coordinate - offset) / resolution (offset in the target frame)
+		 * and the points farther than 32767 * resolution from the offset are discarded (or are invalid points in organized clouds).
+		 * Must be set before initNewPointCloud().
+		 */
+		void setPositionEncoding(PointCloudLayout::PositionEncoding position_encoding, double position_resolution = 0.001, const tf2::Vector3& position_offset = tf2::Vector3(0, 0, 0));
+
+		/** Integer intensity encodings store intensity * intensity_scale clamped to the range of the type. Must be set before initNewPointCloud() */
+		void setIntensityEncoding(PointCloudLayout::IntensityEncoding intensity_encoding, double intensity_scale = 1.0);
+
+		/**
+		 * Mask of PointCloudLayout::ExtraField with the per point fields added after the coordinates and intensity.
+		 * The time fields are relative to getPointCloudStartTime(). Extra fields are not available in voxel grid mode and the time fields are not available in sliding window mode.
+		 * Must be set before initNewPointCloud().
+		 */
+		void setExtraFields(int extra_fields);
+
+		/**
+		 * When enabled the points of the main cloud are written directly into the serialized message (see PointCloud2WireBuffer) instead of the data of getPointcloud(),
+		 * which only keeps the header and the fields. Must be set before initNewPointCloud().
+		 */
+		inline void setWireBufferEnabled(bool wire_buffer_enabled) { wire_buffer_enabled_ = wire_buffer_enabled; }
+
+		/** Takes effect in the next cloud */
+		inline void setLevelOfDetailEnabled(size_t level_of_detail, bool enabled) { levels_of_detail_[level_of_detail].enabled_ = enabled; }
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </sets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 	// ========================================================================   </public-section>  ===========================================================================
 
@@ -73,9 +185,32 @@ class LaserScanToROSPointcloud : public LaserScanToPointcloud {
 
 	// ========================================================================   <private-section>   ==========================================================================
 	private:
+		/** Grows the data of the main cloud (in the wire buffer or in the message) to at least number_of_bytes and returns its start */
+		uint8_t* growPointCloudData(size_t number_of_bytes);
+
 		sensor_msgs::PointCloud2Ptr pointcloud_;
+		PointCloudMessagePool pointcloud_pool_;
+		PointCloud2WireBuffer wire_buffer_;
+		bool wire_buffer_enabled_;
+		PointCloudLayout pointcloud_layout_;
 		bool include_laser_intensity_;
-		float* pointcloud_data_position_;
+		VoxelHashGrid voxel_grid_;
+		std::vector<PointCloudLevelOfDetail> levels_of_detail_;
+		PointCloudLayout level_of_detail_layout_;
+		VoxelHashGrid* level_of_detail_voxel_grid_fed_with_points_;
+		uint8_t* pointcloud_data_position_;
+		uint8_t* laser_scan_data_start_;
+		const uint8_t* last_laser_scan_data_;
+		size_t last_laser_scan_number_of_points_;
+		int extra_fields_;
+		PointCloudLayout::PointExtraFields point_extra_fields_;
+		double laser_scan_time_offset_; ///> seconds between the start of the cloud and the start of the current LaserScan
+		ros::Time pointcloud_start_time_;
+		bool pointcloud_data_enabled_;
+		bool organized_pointcloud_;
+		bool organized_layout_;
+		ros::Duration rolling_window_duration_;
+		PointCloudSegmentRing pointcloud_segment_ring_;
 	// ========================================================================   </private-section>  ==========================================================================
 };
 
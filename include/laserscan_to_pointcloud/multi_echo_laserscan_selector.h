@@ -0,0 +1,96 @@
+#pragma once
+
+/**\file multi_echo_laserscan_selector.h
+ * \brief Selection of the echoes of a MultiEchoLaserScan that are projected by the LaserScan assembler
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <macros>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </macros>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// std includes
+#include <stdint.h>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <limits>
+#include <algorithm>
+
+// ROS includes
+#include <sensor_msgs/LaserScan.h>
+#include <sensor_msgs/MultiEchoLaserScan.h>
+
+// external includes
+
+// project includes
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+namespace laserscan_to_pointcloud {
+// #####################################################################   MultiEchoLaserScanSelector   #######################################################################
+/**
+ * \brief Builds a LaserScan with one echo per beam (the selected echo) from a MultiEchoLaserScan, which is projected like any other LaserScan
+ * (sharing the prefilter, the beam selection and the per beam transforms).
+ * With ECHO_POLICY_ALL the selected echo is the first valid one and the remaining valid echoes of each beam are projected with the same transform as the selected echo.
+ * Valid echoes are finite and within [range_min, range_max] of the MultiEchoLaserScan (beams without valid echoes keep their first echo, or NaN without echoes).
+ */
+class MultiEchoLaserScanSelector {
+	// ========================================================================   <public-section>   ===========================================================================
+	public:
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <enums>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		enum EchoPolicy {
+			ECHO_POLICY_ALL = 0,
+			ECHO_POLICY_FIRST,
+			ECHO_POLICY_LAST,
+			ECHO_POLICY_STRONGEST
+		};
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </enums>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		MultiEchoLaserScanSelector();
+		virtual ~MultiEchoLaserScanSelector() {}
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <MultiEchoLaserScanSelector-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		/** Returns the LaserScan with the selected echo of each beam (reused in the next call when no one else holds it) */
+		sensor_msgs::LaserScanConstPtr selectEchoes(const sensor_msgs::MultiEchoLaserScan& multi_echo_laser_scan);
+
+		/** Parses all, first, last or strongest */
+		static bool parseEchoPolicy(const std::string& name, EchoPolicy& echo_policy_out);
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </MultiEchoLaserScanSelector-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <gets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		inline EchoPolicy getEchoPolicy() const { return echo_policy_; }
+		inline bool isProjectingAllEchoes() const { return echo_policy_ == ECHO_POLICY_ALL; }
+		/** Index (in the echoes of the beam) of the echo selected for the beam in the last selectEchoes() */
+		inline uint8_t getSelectedEchoIndex(size_t beam_index) const { return selected_echo_indices_[beam_index]; }
+		/** Number of valid echoes after the selected ones in the last selectEchoes() (only counted with ECHO_POLICY_ALL) */
+		inline size_t getNumberOfAdditionalEchoes() const { return number_of_additional_echoes_; }
+
+		inline bool isEchoValid(float range) const { return range >= range_min_ && range <= range_max_; } ///> also rejects NaN
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </gets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <sets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		inline void setEchoPolicy(EchoPolicy echo_policy) { echo_policy_ = echo_policy; }
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </sets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+	// ========================================================================   </public-section>   ==========================================================================
+
+
+	// ========================================================================   <protected-section>   ========================================================================
+	protected:
+		size_t selectEcho(const std::vector<float>& ranges, const std::vector<float>* intensities) const;
+
+		EchoPolicy echo_policy_;
+		sensor_msgs::LaserScanPtr selected_laser_scan_;
+		std::vector<uint8_t> selected_echo_indices_;
+		size_t number_of_additional_echoes_;
+		float range_min_;
+		float range_max_;
+	// ========================================================================   </protected-section>  ========================================================================
+};
+} /* namespace laserscan_to_pointcloud */
@@ -0,0 +1,157 @@
+#pragma once
+
+/**\file pointcloud2_wire_buffer.h
+ * \brief PointCloud2 built directly in its serialized (wire) format, published by roscpp without serializing the point data again
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <macros>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </macros>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// std includes
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+#include <algorithm>
+
+// ROS includes
+#include <ros/ros.h>
+#include <ros/serialization.h>
+#include <ros/message_traits.h>
+#include <sensor_msgs/PointCloud2.h>
+
+// external includes
+#include <boost/shared_array.hpp>
+
+// project includes
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+namespace laserscan_to_pointcloud {
+// #######################################################################   PointCloud2WireMessage   ##########################################################################
+/**
+ * \brief Serialized sensor_msgs/PointCloud2 (with the 4 bytes of the message length in front, as roscpp expects) that can be published in topics advertised with sensor_msgs::PointCloud2.
+ * roscpp receives the buffer itself (see the serializeMessage specialization below), so publishing does not copy the point data.
+ */
+struct PointCloud2WireMessage {
+	PointCloud2WireMessage() : serialized_length_(0), data_offset_(0) {}
+
+	boost::shared_array<uint8_t> buffer_;
+	uint32_t serialized_length_; ///> bytes of the message after the length field
+	uint32_t data_offset_; ///> position of the point data in the buffer
+};
+
+
+// ########################################################################   PointCloud2WireBuffer   ##########################################################################
+/**
+ * \brief Builds PointCloud2 messages directly in pooled serialization buffers.
+ * beginPointCloud() serializes everything that precedes the point data (header, fields, ...), the points are written in the memory returned by growData()
+ * and finishPointCloud() patches the fixed size fields that are only known at the end (stamp, height, width, row_step and the data length) and appends is_dense.
+ * Buffers are only reused after roscpp released them (sent to all subscribers), so a published message is never changed.
+ * In process (nodelet) subscribers receive a deserialized copy, so this is only worth it for consumers in other processes.
+ */
+class PointCloud2WireBuffer {
+	// ========================================================================   <public-section>   ===========================================================================
+	public:
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		PointCloud2WireBuffer(size_t max_number_of_pooled_buffers = 4);
+		virtual ~PointCloud2WireBuffer() {}
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <PointCloud2WireBuffer-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		/** Acquires a free buffer and serializes the fields of the cloud that precede the point data (the data of the cloud message is ignored) */
+		void beginPointCloud(const sensor_msgs::PointCloud2& pointcloud, size_t number_of_reserved_data_bytes = 0);
+
+		/** Grows the point data to at least number_of_bytes (keeping the bytes already written) and returns its start */
+		uint8_t* growData(size_t number_of_bytes);
+
+		/** Patches the stamp, height, width, row_step and the data length (with data_size bytes) from the cloud and appends is_dense */
+		void finishPointCloud(const sensor_msgs::PointCloud2& pointcloud, size_t data_size);
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </PointCloud2WireBuffer-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <gets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		inline const PointCloud2WireMessage& getMessage() const { return message_; } ///> valid after finishPointCloud()
+		inline size_t getNumberOfUnpooledAllocations() const { return number_of_unpooled_allocations_; }
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </gets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+	// ========================================================================   </public-section>   ==========================================================================
+
+
+	// ========================================================================   <protected-section>   ========================================================================
+	protected:
+		struct PooledBuffer {
+			boost::shared_array<uint8_t> buffer_;
+			size_t capacity_;
+		};
+
+		PooledBuffer* acquireBuffer(size_t capacity);
+
+		template <typename T>
+		inline void patchValue(size_t offset, const T& value) {
+			ros::serialization::OStream stream(message_.buffer_.get() + offset, ros::serialization::serializationLength(value));
+			stream.next(value);
+		}
+
+		std::vector<PooledBuffer> pooled_buffers_;
+		size_t max_number_of_pooled_buffers_;
+		size_t number_of_unpooled_allocations_;
+		PooledBuffer unpooled_buffer_;
+		PooledBuffer* current_buffer_;
+		PointCloud2WireMessage message_;
+
+		size_t stamp_offset_;
+		size_t height_offset_;
+		size_t row_step_offset_;
+		size_t data_length_offset_;
+		size_t data_offset_;
+		size_t data_size_;
+	// ========================================================================   </protected-section>  ========================================================================
+};
+} /* namespace laserscan_to_pointcloud */
+
+
+namespace ros {
+namespace message_traits {
+template <> struct MD5Sum<laserscan_to_pointcloud::PointCloud2WireMessage> {
+	static const char* value() { return MD5Sum<sensor_msgs::PointCloud2>::value(); }
+	static const char* value(const laserscan_to_pointcloud::PointCloud2WireMessage&) { return value(); }
+};
+
+template <> struct DataType<laserscan_to_pointcloud::PointCloud2WireMessage> {
+	static const char* value() { return DataType<sensor_msgs::PointCloud2>::value(); }
+	static const char* value(const laserscan_to_pointcloud::PointCloud2WireMessage&) { return value(); }
+};
+
+template <> struct Definition<laserscan_to_pointcloud::PointCloud2WireMessage> {
+	static const char* value() { return Definition<sensor_msgs::PointCloud2>::value(); }
+	static const char* value(const laserscan_to_pointcloud::PointCloud2WireMessage&) { return value(); }
+};
+
+template <> struct HasHeader<laserscan_to_pointcloud::PointCloud2WireMessage> : TrueType {};
+} /* namespace message_traits */
+
+
+namespace serialization {
+/** Used when the message is written into another stream (for example, by rosbag). Deserialization is done as sensor_msgs::PointCloud2. */
+template <> struct Serializer<laserscan_to_pointcloud::PointCloud2WireMessage> {
+	template <typename Stream>
+	inline static void write(Stream& stream, const laserscan_to_pointcloud::PointCloud2WireMessage& message) {
+		memcpy(stream.advance(message.serialized_length_), message.buffer_.get() + 4, message.serialized_length_);
+	}
+
+	inline static uint32_t serializedLength(const laserscan_to_pointcloud::PointCloud2WireMessage& message) { return message.serialized_length_; }
+};
+
+/** Hands the buffer to roscpp instead of allocating a new one and serializing the message into it */
+template <>
+inline SerializedMessage serializeMessage<laserscan_to_pointcloud::PointCloud2WireMessage>(const laserscan_to_pointcloud::PointCloud2WireMessage& message) {
+	SerializedMessage serialized_message(message.buffer_, message.serialized_length_ + 4);
+	serialized_message.message_start = message.buffer_.get() + 4;
+	return serialized_message;
+}
+} /* namespace serialization */
+} /* namespace ros */
@@ -0,0 +1,118 @@
+#pragma once
+
+/**\file pointcloud_compression.h
+ * \brief Lossy compression of the coordinates and intensities of PointCloud2 messages (quantization, delta coding along the scan order, zigzag varints and zlib)
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <macros>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </macros>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// std includes
+#include <stdint.h>
+#include <string.h>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+
+// ROS includes
+#include <ros/ros.h>
+#include <sensor_msgs/PointCloud2.h>
+#include <sensor_msgs/PointField.h>
+#include <tf2/LinearMath/Vector3.h>
+
+// external includes
+
+// project includes
+#include <laserscan_to_pointcloud/CompressedPointCloud.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+namespace laserscan_to_pointcloud {
+// #########################################################################   PointCloudCompressor   ##########################################################################
+/**
+ * \brief Compresses the x, y, z and intensity fields of a cloud into a CompressedPointCloud (the other fields are not kept).
+ * Each coordinate is quantized to an int32 and written as the zigzag varint of its difference to the previous valid point, which is small because consecutive points
+ * come from consecutive beams. Organized clouds have a prefix with the lengths of the alternating runs of valid and invalid (NaN) points.
+ * The varint stream is then compressed with zlib (when the compression level is above 0).
+ * Float32 coordinates are quantized with the position resolution and int16 coordinates (PointCloudLayout::POSITION_INT16) keep their own resolution,
+ * as integer intensities keep their scale (so both are stored without further loss).
+ */
+class PointCloudCompressor {
+	// ========================================================================   <public-section>   ===========================================================================
+	public:
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		PointCloudCompressor();
+		virtual ~PointCloudCompressor() {}
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <PointCloudCompressor-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		/**
+		 * Compresses the points in data, with the layout described by the fields of the cloud (the data of the cloud message is ignored).
+		 * @return false if the cloud has no x, y and z fields with float32 or int16 datatype
+		 */
+		bool compress(const sensor_msgs::PointCloud2& pointcloud, const uint8_t* data, CompressedPointCloud& compressed_pointcloud);
+		inline bool compress(const sensor_msgs::PointCloud2& pointcloud, CompressedPointCloud& compressed_pointcloud) {
+			return compress(pointcloud, pointcloud.data.empty() ? NULL : &pointcloud.data[0], compressed_pointcloud);
+		}
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </PointCloudCompressor-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <sets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		/** Quantization step (in meters) of float32 coordinates */
+		inline void setPositionResolution(double position_resolution) { position_resolution_ = position_resolution; }
+		/** Quantization step of float32 intensities */
+		inline void setIntensityResolution(double intensity_resolution) { intensity_resolution_ = intensity_resolution; }
+		/** zlib level (1 is the fastest and 0 disables zlib) */
+		inline void setCompressionLevel(int compression_level) { compression_level_ = compression_level; }
+		/** Resolution and offset of the int16 coordinates (see PointCloudLayout::setPositionEncoding) */
+		inline void setInputPositionQuantization(double position_resolution, const tf2::Vector3& position_offset) { input_position_resolution_ = position_resolution; input_position_offset_ = position_offset; }
+		/** Scale of the uint16 / uint8 intensities (see PointCloudLayout::setIntensityEncoding) */
+		inline void setInputIntensityScale(double intensity_scale) { input_intensity_scale_ = intensity_scale; }
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </sets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+	// ========================================================================   </public-section>   ==========================================================================
+
+
+	// ========================================================================   <protected-section>   ========================================================================
+	protected:
+		double position_resolution_;
+		double intensity_resolution_;
+		int compression_level_;
+		double input_position_resolution_;
+		tf2::Vector3 input_position_offset_;
+		double input_intensity_scale_;
+		std::vector<uint8_t> varint_stream_; ///> reused between clouds
+	// ========================================================================   </protected-section>  ========================================================================
+};
+
+
+// ########################################################################   PointCloudDecompressor   #########################################################################
+/**
+ * \brief Rebuilds a sensor_msgs/PointCloud2 with float32 x, y, z (and intensity) from a CompressedPointCloud (invalid points of organized clouds are NaN).
+ */
+class PointCloudDecompressor {
+	// ========================================================================   <public-section>   ===========================================================================
+	public:
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		PointCloudDecompressor() {}
+		virtual ~PointCloudDecompressor() {}
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <PointCloudDecompressor-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		/** @return false if the compressed data is corrupted or uses an unknown compression */
+		bool decompress(const CompressedPointCloud& compressed_pointcloud, sensor_msgs::PointCloud2& pointcloud);
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </PointCloudDecompressor-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+	// ========================================================================   </public-section>   ==========================================================================
+
+
+	// ========================================================================   <protected-section>   ========================================================================
+	protected:
+		std::vector<uint8_t> varint_stream_;
+	// ========================================================================   </protected-section>  ========================================================================
+};
+} /* namespace laserscan_to_pointcloud */
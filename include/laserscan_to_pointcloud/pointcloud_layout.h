@@ -0,0 +1,242 @@
+#pragma once
+
+/**\file pointcloud_layout.h
+ * \brief Fields of the published PointCloud2 points (float32 or quantized int16 coordinates, float32 / uint16 / uint8 intensity and optional per point time, beam, ring and range) and the functions that write them
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <macros>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </macros>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// std includes
+#include <stdint.h>
+#include <string.h>
+#include <cmath>
+#include <string>
+#include <sstream>
+#include <vector>
+#include <limits>
+#include <algorithm>
+
+// ROS includes
+#include <sensor_msgs/PointField.h>
+#include <tf2/LinearMath/Vector3.h>
+#include <tf2/LinearMath/Transform.h>
+
+// external includes
+
+// project includes
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+namespace laserscan_to_pointcloud {
+// ##########################################################################   PointCloudLayout   ############################################################################
+/**
+ * \brief Describes the fields of the points of a PointCloud2 and writes them without padding (point_step is the sum of the size of the fields).
+ * - POSITION_FLOAT32: x, y, z as FLOAT32 (invalid points are NaN)
+ * - POSITION_INT16: x, y, z as INT16 with value = (coordinate - offset) / resolution (invalid points are -32768 and points outside +- 32767 * resolution are discarded)
+ * - intensity as FLOAT32, or as UINT16 / UINT8 with value = intensity * intensity_scale (clamped)
+ * - optional extra fields: time (FLOAT32 seconds) or time_us (UINT32 microseconds) since the reference time of the cloud, beam (UINT32 index of the measurement in its LaserScan or PointCloud2),
+ *   ring (UINT16 id of the laser / topic) and range (FLOAT32 raw range in meters)
+ * - optional UINT32 count (number of points merged in a voxel)
+ * The write functions of each combination of encodings and of extra fields are instantiated from templates and selected in updateFields(),
+ * so the projection loop does not check the encodings for every point and the extra fields that are not in the layout are never computed.
+ */
+class PointCloudLayout {
+	// ========================================================================   <public-section>   ===========================================================================
+	public:
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <enums>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		enum PositionEncoding {
+			POSITION_FLOAT32,
+			POSITION_INT16
+		};
+
+		enum IntensityEncoding {
+			INTENSITY_FLOAT32,
+			INTENSITY_UINT16,
+			INTENSITY_UINT8
+		};
+
+		enum ExtraField {
+			EXTRA_FIELD_TIME = 1,
+			EXTRA_FIELD_TIME_MICROSECONDS = 2,
+			EXTRA_FIELD_BEAM = 4,
+			EXTRA_FIELD_RING = 8,
+			EXTRA_FIELD_RANGE = 16,
+			EXTRA_FIELD_ECHO = 32,
+			EXTRA_FIELDS_ALL = 63
+		};
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </enums>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <typedefs>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		/** Returns false (without writing) if the point can not be represented in the layout */
+		typedef bool (*PointWriter)(const PointCloudLayout& layout, uint8_t* point_data, float x, float y, float z, float intensity);
+
+		/** Per point time is laser_scan_time_offset + beam_index * time_increment (seconds since the reference time of the cloud) */
+		struct PointExtraFields {
+			double laser_scan_time_offset;
+			double time_increment;
+			uint32_t beam_index;
+			uint16_t ring;
+			float range;
+			uint8_t echo; ///> index of the echo in the beam of a MultiEchoLaserScan
+		};
+		typedef void (*ExtraFieldsWriter)(const PointCloudLayout& layout, uint8_t* point_data, const PointExtraFields& point_extra_fields);
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </typedefs>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		PointCloudLayout();
+		virtual ~PointCloudLayout() {}
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <PointCloudLayout-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		/** Rebuilds the fields, the point step and the write function for the current encodings */
+		void updateFields(bool include_intensity, bool include_count, int extra_fields = 0);
+		bool matchesFields(const std::vector<sensor_msgs::PointField>& fields) const;
+
+		inline bool writePoint(uint8_t* point_data, float x, float y, float z, float intensity) const { return point_writer_(*this, point_data, x, y, z, intensity); }
+		inline void writeExtraFields(uint8_t* point_data, const PointExtraFields& point_extra_fields) const { if (extra_fields_writer_ != NULL) { extra_fields_writer_(*this, point_data, point_extra_fields); } }
+		void writeInvalidPoint(uint8_t* point_data) const;
+		inline void writeCount(uint8_t* point_data, uint32_t count) const { writeValue(point_data + count_offset_, count); }
+
+		static bool parsePositionEncoding(const std::string& name, PositionEncoding& position_encoding_out);
+		static bool parseIntensityEncoding(const std::string& name, IntensityEncoding& intensity_encoding_out);
+		/** Parses a list of extra fields separated by + (time, time_us, beam, ring, range, echo) into a mask of ExtraField */
+		static bool parseExtraFields(const std::string& names, int& extra_fields_out);
+
+		/** Applies a rigid transform to the float32 x, y and z (at the start of each point) of number_of_points consecutive points (the other fields are kept) */
+		static void transformFloat32Positions(uint8_t* points_data, size_t number_of_points, uint32_t point_step, const tf2::Transform& transform);
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </PointCloudLayout-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <gets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		inline const std::vector<sensor_msgs::PointField>& getFields() const { return fields_; }
+		inline uint32_t getPointStep() const { return point_step_; }
+		inline PositionEncoding getPositionEncoding() const { return position_encoding_; }
+		inline IntensityEncoding getIntensityEncoding() const { return intensity_encoding_; }
+		inline double getPositionResolution() const { return position_resolution_; }
+		inline const tf2::Vector3& getPositionOffset() const { return position_offset_; }
+		inline double getIntensityScale() const { return intensity_scale_; }
+		inline int getExtraFields() const { return extra_fields_; }
+		inline bool hasExtraFields() const { return extra_fields_ != 0; }
+		inline bool hasTimeField() const { return (extra_fields_ & (EXTRA_FIELD_TIME | EXTRA_FIELD_TIME_MICROSECONDS)) != 0; }
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </gets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <sets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		/** Resolution (meters) and offset (in the cloud frame) are only used by POSITION_INT16. Takes effect in the next updateFields() */
+		void setPositionEncoding(PositionEncoding position_encoding, double position_resolution = 0.001, const tf2::Vector3& position_offset = tf2::Vector3(0, 0, 0));
+		/** The scale is only used by the integer encodings. Takes effect in the next updateFields() */
+		void setIntensityEncoding(IntensityEncoding intensity_encoding, double intensity_scale = 1.0);
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </sets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+	// ========================================================================   </public-section>   ==========================================================================
+
+
+	// ========================================================================   <protected-section>   ========================================================================
+	protected:
+		template <typename T>
+		static inline void writeValue(uint8_t* data, T value) { memcpy(data, &value, sizeof(T)); } // point_step may not keep the fields aligned
+
+		template <typename T>
+		static inline T quantize(float value) { // value must be finite and within [min, max] of T
+			return (T)(value < 0.0f ? value - 0.5f : value + 0.5f);
+		}
+
+		template <int position_encoding, int intensity_encoding>
+		static bool writePointWithEncodings(const PointCloudLayout& layout, uint8_t* point_data, float x, float y, float z, float intensity) {
+			if (position_encoding == POSITION_INT16) {
+				float quantized_x = (x - layout.position_offset_x_) * layout.inverse_position_resolution_;
+				float quantized_y = (y - layout.position_offset_y_) * layout.inverse_position_resolution_;
+				float quantized_z = (z - layout.position_offset_z_) * layout.inverse_position_resolution_;
+				if (!(std::abs(quantized_x) <= 32767.0f && std::abs(quantized_y) <= 32767.0f && std::abs(quantized_z) <= 32767.0f)) { return false; } // also rejects NaN
+				writeValue(point_data, quantize<int16_t>(quantized_x));
+				writeValue(point_data + 2, quantize<int16_t>(quantized_y));
+				writeValue(point_data + 4, quantize<int16_t>(quantized_z));
+			} else {
+				writeValue(point_data, x);
+				writeValue(point_data + 4, y);
+				writeValue(point_data + 8, z);
+			}
+
+			if (layout.include_intensity_) {
+				uint8_t* intensity_data = point_data + layout.intensity_offset_;
+				if (intensity_encoding == INTENSITY_FLOAT32) {
+					writeValue(intensity_data, intensity);
+				} else {
+					const float max_value = (intensity_encoding == INTENSITY_UINT16) ? 65535.0f : 255.0f;
+					float scaled_intensity = intensity * layout.intensity_scale_float_;
+					scaled_intensity = scaled_intensity > 0.0f ? (scaled_intensity < max_value ? scaled_intensity : max_value) : 0.0f; // NaN is stored as 0
+					if (intensity_encoding == INTENSITY_UINT16) {
+						writeValue(intensity_data, quantize<uint16_t>(scaled_intensity));
+					} else {
+						*intensity_data = quantize<uint8_t>(scaled_intensity);
+					}
+				}
+			}
+			return true;
+		}
+
+		template <int extra_fields>
+		static void writeExtraFieldsWithMask(const PointCloudLayout& layout, uint8_t* point_data, const PointExtraFields& point_extra_fields) {
+			if (extra_fields & (EXTRA_FIELD_TIME | EXTRA_FIELD_TIME_MICROSECONDS)) {
+				double time = point_extra_fields.laser_scan_time_offset + (double)point_extra_fields.beam_index * point_extra_fields.time_increment;
+				if (extra_fields & EXTRA_FIELD_TIME) {
+					writeValue(point_data + layout.time_offset_, (float)time);
+				} else {
+					writeValue(point_data + layout.time_offset_, (uint32_t)(time > 0.0 ? time * 1e6 + 0.5 : 0.0));
+				}
+			}
+			if (extra_fields & EXTRA_FIELD_BEAM) { writeValue(point_data + layout.beam_offset_, point_extra_fields.beam_index); }
+			if (extra_fields & EXTRA_FIELD_RING) { writeValue(point_data + layout.ring_offset_, point_extra_fields.ring); }
+			if (extra_fields & EXTRA_FIELD_RANGE) { writeValue(point_data + layout.range_offset_, point_extra_fields.range); }
+			if (extra_fields & EXTRA_FIELD_ECHO) { point_data[layout.echo_offset_] = point_extra_fields.echo; }
+		}
+
+		/** Instantiates the writers of all the masks up to extra_fields (the recursion ends in the specialization for 0) */
+		template <int extra_fields>
+		static ExtraFieldsWriter selectExtraFieldsWriter(int mask) {
+			return (mask == extra_fields) ? &writeExtraFieldsWithMask<extra_fields> : selectExtraFieldsWriter<extra_fields - 1>(mask);
+		}
+
+		template <int position_encoding>
+		static PointWriter selectPointWriter(IntensityEncoding intensity_encoding) {
+			switch (intensity_encoding) {
+				case INTENSITY_UINT16: return &writePointWithEncodings<position_encoding, INTENSITY_UINT16>;
+				case INTENSITY_UINT8: return &writePointWithEncodings<position_encoding, INTENSITY_UINT8>;
+				default: return &writePointWithEncodings<position_encoding, INTENSITY_FLOAT32>;
+			}
+		}
+
+		static void addField(std::vector<sensor_msgs::PointField>& fields, const std::string& name, uint32_t offset, uint8_t datatype);
+		static uint32_t getDatatypeSize(uint8_t datatype);
+
+		PositionEncoding position_encoding_;
+		IntensityEncoding intensity_encoding_;
+		double position_resolution_;
+		tf2::Vector3 position_offset_;
+		double intensity_scale_;
+		int extra_fields_;
+
+		std::vector<sensor_msgs::PointField> fields_;
+		uint32_t point_step_;
+		bool include_intensity_;
+		uint32_t intensity_offset_;
+		uint32_t count_offset_;
+		uint32_t extra_fields_offset_;
+		uint32_t extra_fields_size_;
+		uint32_t time_offset_;
+		uint32_t beam_offset_;
+		uint32_t ring_offset_;
+		uint32_t range_offset_;
+		uint32_t echo_offset_;
+		float inverse_position_resolution_;
+		float position_offset_x_, position_offset_y_, position_offset_z_;
+		float intensity_scale_float_;
+		PointWriter point_writer_;
+		ExtraFieldsWriter extra_fields_writer_;
+	// ========================================================================   </protected-section>  ========================================================================
+};
+} /* namespace laserscan_to_pointcloud */
@@ -0,0 +1,98 @@
+#pragma once
+
+/**\file pointcloud_segment_ring.h
+ * \brief Ring buffer of point cloud segments (one segment per LaserScan) used to build sliding window clouds
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <macros>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </macros>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// std includes
+#include <stdint.h>
+#include <cstring>
+#include <deque>
+#include <vector>
+#include <algorithm>
+
+// ROS includes
+#include <ros/ros.h>
+
+// external includes
+
+// project includes
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+namespace laserscan_to_pointcloud {
+// ########################################################################   PointCloudSegmentRing   ##########################################################################
+/**
+ * \brief Keeps the projected points of the most recent LaserScans in a circular byte buffer, one contiguous segment per scan.
+ * New scans are projected directly into the free space after the newest segment and expired segments are evicted from the front,
+ * so each point is projected only once regardless of how many sliding window clouds it ends up in.
+ * The buffer only grows (and is linearized) when a new segment does not fit in the free space.
+ */
+class PointCloudSegmentRing {
+	// ========================================================================   <public-section>   ===========================================================================
+	public:
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <typedefs>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		struct Segment {
+			ros::Time stamp;
+			size_t offset;
+			size_t number_of_points;
+		};
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </typedefs>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		PointCloudSegmentRing(size_t point_step = 12);
+		virtual ~PointCloudSegmentRing() {}
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <PointCloudSegmentRing-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		/** Removes all segments and changes the size in bytes of each point */
+		void clear(size_t point_step);
+
+		/**
+		 * Returns a pointer to contiguous free memory able to hold max_number_of_points.
+		 * The pointer is valid until commitSegment() is called.
+		 */
+		uint8_t* beginSegment(size_t max_number_of_points);
+
+		/** Appends to the ring the first number_of_points written in the memory returned by the last call to beginSegment() */
+		void commitSegment(const ros::Time& stamp, size_t number_of_points);
+
+		/** @return number of segments removed */
+		size_t evictSegmentsOlderThan(const ros::Time& stamp);
+
+		/** Copies all the points (oldest first) to destination, merging adjacent segments into a single memcpy */
+		void copyPoints(uint8_t* destination) const;
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </PointCloudSegmentRing-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <gets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		inline size_t getPointStep() const { return point_step_; }
+		inline size_t getNumberOfPoints() const { return number_of_points_; }
+		inline size_t getNumberOfSegments() const { return segments_.size(); }
+		inline size_t getCapacityInBytes() const { return buffer_.size(); }
+		inline const std::deque<Segment>& getSegments() const { return segments_; }
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </gets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+	// ========================================================================   </public-section>   ==========================================================================
+
+
+	// ========================================================================   <protected-section>   ========================================================================
+	protected:
+		/** Moves all segments to the beginning of a larger buffer able to hold more number_of_bytes after them */
+		void growAndLinearize(size_t number_of_bytes);
+
+		std::vector<uint8_t> buffer_;
+		std::deque<Segment> segments_;
+		size_t point_step_;
+		size_t number_of_points_;
+		size_t pending_segment_offset_;
+	// ========================================================================   </protected-section>  ========================================================================
+};
+} /* namespace laserscan_to_pointcloud */
@@ -14,7 +14,9 @@
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 // std includes
+#include <cmath>
 #include <vector>
+#include <algorithm>
 
 // ROS includes
 #include <ros/ros.h>
@@ -34,7 +36,8 @@ struct PolarToCartesianMatrix {
 		PolarToCartesianMatrix(size_t polar_to_cartesian_matrix_number_measurements, float polar_to_cartesian_matrix_angle_min, float polar_to_cartesian_matrix_angle_increment) :
 			polar_to_cartesian_matrix_number_measurements_(polar_to_cartesian_matrix_number_measurements),
 			polar_to_cartesian_matrix_angle_min_(polar_to_cartesian_matrix_angle_min),
-			polar_to_cartesian_matrix_angle_increment_(polar_to_cartesian_matrix_angle_increment) {}
+			polar_to_cartesian_matrix_angle_increment_(polar_to_cartesian_matrix_angle_increment),
+			beam_indices_stride_(0) {}
 		virtual ~PolarToCartesianMatrix() {}
 
 		size_t polar_to_cartesian_matrix_number_measurements_;
@@ -42,6 +45,8 @@ struct PolarToCartesianMatrix {
 		float polar_to_cartesian_matrix_angle_increment_;
 
 		Eigen::Array2Xf polar_to_cartesian_matrix_; ///> matrix with sin(theta) and cos(theta) for each laser scan ray
+		double beam_indices_stride_;
+		std::vector<size_t> beam_indices_; ///> indices of the laser scan rays that are projected when using beam_indices_stride_
 };
 
 
@@ -56,6 +61,13 @@ class PolarToCartesianCache {
 
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <PolarToCartesianCache-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 		const Eigen::Array2Xf& getPolarToCartesianMatrix(size_t polar_to_cartesian_matrix_number_measurements, float polar_to_cartesian_matrix_angle_min, float polar_to_cartesian_matrix_angle_increment);
+		PolarToCartesianMatrix& getPolarToCartesianMatrixEntry(size_t polar_to_cartesian_matrix_number_measurements, float polar_to_cartesian_matrix_angle_min, float polar_to_cartesian_matrix_angle_increment);
+
+		/**
+		 * Returns the indices of the rays spaced by beam_stride (that can be fractional, for example to get a given angular resolution).
+		 * The list is kept in the cache entry and only recomputed when the stride changes.
+		 */
+		static const std::vector<size_t>& getBeamIndices(PolarToCartesianMatrix& polar_to_cartesian_matrix_entry, double beam_stride);
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </PolarToCartesianCache-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <gets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -0,0 +1,102 @@
+#pragma once
+
+/**\file range_image_builder.h
+ * \brief Range and intensity images (one row per LaserScan) with the sensor pose of each row, filled during the LaserScan projection
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <macros>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </macros>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// std includes
+#include <string>
+#include <vector>
+
+// ROS includes
+#include <ros/ros.h>
+#include <sensor_msgs/Image.h>
+#include <nav_msgs/Path.h>
+#include <tf2/LinearMath/Transform.h>
+
+// external includes
+
+// project includes
+#include <laserscan_to_pointcloud/tf_rosmsg_eigen_conversions.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+namespace laserscan_to_pointcloud {
+// ##########################################################################   RangeImageBuilder   ###########################################################################
+/**
+ * \brief Builds a 16UC1 range image (millimeters, 0 for discarded beams) and optionally a 16UC1 intensity image with one row per LaserScan and one column per beam (the beam index),
+ * along with a nav_msgs/Path with the sensor pose (in the target frame) and time of each row.
+ * The width of the images is set by the first LaserScan of each image (rows of LaserScans with a different number of beams are truncated or padded).
+ * The messages are replaced in clear(), so the published ones are never changed.
+ */
+class RangeImageBuilder {
+	// ========================================================================   <public-section>   ===========================================================================
+	public:
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		RangeImageBuilder();
+		virtual ~RangeImageBuilder() {}
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <RangeImageBuilder-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		/** Starts new images (with reserved space for number_of_reserved_rows LaserScans) */
+		void clear(const std::string& frame_id, size_t number_of_reserved_rows = 0);
+		void beginRow(size_t number_of_beams, const ros::Time& stamp, const tf2::Transform& sensor_pose);
+		void endRow();
+
+		inline void setMeasurement(size_t column, float range, float intensity) {
+			if (column >= range_image_->width) { return; }
+
+			float range_in_millimeters = range * 1000.0f + 0.5f;
+			range_row_[column] = (range_in_millimeters > 0.0f && range_in_millimeters < 65535.0f) ? (uint16_t)range_in_millimeters : 0;
+			if (intensity_row_ != NULL) {
+				float scaled_intensity = intensity * intensity_scale_ + 0.5f;
+				intensity_row_[column] = scaled_intensity <= 0.0f ? 0 : (scaled_intensity >= 65535.0f ? 65535 : (uint16_t)scaled_intensity);
+			}
+		}
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </RangeImageBuilder-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <gets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		inline bool isEnabled() const { return enabled_; }
+		inline bool isIntensityImageEnabled() const { return intensity_image_enabled_; }
+		inline double getIntensityScale() const { return intensity_scale_; }
+		inline sensor_msgs::ImagePtr getRangeImage() { return range_image_; }
+		inline sensor_msgs::ImagePtr getIntensityImage() { return intensity_image_; } ///> NULL when the intensity image is disabled
+		inline nav_msgs::PathPtr getRowPoses() { return row_poses_; }
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </gets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <sets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		inline void setEnabled(bool enabled) { enabled_ = enabled; }
+		/** Takes effect in the next clear() */
+		inline void setIntensityImageEnabled(bool intensity_image_enabled) { intensity_image_enabled_ = intensity_image_enabled; }
+		/** Intensities are multiplied by this scale before being stored as uint16 */
+		inline void setIntensityScale(double intensity_scale) { intensity_scale_ = (float)intensity_scale; }
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </sets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+	// ========================================================================   </public-section>   ==========================================================================
+
+
+	// ========================================================================   <protected-section>   ========================================================================
+	protected:
+		static void initImage(sensor_msgs::Image& image, const std::string& frame_id);
+		static uint16_t* addImageRow(sensor_msgs::Image& image);
+
+		bool enabled_;
+		bool intensity_image_enabled_;
+		float intensity_scale_;
+		size_t number_of_reserved_rows_;
+		sensor_msgs::ImagePtr range_image_;
+		sensor_msgs::ImagePtr intensity_image_;
+		nav_msgs::PathPtr row_poses_;
+		uint16_t* range_row_;
+		uint16_t* intensity_row_;
+	// ========================================================================   </protected-section>  ========================================================================
+};
+} /* namespace laserscan_to_pointcloud */
@@ -0,0 +1,102 @@
+#pragma once
+
+/**\file region_of_interest.h
+ * \brief Region of interest (intersection of simple volumes) used to crop the points while they are projected
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <macros>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </macros>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// std includes
+#include <vector>
+
+// ROS includes
+#include <tf2/LinearMath/Vector3.h>
+
+// external includes
+
+// project includes
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+namespace laserscan_to_pointcloud {
+// ##########################################################################   RegionOfInterest   ############################################################################
+/**
+ * \brief Intersection of the configured volumes (axis aligned box, vertical cylinder, height band and sphere around the origin) in the target frame.
+ * Volumes that were not set do not restrict the region and a region without volumes contains all points.
+ */
+class RegionOfInterest {
+	// ========================================================================   <public-section>   ===========================================================================
+	public:
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		RegionOfInterest();
+		virtual ~RegionOfInterest() {}
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <RegionOfInterest-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		void clear();
+
+		inline bool contains(const tf2::Vector3& point) const {
+			if (use_box_ && (point.x() < box_min_.x() || point.y() < box_min_.y() || point.z() < box_min_.z() ||
+							 point.x() > box_max_.x() || point.y() > box_max_.y() || point.z() > box_max_.z())) { return false; }
+
+			if (use_height_band_ && (point.z() < height_band_min_ || point.z() > height_band_max_)) { return false; }
+
+			if (use_cylinder_) {
+				tf2Scalar dx = point.x() - cylinder_center_x_;
+				tf2Scalar dy = point.y() - cylinder_center_y_;
+				if (dx * dx + dy * dy > cylinder_squared_radius_ || point.z() < cylinder_min_z_ || point.z() > cylinder_max_z_) { return false; }
+			}
+
+			if (use_max_radius_ && point.length2() > max_squared_radius_) { return false; }
+
+			return true;
+		}
+
+		/** @return false if the parameters do not have the expected size ([min_x, min_y, min_z, max_x, max_y, max_z]) */
+		bool setBox(const std::vector<double>& box);
+
+		/** @return false if the parameters do not have the expected size ([center_x, center_y, radius, min_z, max_z]) */
+		bool setCylinder(const std::vector<double>& cylinder);
+
+		/** @return false if the parameters do not have the expected size ([min_z, max_z]) */
+		bool setHeightBand(const std::vector<double>& height_band);
+
+		/** Maximum distance to the origin of the target frame (<= 0 disables this volume) */
+		void setMaxRadius(double max_radius);
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </RegionOfInterest-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <gets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		inline bool isEnabled() const { return use_box_ || use_cylinder_ || use_height_band_ || use_max_radius_; }
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </gets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+	// ========================================================================   </public-section>   ==========================================================================
+
+
+	// ========================================================================   <protected-section>   ========================================================================
+	protected:
+		bool use_box_;
+		tf2::Vector3 box_min_;
+		tf2::Vector3 box_max_;
+
+		bool use_cylinder_;
+		tf2Scalar cylinder_center_x_;
+		tf2Scalar cylinder_center_y_;
+		tf2Scalar cylinder_squared_radius_;
+		tf2Scalar cylinder_min_z_;
+		tf2Scalar cylinder_max_z_;
+
+		bool use_height_band_;
+		tf2Scalar height_band_min_;
+		tf2Scalar height_band_max_;
+
+		bool use_max_radius_;
+		tf2Scalar max_squared_radius_;
+	// ========================================================================   </protected-section>  ========================================================================
+};
+} /* namespace laserscan_to_pointcloud */
@@ -0,0 +1,121 @@
+#pragma once
+
+/**\file self_filter.h
+ * \brief Removal of the points that hit the robot body, modeled by collision primitives attached to TF frames
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <macros>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </macros>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// std includes
+#include <cmath>
+#include <string>
+#include <vector>
+
+// ROS includes
+#include <ros/ros.h>
+#include <tf2/LinearMath/Quaternion.h>
+#include <tf2/LinearMath/Vector3.h>
+#include <tf2/LinearMath/Transform.h>
+
+// external includes
+
+// project includes
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+namespace laserscan_to_pointcloud {
+// ########################################################################   SelfFilterPrimitive   #############################################################################
+/**
+ * \brief Box, cylinder (along its z axis) or sphere centered in its origin, which is given by an offset in relation to a TF frame.
+ */
+struct SelfFilterPrimitive {
+	enum Shape { BOX, CYLINDER, SPHERE };
+
+	Shape shape_;
+	std::string frame_id_;
+	tf2::Transform offset_;                             ///> primitive pose in frame_id_
+	tf2::Vector3 half_extents_;                         ///> box: half sizes | cylinder: (radius, radius, half length) | sphere: (radius, radius, radius)
+	tf2Scalar squared_radius_;                          ///> cylinder and sphere
+	tf2::Transform target_frame_to_primitive_transform_;
+	tf2::Vector3 bounding_sphere_center_;               ///> in the target frame
+	tf2Scalar bounding_sphere_squared_radius_;
+
+	inline bool contains(const tf2::Vector3& point_in_target_frame) const {
+		if ((point_in_target_frame - bounding_sphere_center_).length2() > bounding_sphere_squared_radius_) { return false; }
+		if (shape_ == SPHERE) { return true; }
+
+		tf2::Vector3 point = target_frame_to_primitive_transform_ * point_in_target_frame;
+		if (shape_ == BOX) {
+			return std::abs(point.x()) <= half_extents_.x() && std::abs(point.y()) <= half_extents_.y() && std::abs(point.z()) <= half_extents_.z();
+		}
+
+		return std::abs(point.z()) <= half_extents_.z() && (point.x() * point.x() + point.y() * point.y()) <= squared_radius_;
+	}
+};
+
+
+// ##############################################################################   SelfFilter   ###############################################################################
+/**
+ * \brief Set of collision primitives whose poses in the target frame are updated by the LaserScan projection (once per TF slice).
+ * A point is filtered if it is inside any primitive.
+ */
+class SelfFilter {
+	// ========================================================================   <public-section>   ===========================================================================
+	public:
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		SelfFilter() {}
+		virtual ~SelfFilter() {}
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <SelfFilter-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		inline void clear() { primitives_.clear(); }
+
+		/**
+		 * Adds a primitive with shape "box" (dimensions [size_x, size_y, size_z]), "cylinder" ([radius, length]) or "sphere" ([radius]).
+		 * The offset is [x, y, z] or [x, y, z, roll, pitch, yaw] in relation to frame_id and the padding is added to all dimensions.
+		 * Returns false (without adding the primitive) if the shape or the number of values are not valid.
+		 */
+		bool addPrimitive(const std::string& shape, const std::string& frame_id, const std::vector<double>& dimensions, const std::vector<double>& offset = std::vector<double>(), double padding = 0.0);
+
+		/**
+		 * Loads a list of primitives from the parameter server, in which each element has the fields
+		 * frame_id, shape, dimensions and the optional fields offset and padding (using the same meaning as addPrimitive).
+		 * Invalid elements are skipped and reported. Returns true if all elements were loaded.
+		 */
+		bool loadPrimitives(XmlRpc::XmlRpcValue& primitives, double default_padding = 0.0);
+
+		/** Updates the primitive pose given the transform from its frame_id to the target frame */
+		void setPrimitiveFrameTransform(size_t primitive_index, const tf2::Transform& frame_to_target_frame_transform);
+
+		inline bool contains(const tf2::Vector3& point_in_target_frame) const {
+			for (size_t i = 0; i < primitives_.size(); ++i) {
+				if (primitives_[i].contains(point_in_target_frame)) { return true; }
+			}
+			return false;
+		}
+
+		static bool readDouble(XmlRpc::XmlRpcValue& value, double& number_out);
+		static bool readDoubles(XmlRpc::XmlRpcValue& values, std::vector<double>& numbers_out);
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </SelfFilter-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <gets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		inline bool isEnabled() const { return !primitives_.empty(); }
+		inline size_t getNumberOfPrimitives() const { return primitives_.size(); }
+		inline const SelfFilterPrimitive& getPrimitive(size_t primitive_index) const { return primitives_[primitive_index]; }
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </gets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+	// ========================================================================   </public-section>   ==========================================================================
+
+
+	// ========================================================================   <protected-section>   ========================================================================
+	protected:
+		std::vector<SelfFilterPrimitive> primitives_;
+	// ========================================================================   </protected-section>  ========================================================================
+};
+} /* namespace laserscan_to_pointcloud */
@@ -0,0 +1,165 @@
+#pragma once
+
+/**\file shared_memory_pointcloud.h
+ * \brief Ring of serialized PointCloud2 messages in shared memory, for sending clouds to consumers in other processes of the same machine without TCP loopback
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <macros>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </macros>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// std includes
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <string>
+
+// ROS includes
+#include <ros/ros.h>
+#include <ros/serialization.h>
+#include <std_msgs/Header.h>
+#include <sensor_msgs/PointCloud2.h>
+
+// external includes
+#include <boost/interprocess/shared_memory_object.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/scoped_ptr.hpp>
+
+// project includes
+#include <laserscan_to_pointcloud/SharedMemoryPointCloud.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+namespace laserscan_to_pointcloud {
+// ###################################################################   shared_memory_pointcloud_layout   ###################################################################
+/**
+ * \brief Layout of the shared memory object: a RingHeader followed by number_of_slots slots, each with a SlotHeader followed by slot_size bytes
+ * with a serialized sensor_msgs/PointCloud2 (the ROS serialization without the message length, so it can also be deserialized by rospy).
+ * A slot being written has sequence 0 and a written slot has the sequence of its SharedMemoryPointCloud descriptor, which readers check before and after reading.
+ * Each ring gets a new nonce when it is created, which is copied into the descriptors, so readers can detect a ring recreated with the same name.
+ */
+namespace shared_memory_pointcloud_layout {
+static const uint32_t MAGIC = 0x4350534c; ///> "LSPC"
+static const uint32_t VERSION = 2;
+static const size_t ALIGNMENT = 64;
+
+struct RingHeader {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t number_of_slots;
+	uint32_t reserved;
+	uint64_t slot_size;
+	uint64_t nonce;
+};
+
+struct SlotHeader {
+	volatile uint64_t sequence;
+	volatile uint64_t size;
+};
+
+inline size_t getRingHeaderSize() { return ALIGNMENT; }
+inline size_t getSlotStride(uint64_t slot_size) { return ALIGNMENT + ((slot_size + ALIGNMENT - 1) / ALIGNMENT) * ALIGNMENT; }
+inline size_t getSharedMemorySize(uint32_t number_of_slots, uint64_t slot_size) { return getRingHeaderSize() + number_of_slots * getSlotStride(slot_size); }
+inline void memoryBarrier() { __sync_synchronize(); }
+} /* namespace shared_memory_pointcloud_layout */
+
+
+// ###################################################################   SharedMemoryPointCloudPublisher   ####################################################################
+/**
+ * \brief Writes clouds into the slots of a shared memory ring (round robin) and fills the descriptors that are published over ROS.
+ * The shared memory object is created in open() (replacing a stale one with the same name) and removed in close().
+ * Readers must copy a cloud before number_of_slots - 1 newer clouds are written (otherwise the read fails).
+ */
+class SharedMemoryPointCloudPublisher {
+	// ========================================================================   <public-section>   ===========================================================================
+	public:
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		SharedMemoryPointCloudPublisher();
+		virtual ~SharedMemoryPointCloudPublisher();
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <SharedMemoryPointCloudPublisher-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		bool open(const std::string& shared_memory_name, size_t number_of_slots, size_t slot_size);
+		void close();
+
+		/** Serializes the cloud directly into the next slot. Returns false if the cloud does not fit in a slot */
+		bool writePointCloud(const sensor_msgs::PointCloud2& pointcloud, SharedMemoryPointCloud& descriptor);
+
+		/** Copies a cloud that was already serialized (for example, by PointCloud2WireBuffer) into the next slot */
+		bool writeSerializedPointCloud(const uint8_t* serialized_pointcloud, size_t size, const std_msgs::Header& header, SharedMemoryPointCloud& descriptor);
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </SharedMemoryPointCloudPublisher-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <gets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		inline bool isOpen() const { return region_.get() != NULL; }
+		inline const std::string& getSharedMemoryName() const { return shared_memory_name_; }
+		inline size_t getSlotSize() const { return slot_size_; }
+		inline size_t getNumberOfSlots() const { return number_of_slots_; }
+		inline size_t getNumberOfDroppedPointClouds() const { return number_of_dropped_pointclouds_; }
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </gets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+	// ========================================================================   </public-section>   ==========================================================================
+
+
+	// ========================================================================   <protected-section>   ========================================================================
+	protected:
+		/** Marks the next slot as being written and returns it (NULL if size does not fit) */
+		shared_memory_pointcloud_layout::SlotHeader* beginSlotWrite(size_t size);
+		void finishSlotWrite(shared_memory_pointcloud_layout::SlotHeader* slot, size_t size, const std_msgs::Header& header, SharedMemoryPointCloud& descriptor);
+
+		std::string shared_memory_name_;
+		size_t number_of_slots_;
+		size_t slot_size_;
+		boost::scoped_ptr<boost::interprocess::mapped_region> region_;
+		uint64_t sequence_;
+		uint64_t nonce_;
+		size_t number_of_dropped_pointclouds_;
+	// ========================================================================   </protected-section>  ========================================================================
+};
+
+
+// ####################################################################   SharedMemoryPointCloudReader   #####################################################################
+/**
+ * \brief Client side of the shared memory ring: maps the shared memory object (read only) named in the descriptors and deserializes the clouds.
+ */
+class SharedMemoryPointCloudReader {
+	// ========================================================================   <public-section>   ===========================================================================
+	public:
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		SharedMemoryPointCloudReader();
+		virtual ~SharedMemoryPointCloudReader() {}
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <SharedMemoryPointCloudReader-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		bool open(const std::string& shared_memory_name);
+		void close();
+
+		/**
+		 * Deserializes the cloud of the descriptor (opening its shared memory object when its name or nonce changes).
+		 * Returns false if the cloud was overwritten before being copied or if the shared memory object is not available.
+		 */
+		bool readPointCloud(const SharedMemoryPointCloud& descriptor, sensor_msgs::PointCloud2& pointcloud);
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </SharedMemoryPointCloudReader-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <gets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		inline bool isOpen() const { return region_.get() != NULL; }
+		inline const std::string& getSharedMemoryName() const { return shared_memory_name_; }
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </gets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+	// ========================================================================   </public-section>   ==========================================================================
+
+
+	// ========================================================================   <protected-section>   ========================================================================
+	protected:
+		bool readPointCloudFromSlot(const SharedMemoryPointCloud& descriptor, sensor_msgs::PointCloud2& pointcloud);
+
+		std::string shared_memory_name_;
+		size_t number_of_slots_;
+		size_t slot_size_;
+		uint64_t nonce_;
+		boost::scoped_ptr<boost::interprocess::mapped_region> region_;
+	// ========================================================================   </protected-section>  ========================================================================
+};
+} /* namespace laserscan_to_pointcloud */
@@ -0,0 +1,55 @@
+/**\file compact_laserscan_decoder.cpp
+ * \brief Implementation of the conversion of CompactLaserScans into LaserScans.
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+#include <laserscan_to_pointcloud/compact_laserscan_decoder.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+namespace laserscan_to_pointcloud {
+// =============================================================================  <public-section>   ===========================================================================
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <CompactLaserScanDecoder-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+sensor_msgs::LaserScanConstPtr CompactLaserScanDecoder::decode(const CompactLaserScan& compact_laser_scan) {
+	std::map<uint32_t, CompactLaserScanGeometry>::const_iterator geometry_it = geometries_.find(compact_laser_scan.geometry_id);
+	if (geometry_it == geometries_.end()) { return sensor_msgs::LaserScanConstPtr(); }
+	const CompactLaserScanGeometry& geometry = geometry_it->second;
+
+	if (!laser_scan_ || !laser_scan_.unique()) { // the previous scan may still be referenced outside the assembler
+		laser_scan_.reset(new sensor_msgs::LaserScan());
+	}
+
+	sensor_msgs::LaserScan& laser_scan = *laser_scan_;
+	laser_scan.header = compact_laser_scan.header;
+	laser_scan.angle_min = geometry.angle_min;
+	laser_scan.angle_max = geometry.angle_max;
+	laser_scan.angle_increment = geometry.angle_increment;
+	laser_scan.time_increment = geometry.time_increment;
+	laser_scan.scan_time = geometry.scan_time;
+	laser_scan.range_min = geometry.range_min;
+	laser_scan.range_max = geometry.range_max;
+
+	size_t number_of_beams = compact_laser_scan.ranges.size();
+	laser_scan.ranges.resize(number_of_beams);
+	if (number_of_beams > 0) {
+		Eigen::Map<Eigen::ArrayXf>(&laser_scan.ranges[0], number_of_beams) = Eigen::Map<const Eigen::Array<uint16_t, Eigen::Dynamic, 1> >(&compact_laser_scan.ranges[0], number_of_beams).cast<float>() * 0.001f;
+	}
+
+	if (compact_laser_scan.intensities_uint16.size() == number_of_beams && number_of_beams > 0) {
+		laser_scan.intensities.resize(number_of_beams);
+		Eigen::Map<Eigen::ArrayXf>(&laser_scan.intensities[0], number_of_beams) = Eigen::Map<const Eigen::Array<uint16_t, Eigen::Dynamic, 1> >(&compact_laser_scan.intensities_uint16[0], number_of_beams).cast<float>();
+	} else if (compact_laser_scan.intensities_uint8.size() == number_of_beams && number_of_beams > 0) {
+		laser_scan.intensities.resize(number_of_beams);
+		Eigen::Map<Eigen::ArrayXf>(&laser_scan.intensities[0], number_of_beams) = Eigen::Map<const Eigen::Array<uint8_t, Eigen::Dynamic, 1> >(&compact_laser_scan.intensities_uint8[0], number_of_beams).cast<float>();
+	} else {
+		laser_scan.intensities.clear();
+	}
+
+	return laser_scan_;
+}
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </CompactLaserScanDecoder-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// =============================================================================  </public-section>   ==========================================================================
+} /* namespace laserscan_to_pointcloud */
@@ -0,0 +1,106 @@
+/**\file laserscan_prefilter.cpp
+ * \brief Implementation of the scan space filters applied before the LaserScan projection.
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+#include <laserscan_to_pointcloud/laserscan_prefilter.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+namespace laserscan_to_pointcloud {
+// =============================================================================  <public-section>   ===========================================================================
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+LaserScanPrefilter::LaserScanPrefilter() :
+		median_window_(0),
+		median_max_range_difference_(0.1f),
+		min_intensity_(0.0f),
+		max_intensity_(0.0f),
+		number_of_rejected_measurements_(0) {
+	setShadowFilter(0.17, 2.97, 0);
+}
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <LaserScanPrefilter-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+bool LaserScanPrefilter::computeValidityMask(const sensor_msgs::LaserScan& laser_scan) {
+	if (!isEnabled() || laser_scan.ranges.empty()) { return false; }
+
+	Eigen::Index number_of_measurements = (Eigen::Index)laser_scan.ranges.size();
+	Eigen::Map<const Eigen::ArrayXf> ranges(&laser_scan.ranges[0], number_of_measurements);
+	rejected_measurements_.setConstant(number_of_measurements, false);
+
+	if (isIntensityFilterEnabled() && (Eigen::Index)laser_scan.intensities.size() == number_of_measurements) {
+		Eigen::Map<const Eigen::ArrayXf> intensities(&laser_scan.intensities[0], number_of_measurements);
+		if (min_intensity_ > 0.0f) { rejected_measurements_ = rejected_measurements_ || (intensities < min_intensity_); }
+		if (max_intensity_ > 0.0f) { rejected_measurements_ = rejected_measurements_ || (intensities > max_intensity_); }
+	}
+
+	if (isShadowFilterEnabled()) { rejectShadowMeasurements(ranges, laser_scan.angle_increment); }
+	if (isMedianFilterEnabled()) { rejectMedianOutliers(ranges); }
+
+	validity_mask_ = (rejected_measurements_ == false);
+	number_of_rejected_measurements_ = (size_t)rejected_measurements_.count();
+	return true;
+}
+
+
+void LaserScanPrefilter::setShadowFilter(double min_angle, double max_angle, size_t shadow_window) {
+	shadow_window_ = shadow_window;
+	shadow_sin_min_angle_ = (float)std::sin(min_angle);
+	shadow_cos_min_angle_ = (float)std::cos(min_angle);
+	shadow_sin_max_angle_ = (float)std::sin(max_angle);
+	shadow_cos_max_angle_ = (float)std::cos(max_angle);
+}
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </LaserScanPrefilter-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// =============================================================================  </public-section>   ==========================================================================
+
+// =============================================================================   <protected-section>   =======================================================================
+void LaserScanPrefilter::rejectShadowMeasurements(const Eigen::Map<const Eigen::ArrayXf>& ranges, float angle_increment) {
+	// the angle a between the ray of a measurement (r1) and the line to its neighbor (r2, k beams away) is atan2(r2 * sin(k * increment), r1 - r2 * cos(k * increment))
+	// and with y = r2 * sin(k * increment) >= 0 the comparisons with the min and max angles reduce to the sign of sin(min_angle - a) and sin(a - max_angle)
+	// (no trigonometric functions per measurement and non finite ranges never reject their neighbors because the comparisons with NaN are false)
+	Eigen::Index number_of_measurements = ranges.size();
+	for (Eigen::Index k = 1; k <= (Eigen::Index)shadow_window_ && k < number_of_measurements; ++k) {
+		Eigen::Index number_of_pairs = number_of_measurements - k;
+		float sin_k = std::abs(std::sin((float)k * angle_increment));
+		float cos_k = std::cos((float)k * angle_increment);
+		Eigen::Map<const Eigen::ArrayXf> first_ranges(ranges.data(), number_of_pairs);
+		Eigen::Map<const Eigen::ArrayXf> second_ranges(ranges.data() + k, number_of_pairs);
+
+		rejected_measurements_.head(number_of_pairs) = rejected_measurements_.head(number_of_pairs) ||
+				((first_ranges - second_ranges * cos_k) * shadow_sin_min_angle_ - (second_ranges * sin_k) * shadow_cos_min_angle_ > 0.0f) ||
+				((second_ranges * sin_k) * shadow_cos_max_angle_ - (first_ranges - second_ranges * cos_k) * shadow_sin_max_angle_ > 0.0f);
+
+		rejected_measurements_.tail(number_of_pairs) = rejected_measurements_.tail(number_of_pairs) ||
+				((second_ranges - first_ranges * cos_k) * shadow_sin_min_angle_ - (first_ranges * sin_k) * shadow_cos_min_angle_ > 0.0f) ||
+				((first_ranges * sin_k) * shadow_cos_max_angle_ - (second_ranges - first_ranges * cos_k) * shadow_sin_max_angle_ > 0.0f);
+	}
+}
+
+
+void LaserScanPrefilter::rejectMedianOutliers(const Eigen::Map<const Eigen::ArrayXf>& ranges) {
+	Eigen::Index number_of_measurements = ranges.size();
+	Eigen::Index window = (Eigen::Index)median_window_;
+	median_window_ranges_.reserve(2 * median_window_ + 1);
+
+	for (Eigen::Index i = 0; i < number_of_measurements; ++i) {
+		if (!std::isfinite(ranges(i))) { continue; }
+
+		median_window_ranges_.clear();
+		Eigen::Index window_end = std::min(i + window + 1, number_of_measurements);
+		for (Eigen::Index j = std::max(i - window, (Eigen::Index)0); j < window_end; ++j) {
+			if (std::isfinite(ranges(j))) { median_window_ranges_.push_back(ranges(j)); }
+		}
+
+		std::vector<float>::iterator median = median_window_ranges_.begin() + median_window_ranges_.size() / 2;
+		std::nth_element(median_window_ranges_.begin(), median, median_window_ranges_.end());
+		if (std::abs(ranges(i) - *median) > median_max_range_difference_) {
+			rejected_measurements_(i) = true;
+		}
+	}
+}
+// =============================================================================   </protected-section>  =======================================================================
+} /* namespace laserscan_to_pointcloud */
@@ -0,0 +1,108 @@
+/**\file laserscan_synchronizer.cpp
+ * \brief Implementation of an approximate time synchronizer of LaserScans.
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+#include <laserscan_to_pointcloud/laserscan_synchronizer.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+namespace laserscan_to_pointcloud {
+// =============================================================================  <public-section>   ===========================================================================
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+LaserScanSynchronizer::LaserScanSynchronizer(size_t number_of_topics, double max_time_skew) :
+		number_of_filled_slots_(0),
+		total_number_of_dropped_laser_scans_(0),
+		max_time_skew_(max_time_skew) {
+	setNumberOfTopics(number_of_topics);
+}
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <LaserScanSynchronizer-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+bool LaserScanSynchronizer::addLaserScan(size_t topic_index, const sensor_msgs::LaserScanConstPtr& laser_scan) {
+	if (topic_index >= laser_scans_slots_.size()) { return false; }
+
+	if (number_of_filled_slots_ == laser_scans_slots_.size()) { clearSynchronizedLaserScans(); } // previous group was not retrieved
+
+	// a scan that is not newer than the one waiting in its slot is out of order and cannot replace it
+	if (laser_scans_slots_[topic_index] && laser_scan->header.stamp <= laser_scans_slots_[topic_index]->header.stamp) {
+		countDroppedLaserScan(topic_index);
+		return false;
+	}
+
+	// the group must be within the max skew of its newest scan, which may have arrived before the incoming one (out of order topics)
+	ros::Time newest_stamp = laser_scan->header.stamp;
+	for (size_t i = 0; i < laser_scans_slots_.size(); ++i) {
+		if (laser_scans_slots_[i] && laser_scans_slots_[i]->header.stamp > newest_stamp) {
+			newest_stamp = laser_scans_slots_[i]->header.stamp;
+		}
+	}
+
+	if (newest_stamp - laser_scan->header.stamp > max_time_skew_) {
+		countDroppedLaserScan(topic_index); // too old to be grouped with the scans already waiting
+		return false;
+	}
+
+	if (laser_scans_slots_[topic_index]) {
+		dropLaserScan(topic_index); // a newer scan from the same topic arrived before the group was completed
+	}
+
+	laser_scans_slots_[topic_index] = laser_scan;
+	++number_of_filled_slots_;
+
+	// discard the scans that are too old in relation to the newest one (they can no longer be part of a group within the max skew)
+	for (size_t i = 0; i < laser_scans_slots_.size(); ++i) {
+		if (laser_scans_slots_[i]) {
+			if (newest_stamp - laser_scans_slots_[i]->header.stamp > max_time_skew_) {
+				dropLaserScan(i);
+			}
+		}
+	}
+
+	return number_of_filled_slots_ == laser_scans_slots_.size() && !laser_scans_slots_.empty();
+}
+
+
+void LaserScanSynchronizer::clearSynchronizedLaserScans() {
+	for (size_t i = 0; i < laser_scans_slots_.size(); ++i) {
+		laser_scans_slots_[i].reset();
+	}
+	number_of_filled_slots_ = 0;
+}
+
+
+void LaserScanSynchronizer::resetNumberOfDroppedLaserScans() {
+	std::fill(number_of_dropped_laser_scans_.begin(), number_of_dropped_laser_scans_.end(), 0);
+	total_number_of_dropped_laser_scans_ = 0;
+}
+
+
+void LaserScanSynchronizer::setNumberOfTopics(size_t number_of_topics) {
+	laser_scans_slots_.clear();
+	laser_scans_slots_.resize(number_of_topics);
+	number_of_dropped_laser_scans_.clear();
+	number_of_dropped_laser_scans_.resize(number_of_topics, 0);
+	number_of_filled_slots_ = 0;
+	total_number_of_dropped_laser_scans_ = 0;
+}
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </LaserScanSynchronizer-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// =============================================================================  </public-section>   ==========================================================================
+
+// =============================================================================   <protected-section>   =======================================================================
+void LaserScanSynchronizer::dropLaserScan(size_t topic_index) {
+	laser_scans_slots_[topic_index].reset();
+	--number_of_filled_slots_;
+	countDroppedLaserScan(topic_index);
+}
+
+
+void LaserScanSynchronizer::countDroppedLaserScan(size_t topic_index) {
+	++number_of_dropped_laser_scans_[topic_index];
+	++total_number_of_dropped_laser_scans_;
+}
+// =============================================================================   </protected-section>  =======================================================================
+} /* namespace laserscan_to_pointcloud */
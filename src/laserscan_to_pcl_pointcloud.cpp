@@ -35,14 +35,17 @@ void LaserScanToPCLPointcloud::initNewPointCloud(size_t number_of_reserved_point
 
 }
 
-void LaserScanToPCLPointcloud::addMeasureToPointCloud(const tf2::Vector3& point, float intensity) {
+void LaserScanToPCLPointcloud::addMeasureToPointCloud(const tf2::Vector3& point, float intensity, size_t measurement_index, float range) {
 }
 
-void LaserScanToPCLPointcloud::setupPointCloudForNewLaserScan(size_t number_laser_scan_points) {
+void LaserScanToPCLPointcloud::setupPointCloudForNewLaserScan(size_t number_laser_scan_points, size_t number_of_additional_echoes) {
 }
 
 void LaserScanToPCLPointcloud::finishLaserScanIntegration() {
 }
+
+void LaserScanToPCLPointcloud::finishPointCloud() {
+}
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </LaserScanToPCLPointcloud-virtual-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 // =============================================================================  </public-section>  ===========================================================================
 
@@ -22,10 +22,22 @@ LaserScanToPointcloud::LaserScanToPointcloud(std::string target_frame, double mi
 		min_range_cutoff_percentage_offset_(min_range_cutoff_percentage), max_range_cutoff_percentage_offset_(max_range_cutoff_percentage),
 		tf_lookup_timeout_(tf_lookup_timeout),
 		remove_invalid_measurements_(true),
+		beam_decimation_stride_(1),
+		target_angular_resolution_(0.0),
+		range_adaptive_point_spacing_(0.0),
+		pointcloud_time_field_("time"),
+		pointcloud_time_field_scale_(1.0),
 		number_of_tf_queries_for_spherical_interpolation_(number_of_tf_queries_for_spherical_interpolation),
 		number_of_pointclouds_created_(0),
 		number_of_points_in_cloud_(0),
-		number_of_scans_assembled_in_current_pointcloud_(0) {}
+		number_of_scans_assembled_in_current_pointcloud_(0),
+		current_laser_scan_time_increment_(0.0),
+		current_laser_scan_number_of_beams_(0),
+		laser_id_(0),
+		current_echo_index_(0),
+		projecting_additional_echo_(false),
+		integrating_pointcloud_(false),
+		current_point_time_offset_(0.0) {}
 
 LaserScanToPointcloud::~LaserScanToPointcloud() {}
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -33,12 +45,16 @@ LaserScanToPointcloud::~LaserScanToPointcloud() {}
 
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <LaserScanToPointcloud-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
-bool LaserScanToPointcloud::integrateLaserScanWithShpericalLinearInterpolation(const sensor_msgs::LaserScanConstPtr& laser_scan) {
+bool LaserScanToPointcloud::integrateLaserScanWithShpericalLinearInterpolation(const sensor_msgs::LaserScanConstPtr& laser_scan, const sensor_msgs::MultiEchoLaserScan* multi_echo_laser_scan) {
 	// laser info
 	size_t number_of_scan_points = laser_scan->ranges.size();
 	size_t number_of_scan_steps = number_of_scan_points - 1;
 	ros::Duration scan_duration((double)number_of_scan_steps * (double)laser_scan->time_increment);
 	ros::Time scan_start_time = laser_scan->header.stamp;
+	current_laser_scan_start_time_ = scan_start_time;
+	current_laser_scan_end_time_ = scan_start_time + scan_duration;
+	current_laser_scan_time_increment_ = laser_scan->time_increment;
+	current_laser_scan_number_of_beams_ = number_of_scan_points;
 //	ros::Time scan_end_time = scan_start_time + scan_duration;
 	ros::Time scan_middle_time = scan_start_time;
 	if (laser_scan->time_increment > 0.0) {
@@ -59,96 +75,200 @@ bool LaserScanToPointcloud::integrateLaserScanWithShpericalLinearInterpolation(c
 	}
 
 
+	// spherical interpolation setup (the sensor and self filter primitives poses of all the slices are collected before the projection)
+	bool interpolate_tfs = (number_of_tf_queries_for_spherical_interpolation_ > 1) && (laser_scan->time_increment > 0.0);
+	collectSlicesTransforms(interpolate_tfs, scan_start_time, scan_duration.toSec(), tf_query_time, laser_frame, motion_estimation_transform, point_transform);
+
+
 	// projection and transformation setup
-	const Eigen::Array2Xf& polar_to_cartesian_matrix = polar_to_cartesian_cache_.getPolarToCartesianMatrix(laser_scan->ranges.size(), laser_scan->angle_min, laser_scan->angle_increment);
+	PolarToCartesianMatrix& polar_to_cartesian_entry = polar_to_cartesian_cache_.getPolarToCartesianMatrixEntry(laser_scan->ranges.size(), laser_scan->angle_min, laser_scan->angle_increment);
+	const Eigen::Array2Xf& polar_to_cartesian_matrix = polar_to_cartesian_entry.polar_to_cartesian_matrix_;
 	double min_range_cutoff = laser_scan->range_min * min_range_cutoff_percentage_offset_;
 	double max_range_cutoff = laser_scan->range_max * max_range_cutoff_percentage_offset_;
-
-
-	// spherical interpolation setup
-	double laser_slice_time_increment_double = ((number_of_tf_queries_for_spherical_interpolation_ < 2) || (laser_scan->time_increment <= 0.0)) ? scan_duration.toSec() : scan_duration.toSec() / (double)(number_of_tf_queries_for_spherical_interpolation_ - 1);
-	ros::Duration laser_slice_time_increment(laser_slice_time_increment_double);
-
-	ros::Time past_tf_time = scan_start_time;
-	tf2::Vector3 past_tf_translation = point_transform.getOrigin();
-	tf2::Quaternion past_tf_rotation = point_transform.getRotation();
-
-	size_t future_tf_number = 1;
-	ros::Time future_tf_time = past_tf_time + laser_slice_time_increment;
-	tf2::Vector3 future_tf_translation = past_tf_translation;
-	tf2::Quaternion future_tf_rotation = past_tf_rotation;
-
-	bool future_tf_valid = false;
-	if ((number_of_tf_queries_for_spherical_interpolation_ > 1) && (laser_scan->time_increment > 0.0)) {
-		while (future_tf_number < number_of_tf_queries_for_spherical_interpolation_) {
-			if (!motion_estimation_source_frame_.empty() && !motion_estimation_target_frame_.empty()) {
-				future_tf_valid = updatePointTransformWithMotionEstimation(motion_estimation_transform, future_tf_translation, future_tf_rotation, motion_estimation_target_frame_, motion_estimation_source_frame_, future_tf_time, tf_lookup_timeout_);
-			} else {
-				future_tf_valid = lookForTransformWithRecovery(future_tf_translation, future_tf_rotation, target_frame_, laser_frame, future_tf_time, tf_lookup_timeout_);
-			}
-
-			if (future_tf_valid) { break; } else { ++future_tf_number; future_tf_time += laser_slice_time_increment; }
-		}
-	}
+	bool use_validity_mask = laserscan_prefilter_.computeValidityMask(*laser_scan);
 
 
 	// laser scan projection and transformation
-	setupPointCloudForNewLaserScan(laser_scan->ranges.size());  // virtual
-	ros::Time current_point_time = scan_start_time;
-	ros::Duration laser_time_increment(laser_scan->time_increment);
-	tf2Scalar current_interpolation_ratio = 0.0;
+	double angle_increment = std::abs((double)laser_scan->angle_increment);
+	double beam_stride = (double)beam_decimation_stride_;
+	if (target_angular_resolution_ > 0.0 && angle_increment > 0.0) { beam_stride *= std::max(target_angular_resolution_ / angle_increment, 1.0); }
+	const std::vector<size_t>& beam_indices = PolarToCartesianCache::getBeamIndices(polar_to_cartesian_entry, beam_stride);
+
+	bool project_additional_echoes = multi_echo_laser_scan != NULL && multi_echo_laserscan_selector_.isProjectingAllEchoes() && multi_echo_laser_scan->ranges.size() == number_of_scan_points;
+	setupPointCloudForNewLaserScan(beam_indices.size(), project_additional_echoes ? multi_echo_laserscan_selector_.getNumberOfAdditionalEchoes() : 0);  // virtual
+	if (range_image_builder_.isEnabled()) {
+		if (number_of_scans_assembled_in_current_pointcloud_ == 0) { range_image_builder_.clear(target_frame_); }
+		range_image_builder_.beginRow(number_of_scan_points, tf_query_time, point_transform); // one column per beam (the subsampled beams are left as 0)
+	}
+	size_t slice_index = 0;
+	bool range_adaptive_spacing = (range_adaptive_point_spacing_ > 0.0 && angle_increment > 0.0);
+	size_t last_projected_point_index = 0;
+	bool point_projected = false;
 
-	for (size_t point_index = 0; point_index < number_of_scan_points; ++point_index) {
+	for (size_t beam_number = 0; beam_number < beam_indices.size(); ++beam_number) {
+		size_t point_index = beam_indices[beam_number];
 		float point_range_value = laser_scan->ranges[point_index];
-		if (point_range_value > min_range_cutoff && point_range_value < max_range_cutoff) {
+		bool measurement_added = false;
+		if (point_range_value > min_range_cutoff && point_range_value < max_range_cutoff && (!use_validity_mask || laserscan_prefilter_.isMeasurementValid(point_index)) &&
+			(!range_adaptive_spacing || !point_projected || (double)(point_index - last_projected_point_index) * angle_increment * point_range_value >= range_adaptive_point_spacing_)) {
+			last_projected_point_index = point_index;
+			point_projected = true;
+
 			// project laser scan point in 2D (in the laser frame of reference)
 			tf2::Vector3 projected_point(point_range_value * polar_to_cartesian_matrix(0, point_index), point_range_value * polar_to_cartesian_matrix(1, point_index), 0);
 
-			// interpolate position and rotation
-			if (future_tf_valid) {
-				current_interpolation_ratio = (current_point_time - past_tf_time).toSec() / laser_slice_time_increment_double;
-				point_transform.getOrigin().setInterpolate3(past_tf_translation, future_tf_translation, current_interpolation_ratio);
-				point_transform.setRotation(tf2::slerp(past_tf_rotation, future_tf_rotation, current_interpolation_ratio));
-			}
+			// interpolate position and rotation (subsampled beams may skip several slices)
+			interpolateSlicesTransforms((double)point_index * (double)laser_scan->time_increment, slice_index, point_transform);
 
 			// transform point to target frame of reference
 			tf2::Vector3 transformed_point = point_transform * projected_point;
 
-			if (!remove_invalid_measurements_ ||
-				(boost::math::isfinite(transformed_point.x()) && boost::math::isfinite(transformed_point.y()) && boost::math::isfinite(transformed_point.z()))) {
+			current_echo_index_ = (multi_echo_laser_scan != NULL) ? multi_echo_laserscan_selector_.getSelectedEchoIndex(point_index) : 0;
+			if (isTransformedPointAccepted(transformed_point)) {
 				// copy point to pointcloud
 				float intensity = 0;
 				if (point_index < laser_scan->intensities.size()) {
 					intensity = (float)laser_scan->intensities[point_index];
 				}
 
-				addMeasureToPointCloud(transformed_point, intensity);  // virtual
+				addMeasureToPointCloud(transformed_point, intensity, point_index, point_range_value);  // virtual
 				++number_of_points_in_cloud_;
+				measurement_added = true;
+
+				if (range_image_builder_.isEnabled()) {
+					range_image_builder_.setMeasurement(point_index, point_range_value, intensity);
+				}
 			}
-		}
 
-		if (future_tf_valid) {
-			current_point_time += laser_time_increment;
-			if (current_point_time > future_tf_time) {
-				past_tf_time = future_tf_time;
-				past_tf_translation = future_tf_translation;
-				past_tf_rotation = future_tf_rotation;
-
-				future_tf_time = past_tf_time + laser_slice_time_increment;
-				++future_tf_number;
-				while (future_tf_number < number_of_tf_queries_for_spherical_interpolation_) {
-					if (!motion_estimation_source_frame_.empty() && !motion_estimation_target_frame_.empty()) {
-						future_tf_valid = updatePointTransformWithMotionEstimation(motion_estimation_transform, future_tf_translation, future_tf_rotation, motion_estimation_target_frame_, motion_estimation_source_frame_, future_tf_time, tf_lookup_timeout_);
-					} else {
-						future_tf_valid = lookForTransformWithRecovery(future_tf_translation, future_tf_rotation, target_frame_, laser_frame, future_tf_time, tf_lookup_timeout_);
+			// the remaining echoes of the beam share its projection and transform
+			if (project_additional_echoes) {
+				const std::vector<float>& echo_ranges = multi_echo_laser_scan->ranges[point_index].echoes;
+				const std::vector<float>* echo_intensities = (point_index < multi_echo_laser_scan->intensities.size()) ? &multi_echo_laser_scan->intensities[point_index].echoes : NULL;
+				size_t selected_echo_index = current_echo_index_;
+				projecting_additional_echo_ = true;
+				for (size_t echo_index = selected_echo_index + 1; echo_index < echo_ranges.size() && echo_index < 256; ++echo_index) {
+					float echo_range = echo_ranges[echo_index];
+					if (!(echo_range > min_range_cutoff && echo_range < max_range_cutoff)) { continue; }
+
+					tf2::Vector3 transformed_echo = point_transform * tf2::Vector3(echo_range * polar_to_cartesian_matrix(0, point_index), echo_range * polar_to_cartesian_matrix(1, point_index), 0);
+					if (isTransformedPointAccepted(transformed_echo)) {
+						current_echo_index_ = echo_index;
+						addMeasureToPointCloud(transformed_echo, (echo_intensities != NULL && echo_index < echo_intensities->size()) ? (*echo_intensities)[echo_index] : 0.0f, point_index, echo_range);  // virtual
+						++number_of_points_in_cloud_;
 					}
-
-					if (future_tf_valid) { break; } else { ++future_tf_number; future_tf_time += laser_slice_time_increment; }
 				}
+				projecting_additional_echo_ = false;
+				current_echo_index_ = selected_echo_index;
 			}
 		}
+
+		if (!measurement_added) {
+			addInvalidMeasureToPointCloud(); // virtual
+		}
 	}
 
+	if (range_image_builder_.isEnabled()) { range_image_builder_.endRow(); }
+	finishLaserScanIntegration(); // virtual
+	++number_of_scans_assembled_in_current_pointcloud_;
+	return true;
+}
+
+
+bool LaserScanToPointcloud::integratePointCloudWithShpericalLinearInterpolation(const sensor_msgs::PointCloud2ConstPtr& pointcloud) {
+	// fields setup
+	size_t number_of_points = (size_t)pointcloud->width * (size_t)pointcloud->height;
+	const sensor_msgs::PointField* x_field = findPointField(*pointcloud, "x");
+	const sensor_msgs::PointField* y_field = findPointField(*pointcloud, "y");
+	const sensor_msgs::PointField* z_field = findPointField(*pointcloud, "z");
+	const sensor_msgs::PointField* intensity_field = findPointField(*pointcloud, "intensity");
+	const sensor_msgs::PointField* time_field = pointcloud_time_field_.empty() ? NULL : findPointField(*pointcloud, pointcloud_time_field_);
+	size_t width = pointcloud->width;
+	size_t point_step = pointcloud->point_step;
+	size_t row_step = (pointcloud->height > 1) ? (size_t)pointcloud->row_step : width * point_step; // rows may have padding
+	if (x_field == NULL || y_field == NULL || z_field == NULL || x_field->datatype != sensor_msgs::PointField::FLOAT32 || y_field->datatype != sensor_msgs::PointField::FLOAT32 || z_field->datatype != sensor_msgs::PointField::FLOAT32 ||
+			!isPointFieldInsidePoint(x_field, point_step) || !isPointFieldInsidePoint(y_field, point_step) || !isPointFieldInsidePoint(z_field, point_step) ||
+			(intensity_field != NULL && !isPointFieldInsidePoint(intensity_field, point_step)) || (time_field != NULL && !isPointFieldInsidePoint(time_field, point_step)) ||
+			pointcloud->is_bigendian || point_step == 0 || row_step < width * point_step ||
+			(number_of_points > 0 && pointcloud->data.size() < (pointcloud->height - 1) * row_step + width * point_step)) {
+		ROS_WARN_STREAM_THROTTLE(5.0, "Laser assembler only integrates little endian PointCloud2 with float32 x, y and z fields inside the point step (ignoring cloud in frame " << pointcloud->header.frame_id << ")");
+		return false;
+	}
+
+	const uint8_t* data = pointcloud->data.empty() ? NULL : &pointcloud->data[0];
+
+
+	// points time (the cloud stamp is the reference of the time field, which may have negative offsets for drivers that stamp the end of the sweep)
+	double min_time_offset = 0.0;
+	double max_time_offset = 0.0;
+	if (time_field != NULL && number_of_points > 0) {
+		min_time_offset = std::numeric_limits<double>::max();
+		max_time_offset = -std::numeric_limits<double>::max();
+		for (size_t i = 0; i < number_of_points; ++i) {
+			double time_offset = readPointField(getPointData(data, i, width, point_step, row_step) + time_field->offset, time_field->datatype) * pointcloud_time_field_scale_;
+			min_time_offset = std::min(min_time_offset, time_offset);
+			max_time_offset = std::max(max_time_offset, time_offset);
+		}
+	}
+
+	ros::Time scan_start_time = ros::Time(pointcloud->header.stamp) + ros::Duration(min_time_offset);
+	double scan_duration = max_time_offset - min_time_offset;
+	current_laser_scan_start_time_ = scan_start_time;
+	current_laser_scan_end_time_ = scan_start_time + ros::Duration(scan_duration);
+	current_laser_scan_time_increment_ = 0.0; // the time of each point is given by getCurrentPointTimeOffset()
+	current_laser_scan_number_of_beams_ = number_of_points;
+	current_echo_index_ = 0;
+
+	std::string laser_frame = laser_frame_.empty() ? pointcloud->header.frame_id : laser_frame_;
+
+
+	// tfs setup (the points of spinning lidars are not sorted by time, so the sensor poses of all the slices are collected before the projection)
+	bool interpolate_tfs = (number_of_tf_queries_for_spherical_interpolation_ > 1) && (scan_duration > 0.0);
+	ros::Time tf_query_time = interpolate_tfs ? scan_start_time : scan_start_time + ros::Duration(scan_duration / 2.0);
+	tf2::Transform point_transform;
+	if (!lookForTransformWithRecovery(point_transform, target_frame_, laser_frame, tf_query_time, tf_lookup_timeout_)) { return false; }
+
+	tf2::Transform motion_estimation_transform = tf2::Transform::getIdentity();
+	if (!motion_estimation_source_frame_.empty() && !motion_estimation_target_frame_.empty()) {
+		if (!lookForTransformWithRecovery(motion_estimation_transform, motion_estimation_target_frame_, motion_estimation_source_frame_, tf_query_time, tf_lookup_timeout_)) { return false; }
+	}
+
+	collectSlicesTransforms(interpolate_tfs, scan_start_time, scan_duration, tf_query_time, laser_frame, motion_estimation_transform, point_transform);
+
+
+	// point cloud transformation
+	size_t number_of_projected_points = (number_of_points + beam_decimation_stride_ - 1) / beam_decimation_stride_;
+	setupPointCloudForNewLaserScan(number_of_projected_points, 0);  // virtual
+	integrating_pointcloud_ = true;
+	size_t slice_index = 0;
+	current_point_time_offset_ = 0.0;
+
+	for (size_t point_index = 0; point_index < number_of_points; point_index += beam_decimation_stride_) {
+		const uint8_t* point_data = getPointData(data, point_index, width, point_step, row_step);
+		tf2::Vector3 point(readPointField(point_data + x_field->offset, sensor_msgs::PointField::FLOAT32), readPointField(point_data + y_field->offset, sensor_msgs::PointField::FLOAT32), readPointField(point_data + z_field->offset, sensor_msgs::PointField::FLOAT32));
+		float point_range_value = (float)point.length();
+		if (!(point_range_value > 0.0f) || (remove_invalid_measurements_ && !boost::math::isfinite(point_range_value))) { // drivers fill the beams without return with 0 or NaN
+			addInvalidMeasureToPointCloud(); // virtual
+			continue;
+		}
+
+		// interpolate position and rotation between the slices around the point time (consecutive points usually share the slice)
+		if (time_field != NULL) {
+			current_point_time_offset_ = readPointField(point_data + time_field->offset, time_field->datatype) * pointcloud_time_field_scale_ - min_time_offset;
+		}
+		interpolateSlicesTransforms(current_point_time_offset_, slice_index, point_transform);
+
+		// transform point to target frame of reference
+		tf2::Vector3 transformed_point = point_transform * point;
+		if (isTransformedPointAccepted(transformed_point)) {
+			float intensity = (intensity_field != NULL) ? (float)readPointField(point_data + intensity_field->offset, intensity_field->datatype) : 0.0f;
+			addMeasureToPointCloud(transformed_point, intensity, point_index, point_range_value);  // virtual
+			++number_of_points_in_cloud_;
+		} else {
+			addInvalidMeasureToPointCloud(); // virtual
+		}
+	}
+
+	integrating_pointcloud_ = false;
 	finishLaserScanIntegration(); // virtual
 	++number_of_scans_assembled_in_current_pointcloud_;
 	return true;
@@ -211,6 +331,15 @@ bool LaserScanToPointcloud::lookForTransformWithRecovery(tf2::Transform& point_t
 }
 
 
+bool LaserScanToPointcloud::updateSelfFilterPrimitivesPoses(const ros::Time& time, const ros::Duration& timeout) {
+	slices_self_filter_frames_transforms_.clear();
+	slices_self_filter_frames_transforms_valid_.clear();
+	bool all_poses_updated = collectSelfFilterPrimitivesFramesTransforms(time, timeout);
+	applySliceSelfFilterPrimitivesPoses(0);
+	return all_poses_updated;
+}
+
+
 void LaserScanToPointcloud::setRecoveryFrame(const std::string& recovery_frame, const tf2::Transform& recovery_to_target_frame_transform) {
 	recovery_frame_ = recovery_frame; recovery_to_target_frame_transform_ = recovery_to_target_frame_transform;
 }
@@ -236,6 +365,149 @@ bool LaserScanToPointcloud::updatePointTransformWithMotionEstimation(tf2::Transf
 // =============================================================================  </public-section>   ==========================================================================
 
 // =============================================================================   <protected-section>   =======================================================================
+bool LaserScanToPointcloud::lookForNextSliceTransform(size_t& slice_number_in_out, ros::Time& slice_time_in_out, const ros::Duration& slice_time_increment, const std::string& laser_frame, tf2::Transform& motion_estimation_transform_in_out, tf2::Vector3& translation_in_out, tf2::Quaternion& rotation_in_out) {
+	while (slice_number_in_out < (size_t)number_of_tf_queries_for_spherical_interpolation_) {
+		bool slice_tf_valid = false;
+		if (!motion_estimation_source_frame_.empty() && !motion_estimation_target_frame_.empty()) {
+			slice_tf_valid = updatePointTransformWithMotionEstimation(motion_estimation_transform_in_out, translation_in_out, rotation_in_out, motion_estimation_target_frame_, motion_estimation_source_frame_, slice_time_in_out, tf_lookup_timeout_);
+		} else {
+			slice_tf_valid = lookForTransformWithRecovery(translation_in_out, rotation_in_out, target_frame_, laser_frame, slice_time_in_out, tf_lookup_timeout_);
+		}
+
+		if (slice_tf_valid) { return true; }
+		++slice_number_in_out;
+		slice_time_in_out += slice_time_increment;
+	}
+	return false;
+}
+
+
+void LaserScanToPointcloud::collectSlicesTransforms(bool interpolate_tfs, const ros::Time& scan_start_time, double scan_duration, const ros::Time& tf_query_time, const std::string& laser_frame, tf2::Transform& motion_estimation_transform_in_out, const tf2::Transform& point_transform) {
+	slices_time_offsets_.clear();
+	slices_translations_.clear();
+	slices_rotations_.clear();
+	slices_self_filter_frames_transforms_.clear();
+	slices_self_filter_frames_transforms_valid_.clear();
+
+	slices_time_offsets_.push_back(0.0);
+	slices_translations_.push_back(point_transform.getOrigin());
+	slices_rotations_.push_back(point_transform.getRotation());
+	if (self_filter_.isEnabled() && !collectSelfFilterPrimitivesFramesTransforms(tf_query_time, tf_lookup_timeout_)) {
+		ROS_WARN_STREAM_THROTTLE(5.0, "Self filter is using the previous pose of the primitives whose TF to " << target_frame_ << " is not available at time " << tf_query_time);
+	}
+
+	if (interpolate_tfs) {
+		ros::Duration slice_time_increment(scan_duration / (double)(number_of_tf_queries_for_spherical_interpolation_ - 1));
+		size_t slice_number = 1;
+		ros::Time slice_time = scan_start_time + slice_time_increment;
+		tf2::Vector3 slice_translation = point_transform.getOrigin();
+		tf2::Quaternion slice_rotation = point_transform.getRotation();
+		while (lookForNextSliceTransform(slice_number, slice_time, slice_time_increment, laser_frame, motion_estimation_transform_in_out, slice_translation, slice_rotation)) {
+			slices_time_offsets_.push_back((slice_time - scan_start_time).toSec());
+			slices_translations_.push_back(slice_translation);
+			slices_rotations_.push_back(slice_rotation);
+			if (self_filter_.isEnabled()) { collectSelfFilterPrimitivesFramesTransforms(slice_time, ros::Duration(0)); } // the sensor TF of the slice is already available
+			++slice_number;
+			slice_time += slice_time_increment;
+		}
+	}
+
+	applySliceSelfFilterPrimitivesPoses(0);
+}
+
+
+bool LaserScanToPointcloud::collectSelfFilterPrimitivesFramesTransforms(const ros::Time& time, const ros::Duration& timeout) {
+	bool all_transforms_valid = true;
+	bool frame_transform_valid = false;
+	tf2::Transform frame_transform;
+	for (size_t i = 0; i < self_filter_.getNumberOfPrimitives(); ++i) {
+		const std::string& primitive_frame = self_filter_.getPrimitive(i).frame_id_;
+		if (i == 0 || primitive_frame != self_filter_.getPrimitive(i - 1).frame_id_) { // primitives attached to the same link share the TF query
+			frame_transform_valid = lookForTransformWithRecovery(frame_transform, target_frame_, primitive_frame, time, timeout);
+		}
+
+		slices_self_filter_frames_transforms_.push_back(frame_transform);
+		slices_self_filter_frames_transforms_valid_.push_back(frame_transform_valid);
+		all_transforms_valid = all_transforms_valid && frame_transform_valid;
+	}
+	return all_transforms_valid;
+}
+
+
+void LaserScanToPointcloud::applySliceSelfFilterPrimitivesPoses(size_t slice_index) {
+	size_t number_of_primitives = self_filter_.getNumberOfPrimitives();
+	size_t first_transform_index = slice_index * number_of_primitives;
+	if (first_transform_index + number_of_primitives > slices_self_filter_frames_transforms_.size()) { return; }
+
+	for (size_t i = 0; i < number_of_primitives; ++i) {
+		if (slices_self_filter_frames_transforms_valid_[first_transform_index + i]) {
+			self_filter_.setPrimitiveFrameTransform(i, slices_self_filter_frames_transforms_[first_transform_index + i]);
+		}
+	}
+}
+
+
+void LaserScanToPointcloud::interpolateSlicesTransforms(double time_offset, size_t& slice_index_in_out, tf2::Transform& point_transform_out) {
+	size_t last_slice_index = slices_time_offsets_.size() - 1;
+	if (last_slice_index == 0) { return; }
+
+	size_t slice_index = slice_index_in_out;
+	while (slice_index + 1 < last_slice_index && time_offset > slices_time_offsets_[slice_index + 1]) { ++slice_index; }
+	while (slice_index > 0 && time_offset < slices_time_offsets_[slice_index]) { --slice_index; }
+	if (slice_index != slice_index_in_out) {
+		applySliceSelfFilterPrimitivesPoses(slice_index);
+		slice_index_in_out = slice_index;
+	}
+
+	tf2Scalar interpolation_ratio = (time_offset - slices_time_offsets_[slice_index]) / (slices_time_offsets_[slice_index + 1] - slices_time_offsets_[slice_index]);
+	interpolation_ratio = std::min(std::max(interpolation_ratio, (tf2Scalar)0.0), (tf2Scalar)1.0); // no extrapolation past the slices with TF
+	point_transform_out.getOrigin().setInterpolate3(slices_translations_[slice_index], slices_translations_[slice_index + 1], interpolation_ratio);
+	point_transform_out.setRotation(tf2::slerp(slices_rotations_[slice_index], slices_rotations_[slice_index + 1], interpolation_ratio));
+}
+
+
+double LaserScanToPointcloud::readPointField(const uint8_t* field_data, uint8_t datatype) {
+	switch (datatype) {
+		case sensor_msgs::PointField::INT8:    { int8_t value;   memcpy(&value, field_data, sizeof(value)); return value; }
+		case sensor_msgs::PointField::UINT8:   { uint8_t value;  memcpy(&value, field_data, sizeof(value)); return value; }
+		case sensor_msgs::PointField::INT16:   { int16_t value;  memcpy(&value, field_data, sizeof(value)); return value; }
+		case sensor_msgs::PointField::UINT16:  { uint16_t value; memcpy(&value, field_data, sizeof(value)); return value; }
+		case sensor_msgs::PointField::INT32:   { int32_t value;  memcpy(&value, field_data, sizeof(value)); return value; }
+		case sensor_msgs::PointField::UINT32:  { uint32_t value; memcpy(&value, field_data, sizeof(value)); return value; }
+		case sensor_msgs::PointField::FLOAT32: { float value;    memcpy(&value, field_data, sizeof(value)); return value; }
+		case sensor_msgs::PointField::FLOAT64: { double value;   memcpy(&value, field_data, sizeof(value)); return value; }
+		default: return 0.0;
+	}
+}
+
+
+size_t LaserScanToPointcloud::getPointFieldDatatypeSize(uint8_t datatype) {
+	switch (datatype) {
+		case sensor_msgs::PointField::INT8:
+		case sensor_msgs::PointField::UINT8:   return 1;
+		case sensor_msgs::PointField::INT16:
+		case sensor_msgs::PointField::UINT16:  return 2;
+		case sensor_msgs::PointField::INT32:
+		case sensor_msgs::PointField::UINT32:
+		case sensor_msgs::PointField::FLOAT32: return 4;
+		case sensor_msgs::PointField::FLOAT64: return 8;
+		default: return 0;
+	}
+}
+
+
+bool LaserScanToPointcloud::isPointFieldInsidePoint(const sensor_msgs::PointField* field, size_t point_step) {
+	size_t datatype_size = getPointFieldDatatypeSize(field->datatype);
+	return datatype_size > 0 && (size_t)field->offset + datatype_size <= point_step;
+}
+
+
+const sensor_msgs::PointField* LaserScanToPointcloud::findPointField(const sensor_msgs::PointCloud2& pointcloud, const std::string& name) {
+	for (size_t i = 0; i < pointcloud.fields.size(); ++i) {
+		if (pointcloud.fields[i].name == name) { return &pointcloud.fields[i]; }
+	}
+	return NULL;
+}
 // =============================================================================   </protected-section>  =======================================================================
 
 // =============================================================================   <private-section>   =========================================================================
@@ -16,16 +16,140 @@ namespace laserscan_to_pointcloud {
 // =============================================================================  <public-section>   ===========================================================================
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 LaserScanToPointcloudAssembler::LaserScanToPointcloudAssembler(ros::NodeHandlePtr& node_handle, ros::NodeHandlePtr& private_node_handle) :
-		number_droped_laserscans_(0), timeout_for_cloud_assembly_reached_(false), imu_last_message_stamp_(0),
-		node_handle_(node_handle), private_node_handle_(private_node_handle) {
+		current_load_shedding_level_(LOAD_SHEDDING_NONE), number_of_laser_scans_in_each_load_shedding_level_(LOAD_SHEDDING_NUMBER_OF_LEVELS, 0), number_of_pointclouds_dropped_by_age_(0),
+		number_of_synchronization_drops_reported_(0), number_droped_laserscans_(0), timeout_for_cloud_assembly_reached_(false), pointcloud_published_(false), imu_last_message_stamp_(0),
+		node_handle_(node_handle), private_node_handle_(private_node_handle), publish_pointcloud_chunks_(false), number_of_pointcloud_chunks_in_current_cloud_(0),
+		publish_compressed_pointcloud_(false), pointcloud_to_compress_data_(NULL), compression_thread_shutdown_(false), number_of_pointclouds_skipped_by_compression_(0), startup_cancelled_(false),
+		dynamic_reconfigure_server_(assembler_mutex_, *private_node_handle) {
 
 	double timeout_for_cloud_assembly = 5.0;
 	private_node_handle_->param("laser_scan_topics", laser_scan_topics_, std::string("tilt_scan"));
+	private_node_handle_->param("multi_echo_laser_scan_topics", multi_echo_laser_scan_topics_, std::string(""));
+	std::string multi_echo_policy;
+	private_node_handle_->param("multi_echo_policy", multi_echo_policy, std::string("all"));
+	MultiEchoLaserScanSelector::EchoPolicy echo_policy = MultiEchoLaserScanSelector::ECHO_POLICY_ALL;
+	if (!MultiEchoLaserScanSelector::parseEchoPolicy(multi_echo_policy, echo_policy)) { ROS_WARN_STREAM("Unknown multi_echo_policy [" << multi_echo_policy << "] (expected all, first, last or strongest)"); }
+	laserscan_to_pointcloud_.getMultiEchoLaserScanSelector().setEchoPolicy(echo_policy);
+	std::string pointcloud_time_field;
+	double pointcloud_time_field_scale;
+	private_node_handle_->param("compact_laser_scan_topics", compact_laser_scan_topics_, std::string(""));
+	private_node_handle_->param("pointcloud_topics", pointcloud_topics_, std::string(""));
+	private_node_handle_->param("pointcloud_time_field", pointcloud_time_field, std::string("time"));
+	private_node_handle_->param("pointcloud_time_field_scale", pointcloud_time_field_scale, 1.0);
+	laserscan_to_pointcloud_.setPointCloudTimeField(pointcloud_time_field);
+	laserscan_to_pointcloud_.setPointCloudTimeFieldScale(pointcloud_time_field_scale);
 	private_node_handle_->param("pointcloud_publish_topic", pointcloud_publish_topic_, std::string("ambient_pointcloud"));
 	private_node_handle_->param("number_of_scans_to_assemble_per_cloud", number_of_scans_to_assemble_per_cloud_, 10);
 	private_node_handle_->param("timeout_for_cloud_assembly", timeout_for_cloud_assembly, 1.0);
 	timeout_for_cloud_assembly_.fromSec(timeout_for_cloud_assembly);
 
+	double rolling_window_duration;
+	private_node_handle_->param("rolling_window_duration", rolling_window_duration, 0.0);
+	laserscan_to_pointcloud_.setRollingWindowDuration(rolling_window_duration);
+
+	double voxel_size;
+	private_node_handle_->param("voxel_size", voxel_size, 0.0);
+	laserscan_to_pointcloud_.setVoxelSize(voxel_size);
+	if (laserscan_to_pointcloud_.isVoxelGridEnabled()) { ROS_INFO_STREAM("Laser assembler is merging the points of each cloud into voxels with " << voxel_size << " meters"); }
+
+	private_node_handle_->param("publish_pointcloud", publish_pointcloud_, true);
+	private_node_handle_->param("range_image_publish_topic", range_image_publish_topic_, std::string(""));
+	double range_image_intensity_scale;
+	private_node_handle_->param("range_image_intensity_scale", range_image_intensity_scale, 1.0);
+	laserscan_to_pointcloud_.getRangeImageBuilder().setEnabled(!range_image_publish_topic_.empty());
+	laserscan_to_pointcloud_.getRangeImageBuilder().setIntensityScale(range_image_intensity_scale);
+
+	bool organized_pointcloud;
+	private_node_handle_->param("organized_pointcloud", organized_pointcloud, false);
+	laserscan_to_pointcloud_.setOrganizedPointCloud(organized_pointcloud);
+	if (organized_pointcloud && !laserscan_to_pointcloud_.isOrganizedLayoutInUse()) { ROS_WARN("Organized point clouds are not available in voxel grid or sliding window modes"); }
+
+	std::string pointcloud_position_encoding, pointcloud_intensity_encoding;
+	double pointcloud_position_resolution, pointcloud_intensity_scale;
+	std::vector<double> pointcloud_position_offset;
+	private_node_handle_->param("pointcloud_position_encoding", pointcloud_position_encoding, std::string("float32"));
+	private_node_handle_->param("pointcloud_position_resolution", pointcloud_position_resolution, 0.001);
+	private_node_handle_->param("pointcloud_position_offset", pointcloud_position_offset, std::vector<double>());
+	private_node_handle_->param("pointcloud_intensity_encoding", pointcloud_intensity_encoding, std::string("float32"));
+	private_node_handle_->param("pointcloud_intensity_scale", pointcloud_intensity_scale, 1.0);
+	PointCloudLayout::PositionEncoding position_encoding = PointCloudLayout::POSITION_FLOAT32;
+	PointCloudLayout::IntensityEncoding intensity_encoding = PointCloudLayout::INTENSITY_FLOAT32;
+	if (!PointCloudLayout::parsePositionEncoding(pointcloud_position_encoding, position_encoding)) { ROS_WARN_STREAM("Unknown pointcloud_position_encoding [" << pointcloud_position_encoding << "] (expected float32 or int16)"); }
+	if (!PointCloudLayout::parseIntensityEncoding(pointcloud_intensity_encoding, intensity_encoding)) { ROS_WARN_STREAM("Unknown pointcloud_intensity_encoding [" << pointcloud_intensity_encoding << "] (expected float32, uint16 or uint8)"); }
+	tf2::Vector3 position_offset(0, 0, 0);
+	if (pointcloud_position_offset.size() == 3) {
+		position_offset.setValue(pointcloud_position_offset[0], pointcloud_position_offset[1], pointcloud_position_offset[2]);
+	} else if (!pointcloud_position_offset.empty()) {
+		ROS_WARN("The pointcloud_position_offset must have 3 values [x, y, z]");
+	}
+	laserscan_to_pointcloud_.setPositionEncoding(position_encoding, pointcloud_position_resolution, position_offset);
+	laserscan_to_pointcloud_.setIntensityEncoding(intensity_encoding, pointcloud_intensity_scale);
+	if (position_encoding == PointCloudLayout::POSITION_INT16) { ROS_INFO_STREAM("Laser assembler is publishing int16 coordinates with " << laserscan_to_pointcloud_.getPointCloudLayout().getPositionResolution() << " meters of resolution"); }
+
+	std::string pointcloud_extra_fields;
+	private_node_handle_->param("pointcloud_extra_fields", pointcloud_extra_fields, std::string(""));
+	int extra_fields = 0;
+	if (!PointCloudLayout::parseExtraFields(pointcloud_extra_fields, extra_fields)) { ROS_WARN_STREAM("Unknown fields in pointcloud_extra_fields [" << pointcloud_extra_fields << "] (expected time, time_us, beam, ring, range and echo separated by +)"); }
+	laserscan_to_pointcloud_.setExtraFields(extra_fields);
+	if (extra_fields != laserscan_to_pointcloud_.getPointCloudLayout().getExtraFields()) { ROS_WARN("Extra point fields are not available in voxel grid mode and time fields are not available in sliding window mode"); }
+
+	std::string shared_memory_name;
+	int shared_memory_number_of_slots, shared_memory_slot_size;
+	private_node_handle_->param("shared_memory_name", shared_memory_name, std::string(""));
+	private_node_handle_->param("shared_memory_number_of_slots", shared_memory_number_of_slots, 4);
+	private_node_handle_->param("shared_memory_slot_size", shared_memory_slot_size, 16777216);
+	if (!shared_memory_name.empty() && shared_memory_pointcloud_publisher_.open(shared_memory_name, (size_t)std::max(shared_memory_number_of_slots, 0), (size_t)std::max(shared_memory_slot_size, 0))) {
+		ROS_INFO_STREAM("Laser assembler is writing the clouds into the shared memory ring [" << shared_memory_name << "] with " << shared_memory_number_of_slots << " slots of " << shared_memory_slot_size << " bytes");
+	}
+
+	double compressed_pointcloud_position_resolution, compressed_pointcloud_intensity_resolution;
+	int compressed_pointcloud_compression_level;
+	private_node_handle_->param("publish_compressed_pointcloud", publish_compressed_pointcloud_, false);
+	private_node_handle_->param("compressed_pointcloud_position_resolution", compressed_pointcloud_position_resolution, 0.001);
+	private_node_handle_->param("compressed_pointcloud_intensity_resolution", compressed_pointcloud_intensity_resolution, 0.01);
+	private_node_handle_->param("compressed_pointcloud_compression_level", compressed_pointcloud_compression_level, 1);
+	pointcloud_compressor_.setPositionResolution(compressed_pointcloud_position_resolution);
+	pointcloud_compressor_.setIntensityResolution(compressed_pointcloud_intensity_resolution);
+	pointcloud_compressor_.setCompressionLevel(compressed_pointcloud_compression_level);
+	pointcloud_compressor_.setInputPositionQuantization(laserscan_to_pointcloud_.getPointCloudLayout().getPositionResolution(), laserscan_to_pointcloud_.getPointCloudLayout().getPositionOffset());
+	pointcloud_compressor_.setInputIntensityScale(laserscan_to_pointcloud_.getPointCloudLayout().getIntensityScale());
+
+	private_node_handle_->param("publish_pointcloud_chunks", publish_pointcloud_chunks_, false);
+	if (publish_pointcloud_chunks_ && (laserscan_to_pointcloud_.isVoxelGridEnabled() || laserscan_to_pointcloud_.isRollingWindowEnabled())) {
+		ROS_WARN("Cloud chunks are not available in voxel grid or sliding window modes");
+		publish_pointcloud_chunks_ = false;
+	}
+
+	std::string additional_target_frames;
+	private_node_handle_->param("additional_target_frames", additional_target_frames, std::string(""));
+	setupAdditionalTargetFrames(additional_target_frames);
+	if (!additional_target_frames_.empty() && (laserscan_to_pointcloud_.isVoxelGridEnabled() || laserscan_to_pointcloud_.isRollingWindowEnabled() || position_encoding != PointCloudLayout::POSITION_FLOAT32)) {
+		ROS_WARN("Additional target frames are not available in voxel grid or sliding window modes or with int16 coordinates");
+		additional_target_frames_.clear();
+	}
+
+	bool pointcloud_wire_buffer;
+	private_node_handle_->param("pointcloud_wire_buffer", pointcloud_wire_buffer, false);
+	laserscan_to_pointcloud_.setWireBufferEnabled(pointcloud_wire_buffer);
+
+	std::string level_of_detail_voxel_sizes, level_of_detail_pointcloud_publish_topics;
+	private_node_handle_->param("level_of_detail_voxel_sizes", level_of_detail_voxel_sizes, std::string(""));
+	private_node_handle_->param("level_of_detail_pointcloud_publish_topics", level_of_detail_pointcloud_publish_topics, std::string(""));
+	setupLevelsOfDetail(level_of_detail_voxel_sizes, level_of_detail_pointcloud_publish_topics);
+
+	int lazy_processing_laser_scans_history_size;
+	private_node_handle_->param("lazy_processing", lazy_processing_, false);
+	private_node_handle_->param("lazy_processing_laser_scans_history_size", lazy_processing_laser_scans_history_size, number_of_scans_to_assemble_per_cloud_);
+	lazy_processing_history_.set_capacity((size_t)std::max(lazy_processing_laser_scans_history_size, 0));
+	double max_laser_scan_age;
+	private_node_handle_->param("max_laser_scan_age", max_laser_scan_age, 0.0);
+	max_laser_scan_age_.fromSec(std::max(max_laser_scan_age, 0.0));
+	private_node_handle_->param("load_shedding_beam_decimation_stride", load_shedding_beam_decimation_stride_, 2);
+	private_node_handle_->param("laser_scans_subscribers_queue_size", laser_scans_subscribers_queue_size_, 5);
+	if (max_laser_scan_age > 0.0) { ROS_INFO_STREAM("Laser assembler is shedding load for LaserScans older than " << max_laser_scan_age << " seconds"); }
+
+	if (laserscan_to_pointcloud_.isRollingWindowEnabled()) { ROS_INFO_STREAM("Laser assembler is publishing a sliding window cloud with the LaserScans of the last " << rolling_window_duration << " seconds"); }
+
 	std::string dynamic_update_of_assembly_configuration_from_twist_topic, dynamic_update_of_assembly_configuration_from_odometry_topic, dynamic_update_of_assembly_configuration_from_imu_topic;
 	private_node_handle_->param("dynamic_update_of_assembly_configuration_from_twist_topic", dynamic_update_of_assembly_configuration_from_twist_topic, std::string(""));
 	private_node_handle_->param("dynamic_update_of_assembly_configuration_from_odometry_topic", dynamic_update_of_assembly_configuration_from_odometry_topic, std::string("odom"));
@@ -66,6 +190,8 @@ LaserScanToPointcloudAssembler::LaserScanToPointcloudAssembler(ros::NodeHandlePt
 	laserscan_to_pointcloud_.setMotionEstimationTargetFrame(motion_estimation_target_frame_id);
 	private_node_handle_->param("include_laser_intensity", include_laser_intensity_, false);
 	private_node_handle_->param("enforce_reception_of_laser_scans_in_all_topics", enforce_reception_of_laser_scans_in_all_topics_, true);
+	private_node_handle_->param("max_time_skew_between_synchronized_laser_scans", number, 0.1);
+	laser_scan_synchronizer_.setMaxTimeSkew(number);
 	laserscan_to_pointcloud_.setIncludeLaserIntensity(include_laser_intensity_);
 	private_node_handle_->param("min_range_cutoff_percentage_offset", number, 1.05);
 	laserscan_to_pointcloud_.setMinRangeCutoffPercentageOffset(number);
@@ -73,12 +199,51 @@ LaserScanToPointcloudAssembler::LaserScanToPointcloudAssembler(ros::NodeHandlePt
 	laserscan_to_pointcloud_.setMaxRangeCutoffPercentageOffset(number);
 	private_node_handle_->param("remove_invalid_measurements", boolean, true);
 	laserscan_to_pointcloud_.setRemoveInvalidMeasurements(boolean);
+	private_node_handle_->param("target_angular_resolution", number, 0.0);
+	laserscan_to_pointcloud_.setTargetAngularResolution(number);
+	private_node_handle_->param("range_adaptive_point_spacing", number, 0.0);
+	laserscan_to_pointcloud_.setRangeAdaptivePointSpacing(number);
+
+	int prefilter_window;
+	double prefilter_min_value, prefilter_max_value;
+	LaserScanPrefilter& laserscan_prefilter = laserscan_to_pointcloud_.getLaserScanPrefilter();
+	private_node_handle_->param("prefilter_shadow_window", prefilter_window, 0);
+	private_node_handle_->param("prefilter_shadow_min_angle", prefilter_min_value, 0.17);
+	private_node_handle_->param("prefilter_shadow_max_angle", prefilter_max_value, 2.97);
+	laserscan_prefilter.setShadowFilter(prefilter_min_value, prefilter_max_value, (size_t)std::max(prefilter_window, 0));
+	private_node_handle_->param("prefilter_median_window", prefilter_window, 0);
+	private_node_handle_->param("prefilter_median_max_range_difference", prefilter_max_value, 0.1);
+	laserscan_prefilter.setMedianFilter((size_t)std::max(prefilter_window, 0), prefilter_max_value);
+	private_node_handle_->param("prefilter_min_intensity", prefilter_min_value, 0.0);
+	private_node_handle_->param("prefilter_max_intensity", prefilter_max_value, 0.0);
+	laserscan_prefilter.setIntensityThresholds(prefilter_min_value, prefilter_max_value);
+
+	std::vector<double> region_of_interest_parameters;
+	RegionOfInterest& region_of_interest = laserscan_to_pointcloud_.getRegionOfInterest();
+	private_node_handle_->param("roi_box", region_of_interest_parameters, std::vector<double>());
+	if (!region_of_interest.setBox(region_of_interest_parameters)) { ROS_WARN("Ignoring roi_box (expected [min_x, min_y, min_z, max_x, max_y, max_z])"); }
+	private_node_handle_->param("roi_cylinder", region_of_interest_parameters, std::vector<double>());
+	if (!region_of_interest.setCylinder(region_of_interest_parameters)) { ROS_WARN("Ignoring roi_cylinder (expected [center_x, center_y, radius, min_z, max_z])"); }
+	private_node_handle_->param("roi_height_band", region_of_interest_parameters, std::vector<double>());
+	if (!region_of_interest.setHeightBand(region_of_interest_parameters)) { ROS_WARN("Ignoring roi_height_band (expected [min_z, max_z])"); }
+	private_node_handle_->param("roi_max_radius", number, 0.0);
+	region_of_interest.setMaxRadius(number);
+	if (region_of_interest.isEnabled()) { ROS_INFO_STREAM("Laser assembler is cropping the points outside the region of interest in the target frame"); }
+
+	XmlRpc::XmlRpcValue self_filter_primitives;
+	if (private_node_handle_->getParam("self_filter_primitives", self_filter_primitives)) {
+		private_node_handle_->param("self_filter_padding", number, 0.0);
+		SelfFilter& self_filter = laserscan_to_pointcloud_.getSelfFilter();
+		self_filter.clear();
+		self_filter.loadPrimitives(self_filter_primitives, number);
+		if (self_filter.isEnabled()) { ROS_INFO_STREAM("Laser assembler is removing the points inside " << self_filter.getNumberOfPrimitives() << " self filter primitives"); }
+	}
 
 	int integer;
-	private_node_handle_->param("number_of_tf_queries_for_spherical_interpolation", integer, 4);
-	if (integer > 1) { ROS_INFO_STREAM("Laser assembler is using " << integer << " TFs inside laser scan time to perform spherical interpolation"); }
+	private_node_handle_->param("number_of_tf_queries_for_spherical_interpolation", number_of_tf_queries_for_spherical_interpolation_, 4);
+	if (number_of_tf_queries_for_spherical_interpolation_ > 1) { ROS_INFO_STREAM("Laser assembler is using " << number_of_tf_queries_for_spherical_interpolation_ << " TFs inside laser scan time to perform spherical interpolation"); }
 
-	laserscan_to_pointcloud_.setNumberOfTfQueriesForSphericalInterpolation(integer);
+	laserscan_to_pointcloud_.setNumberOfTfQueriesForSphericalInterpolation(number_of_tf_queries_for_spherical_interpolation_);
 	private_node_handle_->param("tf_lookup_timeout", number, 0.15);
 	laserscan_to_pointcloud_.setTFLookupTimeout(number);
 
@@ -87,7 +252,9 @@ LaserScanToPointcloudAssembler::LaserScanToPointcloudAssembler(ros::NodeHandlePt
 	dynamic_reconfigure_server_.setCallback(callback_dynamic_reconfigure);
 }
 
-LaserScanToPointcloudAssembler::~LaserScanToPointcloudAssembler() {	}
+LaserScanToPointcloudAssembler::~LaserScanToPointcloudAssembler() {
+	stopPointCloudCompression();
+}
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <LaserScanToPointcloudAssembler-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -97,10 +264,181 @@ void LaserScanToPointcloudAssembler::setupLaserScansSubscribers(std::string lase
 	std::stringstream ss(laser_scan_topics);
 	std::string topic_name;
 
+	laserscan_subscribers_.clear();
+	laserscan_topics_names_.clear();
 	while (ss >> topic_name && !topic_name.empty()) {
-		ros::Subscriber laserscan_subscriber = node_handle_->subscribe(topic_name, 5, &laserscan_to_pointcloud::LaserScanToPointcloudAssembler::processLaserScan, this);
+		laserscan_topics_names_.push_back(topic_name);
+	}
+
+	// the synchronizer slots must exist before the first callback of any subscriber
+	laser_scan_synchronizer_.setNumberOfTopics(laserscan_topics_names_.size());
+	number_of_synchronization_drops_reported_ = 0;
+
+	for (size_t i = 0; i < laserscan_topics_names_.size(); ++i) {
+		ros::Subscriber laserscan_subscriber = node_handle_->subscribe<sensor_msgs::LaserScan>(laserscan_topics_names_[i], laser_scans_subscribers_queue_size_,
+				boost::bind(&laserscan_to_pointcloud::LaserScanToPointcloudAssembler::processLaserScan, this, _1, i));
 		laserscan_subscribers_.push_back(laserscan_subscriber);
-		ROS_INFO_STREAM("Adding " << topic_name << " to the list of LaserScan topics to assemble");
+		ROS_INFO_STREAM("Adding " << laserscan_topics_names_[i] << " to the list of LaserScan topics to assemble");
+	}
+}
+
+
+void LaserScanToPointcloudAssembler::setupMultiEchoLaserScansSubscribers(std::string multi_echo_laser_scan_topics) {
+	std::replace(multi_echo_laser_scan_topics.begin(), multi_echo_laser_scan_topics.end(), '+', ' ');
+
+	std::stringstream ss(multi_echo_laser_scan_topics);
+	std::string topic_name;
+
+	multi_echo_laserscan_subscribers_.clear();
+	while (ss >> topic_name && !topic_name.empty()) {
+		ros::Subscriber multi_echo_laserscan_subscriber = node_handle_->subscribe<sensor_msgs::MultiEchoLaserScan>(topic_name, laser_scans_subscribers_queue_size_,
+				boost::bind(&laserscan_to_pointcloud::LaserScanToPointcloudAssembler::processMultiEchoLaserScan, this, _1, multi_echo_laserscan_subscribers_.size()));
+		multi_echo_laserscan_subscribers_.push_back(multi_echo_laserscan_subscriber);
+		ROS_INFO_STREAM("Adding " << topic_name << " to the list of MultiEchoLaserScan topics to assemble");
+	}
+}
+
+
+void LaserScanToPointcloudAssembler::setupPointCloudsSubscribers(std::string pointcloud_topics) {
+	std::replace(pointcloud_topics.begin(), pointcloud_topics.end(), '+', ' ');
+
+	std::stringstream ss(pointcloud_topics);
+	std::string topic_name;
+
+	pointcloud_subscribers_.clear();
+	while (ss >> topic_name && !topic_name.empty()) {
+		ros::Subscriber pointcloud_subscriber = node_handle_->subscribe<sensor_msgs::PointCloud2>(topic_name, laser_scans_subscribers_queue_size_,
+				boost::bind(&laserscan_to_pointcloud::LaserScanToPointcloudAssembler::processPointCloud, this, _1, pointcloud_subscribers_.size()));
+		pointcloud_subscribers_.push_back(pointcloud_subscriber);
+		ROS_INFO_STREAM("Adding " << topic_name << " to the list of PointCloud2 topics to deskew and assemble");
+	}
+}
+
+
+void LaserScanToPointcloudAssembler::setupCompactLaserScansSubscribers(std::string compact_laser_scan_topics) {
+	std::replace(compact_laser_scan_topics.begin(), compact_laser_scan_topics.end(), '+', ' ');
+
+	std::stringstream ss(compact_laser_scan_topics);
+	std::string topic_name;
+
+	compact_laserscan_subscribers_.clear();
+	compact_laserscan_geometry_subscribers_.clear();
+	compact_laserscan_decoders_.clear();
+	while (ss >> topic_name && !topic_name.empty()) {
+		size_t topic_index = compact_laserscan_subscribers_.size();
+		compact_laserscan_decoders_.push_back(CompactLaserScanDecoder());
+		compact_laserscan_geometry_subscribers_.push_back(node_handle_->subscribe<laserscan_to_pointcloud::CompactLaserScanGeometry>(topic_name + "_geometry", 10,
+				boost::bind(&laserscan_to_pointcloud::LaserScanToPointcloudAssembler::processCompactLaserScanGeometry, this, _1, topic_index)));
+		compact_laserscan_subscribers_.push_back(node_handle_->subscribe<laserscan_to_pointcloud::CompactLaserScan>(topic_name, laser_scans_subscribers_queue_size_,
+				boost::bind(&laserscan_to_pointcloud::LaserScanToPointcloudAssembler::processCompactLaserScan, this, _1, topic_index)));
+		ROS_INFO_STREAM("Adding " << topic_name << " to the list of CompactLaserScan topics to assemble (with the geometries in " << topic_name << "_geometry)");
+	}
+}
+
+
+void LaserScanToPointcloudAssembler::setupLevelsOfDetail(std::string level_of_detail_voxel_sizes, std::string level_of_detail_pointcloud_publish_topics) {
+	std::replace(level_of_detail_voxel_sizes.begin(), level_of_detail_voxel_sizes.end(), '+', ' ');
+	std::replace(level_of_detail_pointcloud_publish_topics.begin(), level_of_detail_pointcloud_publish_topics.end(), '+', ' ');
+
+	std::vector< std::pair<double, std::string> > levels_of_detail;
+	std::stringstream ss_voxel_sizes(level_of_detail_voxel_sizes);
+	std::stringstream ss_topics(level_of_detail_pointcloud_publish_topics);
+	double voxel_size;
+	std::string topic_name;
+	while (ss_voxel_sizes >> voxel_size && ss_topics >> topic_name) {
+		if (voxel_size > 0.0) {
+			levels_of_detail.push_back(std::make_pair(voxel_size, topic_name));
+		}
+	}
+	std::sort(levels_of_detail.begin(), levels_of_detail.end()); // coarser levels are derived from the finer ones
+
+	std::vector<double> voxel_sizes;
+	level_of_detail_pointcloud_publish_topics_.clear();
+	for (size_t i = 0; i < levels_of_detail.size(); ++i) {
+		voxel_sizes.push_back(levels_of_detail[i].first);
+		level_of_detail_pointcloud_publish_topics_.push_back(levels_of_detail[i].second);
+		ROS_INFO_STREAM("Publishing level of detail with voxels of " << levels_of_detail[i].first << " meters in topic " << levels_of_detail[i].second);
+	}
+	laserscan_to_pointcloud_.setLevelsOfDetail(voxel_sizes);
+}
+
+
+void LaserScanToPointcloudAssembler::updateLevelsOfDetailWithSubscribers() {
+	for (size_t i = 0; i < level_of_detail_pointcloud_publishers_.size() && i < laserscan_to_pointcloud_.getNumberOfLevelsOfDetail(); ++i) {
+		laserscan_to_pointcloud_.setLevelOfDetailEnabled(i, level_of_detail_pointcloud_publishers_[i].getNumSubscribers() > 0);
+	}
+}
+
+
+ros::Publisher LaserScanToPointcloudAssembler::advertisePointCloudPublisher(const std::string& pointcloud_publish_topic) {
+	return node_handle_->advertise<sensor_msgs::PointCloud2>(pointcloud_publish_topic, 10,
+			boost::bind(&laserscan_to_pointcloud::LaserScanToPointcloudAssembler::processPointCloudSubscriberConnection, this, _1),
+			ros::SubscriberStatusCallback(), ros::VoidConstPtr(), true);
+}
+
+
+bool LaserScanToPointcloudAssembler::hasPointCloudSubscribers() {
+	if (hasMainPointCloudSubscribers()) { return true; }
+	if (range_image_publisher_.getNumSubscribers() > 0 || range_image_intensity_publisher_.getNumSubscribers() > 0 || range_image_poses_publisher_.getNumSubscribers() > 0) { return true; }
+
+	for (size_t i = 0; i < level_of_detail_pointcloud_publishers_.size(); ++i) {
+		if (level_of_detail_pointcloud_publishers_[i].getNumSubscribers() > 0) { return true; }
+	}
+
+	return false;
+}
+
+
+bool LaserScanToPointcloudAssembler::hasMainPointCloudSubscribers() {
+	if (pointcloud_publisher_.getNumSubscribers() > 0 || shared_memory_descriptor_publisher_.getNumSubscribers() > 0 || compressed_pointcloud_publisher_.getNumSubscribers() > 0
+			|| pointcloud_chunks_publisher_.getNumSubscribers() > 0) { return true; }
+
+	for (size_t i = 0; i < additional_target_frames_.size(); ++i) { // built from the points of the main cloud
+		if (additional_target_frames_[i].publisher_.getNumSubscribers() > 0) { return true; }
+	}
+
+	return false;
+}
+
+
+void LaserScanToPointcloudAssembler::processPointCloudSubscriberConnection(const ros::SingleSubscriberPublisher& subscriber_publisher) {
+	boost::recursive_mutex::scoped_lock lock(assembler_mutex_);
+	if (!lazy_processing_ || lazy_processing_history_.empty() || !hasPointCloudSubscribers()) { return; }
+	ROS_DEBUG_STREAM("Processing the " << lazy_processing_history_.size() << " messages received before the first subscriber of " << subscriber_publisher.getTopic() << " connected");
+	processLazyProcessingHistory();
+}
+
+
+bool LaserScanToPointcloudAssembler::deferLazyProcessingInput(const LazyProcessingInput& input) {
+	if (!lazy_processing_) { return false; }
+
+	if (!hasPointCloudSubscribers()) { // only keeps the most recent messages (TFs are kept by the TF listener)
+		lazy_processing_history_.push_back(input);
+		return true;
+	}
+
+	processLazyProcessingHistory(); // a subscriber may have connected without its connection callback having run yet
+	return false;
+}
+
+
+void LaserScanToPointcloudAssembler::processLazyProcessingHistory() {
+	if (lazy_processing_history_.empty()) { return; }
+
+	// the history is moved out because the messages are processed again by their callbacks
+	std::vector<LazyProcessingInput> lazy_processing_history(lazy_processing_history_.begin(), lazy_processing_history_.end());
+	lazy_processing_history_.clear();
+	for (size_t i = 0; i < lazy_processing_history.size(); ++i) {
+		const LazyProcessingInput& input = lazy_processing_history[i];
+		if (input.laser_scan_) {
+			processLaserScan(input.laser_scan_, input.topic_index_);
+		} else if (input.multi_echo_laser_scan_) {
+			processMultiEchoLaserScan(input.multi_echo_laser_scan_, input.topic_index_);
+		} else if (input.pointcloud_) {
+			processPointCloud(input.pointcloud_, input.topic_index_);
+		} else if (input.compact_laser_scan_) {
+			processCompactLaserScan(input.compact_laser_scan_, input.topic_index_);
+		}
 	}
 }
 
@@ -123,7 +461,9 @@ void LaserScanToPointcloudAssembler::setupRecoveryInitialPose() {
 	orientation.normalize();
 	tf2::Transform recovery_to_target_frame_transform(orientation, tf2::Vector3(x, y, z));
 
-	ros::Time::waitForValid();
+	while (!ros::Time::waitForValid(ros::WallDuration(0.1))) {
+		if (isStartupCancelled()) { return; }
+	}
 
 	if (initial_recovery_transform_in_base_link_to_target && !recovery_frame_id.empty() && !base_link_frame_id.empty()) {
 		ros::Time start_time = ros::Time::now();
@@ -132,6 +472,7 @@ void LaserScanToPointcloudAssembler::setupRecoveryInitialPose() {
 
 		bool success = false;
 		while (ros::Time::now() < end_time) {
+			if (isStartupCancelled()) { return; }
 			tf2::Transform transform_recovery_to_base_link;
 			if (laserscan_to_pointcloud_.getTfCollector().lookForTransform(transform_recovery_to_base_link, base_link_frame_id, recovery_frame_id, ros::Time::now(), laserscan_to_pointcloud_.getTfLookupTimeout())) {
 				recovery_to_target_frame_transform = recovery_to_target_frame_transform * transform_recovery_to_base_link;
@@ -155,79 +496,621 @@ void LaserScanToPointcloudAssembler::setupRecoveryInitialPose() {
 				<< " qz: " << recovery_to_target_frame_transform_q.getZ()
 				<< " qw: " << recovery_to_target_frame_transform_q.getW()
 				<< " ]");
+		boost::recursive_mutex::scoped_lock lock(assembler_mutex_);
 		laserscan_to_pointcloud_.setRecoveryFrame(recovery_frame_id, recovery_to_target_frame_transform);
 	}
 }
 
 
+void LaserScanToPointcloudAssembler::advertisePointCloudPublishers() {
+	pointcloud_publisher_ = advertisePointCloudPublisher(pointcloud_publish_topic_);
+	if (shared_memory_pointcloud_publisher_.isOpen()) { // descriptors are not latched because their slot is overwritten by the next clouds
+		shared_memory_descriptor_publisher_ = node_handle_->advertise<laserscan_to_pointcloud::SharedMemoryPointCloud>(pointcloud_publish_topic_ + "_shared_memory", 10,
+				boost::bind(&laserscan_to_pointcloud::LaserScanToPointcloudAssembler::processPointCloudSubscriberConnection, this, _1));
+	}
+	if (publish_pointcloud_chunks_) { // chunks are not latched because the ones before them would be missing
+		pointcloud_chunks_publisher_ = node_handle_->advertise<laserscan_to_pointcloud::PointCloudChunk>(pointcloud_publish_topic_ + "_chunks", std::max(number_of_scans_to_assemble_per_cloud_, 1) + 1,
+				boost::bind(&laserscan_to_pointcloud::LaserScanToPointcloudAssembler::processPointCloudSubscriberConnection, this, _1));
+	}
+	for (size_t i = 0; i < additional_target_frames_.size(); ++i) {
+		std::string frame_topic_suffix = additional_target_frames_[i].frame_id_;
+		if (!frame_topic_suffix.empty() && frame_topic_suffix[0] == '/') { frame_topic_suffix.erase(0, 1); }
+		std::replace(frame_topic_suffix.begin(), frame_topic_suffix.end(), '/', '_');
+		additional_target_frames_[i].publisher_ = advertisePointCloudPublisher(pointcloud_publish_topic_ + "_" + frame_topic_suffix);
+	}
+	if (publish_compressed_pointcloud_) {
+		boost::mutex::scoped_lock lock(compression_mutex_); // the compression thread copies the publisher with each cloud
+		compressed_pointcloud_publisher_ = node_handle_->advertise<laserscan_to_pointcloud::CompressedPointCloud>(pointcloud_publish_topic_ + "_compressed", 10,
+				boost::bind(&laserscan_to_pointcloud::LaserScanToPointcloudAssembler::processPointCloudSubscriberConnection, this, _1), ros::SubscriberStatusCallback(), ros::VoidConstPtr(), true);
+	}
+}
+
+
 void LaserScanToPointcloudAssembler::startAssemblingLaserScans() {
 	setupRecoveryInitialPose();
-	pointcloud_publisher_ = node_handle_->advertise<sensor_msgs::PointCloud2>(pointcloud_publish_topic_, 10, true);
+	boost::recursive_mutex::scoped_lock lock(assembler_mutex_);
+	if (isStartupCancelled()) { return; }
+	advertisePointCloudPublishers();
+	level_of_detail_pointcloud_publishers_.clear();
+	for (size_t i = 0; i < level_of_detail_pointcloud_publish_topics_.size(); ++i) {
+		level_of_detail_pointcloud_publishers_.push_back(advertisePointCloudPublisher(level_of_detail_pointcloud_publish_topics_[i]));
+	}
+	if (!range_image_publish_topic_.empty()) {
+		ros::SubscriberStatusCallback connection_callback = boost::bind(&laserscan_to_pointcloud::LaserScanToPointcloudAssembler::processPointCloudSubscriberConnection, this, _1);
+		range_image_publisher_ = node_handle_->advertise<sensor_msgs::Image>(range_image_publish_topic_, 10, connection_callback, ros::SubscriberStatusCallback(), ros::VoidConstPtr(), true);
+		range_image_intensity_publisher_ = node_handle_->advertise<sensor_msgs::Image>(range_image_publish_topic_ + "_intensity", 10, connection_callback, ros::SubscriberStatusCallback(), ros::VoidConstPtr(), true);
+		range_image_poses_publisher_ = node_handle_->advertise<nav_msgs::Path>(range_image_publish_topic_ + "_poses", 10, connection_callback, ros::SubscriberStatusCallback(), ros::VoidConstPtr(), true);
+	}
+	if (publish_compressed_pointcloud_) {
+		compression_thread_shutdown_ = false;
+		compression_thread_ = boost::thread(&laserscan_to_pointcloud::LaserScanToPointcloudAssembler::compressPointClouds, this);
+	}
+	cloud_assembly_timeout_timer_ = node_handle_->createSteadyTimer(ros::WallDuration(timeout_for_cloud_assembly_.toSec()), &laserscan_to_pointcloud::LaserScanToPointcloudAssembler::processCloudAssemblyTimeout, this, true, false);
 	setupLaserScansSubscribers(laser_scan_topics_);
+	setupMultiEchoLaserScansSubscribers(multi_echo_laser_scan_topics_);
+	setupPointCloudsSubscribers(pointcloud_topics_);
+	setupCompactLaserScansSubscribers(compact_laser_scan_topics_);
 }
 
 
 void LaserScanToPointcloudAssembler::stopAssemblingLaserScans() {
+	boost::recursive_mutex::scoped_lock lock(assembler_mutex_);
 	for (size_t i = 0; i < laserscan_subscribers_.size(); ++i) {
 		laserscan_subscribers_[i].shutdown();
 	}
+	for (size_t i = 0; i < multi_echo_laserscan_subscribers_.size(); ++i) {
+		multi_echo_laserscan_subscribers_[i].shutdown();
+	}
+	for (size_t i = 0; i < pointcloud_subscribers_.size(); ++i) {
+		pointcloud_subscribers_[i].shutdown();
+	}
+	for (size_t i = 0; i < compact_laserscan_subscribers_.size(); ++i) {
+		compact_laserscan_subscribers_[i].shutdown();
+		compact_laserscan_geometry_subscribers_[i].shutdown();
+	}
 
+	cloud_assembly_timeout_timer_.stop();
 	pointcloud_publisher_.shutdown();
+	for (size_t i = 0; i < level_of_detail_pointcloud_publishers_.size(); ++i) {
+		level_of_detail_pointcloud_publishers_[i].shutdown();
+	}
+	range_image_publisher_.shutdown();
+	range_image_intensity_publisher_.shutdown();
+	range_image_poses_publisher_.shutdown();
+	shared_memory_descriptor_publisher_.shutdown();
+	pointcloud_chunks_publisher_.shutdown();
+	for (size_t i = 0; i < additional_target_frames_.size(); ++i) {
+		additional_target_frames_[i].publisher_.shutdown();
+	}
+	stopPointCloudCompression();
+	compressed_pointcloud_publisher_.shutdown();
 }
 
 
-void LaserScanToPointcloudAssembler::processLaserScan(const sensor_msgs::LaserScanConstPtr& laser_scan) {
+void LaserScanToPointcloudAssembler::cancelStartup() {
+	boost::mutex::scoped_lock lock(startup_mutex_);
+	startup_cancelled_ = true;
+}
+
+
+bool LaserScanToPointcloudAssembler::isStartupCancelled() {
+	boost::mutex::scoped_lock lock(startup_mutex_);
+	return startup_cancelled_;
+}
+
+
+void LaserScanToPointcloudAssembler::processLaserScan(const sensor_msgs::LaserScanConstPtr& laser_scan, size_t laser_scan_topic_index) {
+	boost::recursive_mutex::scoped_lock lock(assembler_mutex_);
+
+	if (deferLazyProcessingInput(LazyProcessingInput(laser_scan, laser_scan_topic_index))) { return; }
+
+	if (!enforce_reception_of_laser_scans_in_all_topics_ || laser_scan_synchronizer_.getNumberOfTopics() < 2) {
+		laserscan_to_pointcloud_.setLaserId(laser_scan_topic_index);
+		if (laserscan_to_pointcloud_.isRollingWindowEnabled()) {
+			integrateLaserScanInRollingWindow(laser_scan, true);
+		} else {
+			integrateLaserScan(laser_scan);
+		}
+		return;
+	}
+
+	ROS_DEBUG_STREAM("Caching laser scan from topic " << laserscan_topics_names_[laser_scan_topic_index] << " (" << laser_scan_synchronizer_.getNumberOfFilledSlots() + 1 << " of " << laser_scan_synchronizer_.getNumberOfTopics() << " laser scans for synchronization)");
+
+	bool synchronized_laser_scans_available = laser_scan_synchronizer_.addLaserScan(laser_scan_topic_index, laser_scan);
+
+	if (laser_scan_synchronizer_.getTotalNumberOfDroppedLaserScans() > number_of_synchronization_drops_reported_) {
+		number_of_synchronization_drops_reported_ = laser_scan_synchronizer_.getTotalNumberOfDroppedLaserScans();
+		std::stringstream ss;
+		for (size_t i = 0; i < laserscan_topics_names_.size(); ++i) {
+			ss << " [" << laserscan_topics_names_[i] << ": " << laser_scan_synchronizer_.getNumberOfDroppedLaserScans(i) << "]";
+		}
+		ROS_WARN_STREAM_THROTTLE(5.0, "Discarded laser scans that could not be synchronized within " << laser_scan_synchronizer_.getMaxTimeSkew() << " seconds (drops per topic:" << ss.str() << ")");
+	}
+
+	if (synchronized_laser_scans_available) {
+		const std::vector<sensor_msgs::LaserScanConstPtr>& synchronized_laser_scans = laser_scan_synchronizer_.getSynchronizedLaserScans();
+		for (size_t i = 0; i < synchronized_laser_scans.size(); ++i) {
+			laserscan_to_pointcloud_.setLaserId(i); // slots are indexed by topic
+			if (laserscan_to_pointcloud_.isRollingWindowEnabled()) {
+				integrateLaserScanInRollingWindow(synchronized_laser_scans[i], i + 1 == synchronized_laser_scans.size()); // one cloud for each synchronized group
+			} else {
+				integrateLaserScan(synchronized_laser_scans[i]);
+			}
+		}
+		laser_scan_synchronizer_.clearSynchronizedLaserScans();
+	}
+}
+
+
+void LaserScanToPointcloudAssembler::processMultiEchoLaserScan(const sensor_msgs::MultiEchoLaserScanConstPtr& multi_echo_laser_scan, size_t multi_echo_laser_scan_topic_index) {
+	boost::recursive_mutex::scoped_lock lock(assembler_mutex_);
+
+	if (deferLazyProcessingInput(LazyProcessingInput(multi_echo_laser_scan, multi_echo_laser_scan_topic_index))) { return; }
+	if (multi_echo_laser_scan->ranges.empty()) { return; }
+
+	// each beam is projected once (with the transform shared by all its echoes), so the selected echoes are integrated as a LaserScan
+	laserscan_to_pointcloud_.setLaserId(laserscan_topics_names_.size() + multi_echo_laser_scan_topic_index); // ids continue after the LaserScan topics
+	sensor_msgs::LaserScanConstPtr laser_scan = laserscan_to_pointcloud_.getMultiEchoLaserScanSelector().selectEchoes(*multi_echo_laser_scan);
+	if (laserscan_to_pointcloud_.isRollingWindowEnabled()) {
+		integrateLaserScanInRollingWindow(laser_scan, true, multi_echo_laser_scan.get());
+	} else {
+		integrateLaserScan(laser_scan, multi_echo_laser_scan.get());
+	}
+}
+
+
+void LaserScanToPointcloudAssembler::processPointCloud(const sensor_msgs::PointCloud2ConstPtr& pointcloud, size_t pointcloud_topic_index) {
+	boost::recursive_mutex::scoped_lock lock(assembler_mutex_);
+
+	if (deferLazyProcessingInput(LazyProcessingInput(pointcloud, pointcloud_topic_index))) { return; }
+
+	laserscan_to_pointcloud_.setLaserId(laserscan_topics_names_.size() + multi_echo_laserscan_subscribers_.size() + pointcloud_topic_index); // ids continue after the LaserScan and MultiEchoLaserScan topics
+	integratePointCloud(pointcloud);
+}
+
+
+void LaserScanToPointcloudAssembler::processCompactLaserScan(const laserscan_to_pointcloud::CompactLaserScanConstPtr& compact_laser_scan, size_t compact_laser_scan_topic_index) {
+	boost::recursive_mutex::scoped_lock lock(assembler_mutex_);
+
+	if (deferLazyProcessingInput(LazyProcessingInput(compact_laser_scan, compact_laser_scan_topic_index))) { return; }
+
+	sensor_msgs::LaserScanConstPtr laser_scan = compact_laserscan_decoders_[compact_laser_scan_topic_index].decode(*compact_laser_scan);
+	if (!laser_scan) {
+		ROS_WARN_STREAM_THROTTLE(5.0, "Dropped CompactLaserScan with geometry " << compact_laser_scan->geometry_id << " because its CompactLaserScanGeometry was not received yet");
+		return;
+	}
+	if (laser_scan->ranges.empty()) { return; }
+
+	laserscan_to_pointcloud_.setLaserId(laserscan_topics_names_.size() + multi_echo_laserscan_subscribers_.size() + pointcloud_subscribers_.size() + compact_laser_scan_topic_index); // ids continue after the other input topics
+	if (laserscan_to_pointcloud_.isRollingWindowEnabled()) {
+		integrateLaserScanInRollingWindow(laser_scan, true);
+	} else {
+		integrateLaserScan(laser_scan);
+	}
+}
+
+
+void LaserScanToPointcloudAssembler::processCompactLaserScanGeometry(const laserscan_to_pointcloud::CompactLaserScanGeometryConstPtr& compact_laser_scan_geometry, size_t compact_laser_scan_topic_index) {
+	boost::recursive_mutex::scoped_lock lock(assembler_mutex_);
+	compact_laserscan_decoders_[compact_laser_scan_topic_index].addGeometry(*compact_laser_scan_geometry);
+}
+
+
+void LaserScanToPointcloudAssembler::integrateLaserScan(const sensor_msgs::LaserScanConstPtr& laser_scan, const sensor_msgs::MultiEchoLaserScan* multi_echo_laser_scan) {
+	if (!applyLoadSheddingPolicy(laser_scan->header.stamp)) { return; }
+	startNewPointCloudIfNeeded(laser_scan->ranges.size());
+
+	int number_of_scans_in_current_pointcloud = (int)laserscan_to_pointcloud_.getNumberOfScansAssembledInCurrentPointcloud();
+
+	std::string laser_frame = laserscan_to_pointcloud_.getLaserFrame().empty() ? laser_scan->header.frame_id : laserscan_to_pointcloud_.getLaserFrame();
+
+	ROS_DEBUG_STREAM("Adding laser scan " << number_of_scans_in_current_pointcloud << " in frame " << laser_frame << " with " << laser_scan->ranges.size() << " points to a point cloud with " << laserscan_to_pointcloud_.getNumberOfPointsInCloud() << " points in frame " << laserscan_to_pointcloud_.getTargetFrame());
+
+	if (laserscan_to_pointcloud_.integrateLaserScanWithShpericalLinearInterpolation(laser_scan, multi_echo_laser_scan)) {
+		addLastScanToAdditionalTargetFrames(laserscan_to_pointcloud_.getCurrentLaserScanStartTime());
+		publishPointCloudChunk(laserscan_to_pointcloud_.getPointCloudLayout().hasTimeField() ? laserscan_to_pointcloud_.getPointCloudStartTime() : laserscan_to_pointcloud_.getCurrentLaserScanStartTime(), false);
+	} else {
+		ROS_WARN_STREAM("Dropped LaserScan with " << laser_scan->ranges.size() << " points because of missing TFs between [" << laser_frame << "] and [" << laserscan_to_pointcloud_.getTargetFrame() << "]" << " (dropped " << ++number_droped_laserscans_ << " LaserScans so far)");
+	}
+
+	ros::Duration scan_duration((laser_scan->ranges.size() - 1) * laser_scan->time_increment);
+	publishPointCloudIfAssembled(ros::Time(laser_scan->header.stamp) + scan_duration);
+}
+
+
+void LaserScanToPointcloudAssembler::integrateLaserScanInRollingWindow(const sensor_msgs::LaserScanConstPtr& laser_scan, bool publish_pointcloud, const sensor_msgs::MultiEchoLaserScan* multi_echo_laser_scan) {
+	if (!applyLoadSheddingPolicy(laser_scan->header.stamp)) { return; }
+	laserscan_to_pointcloud_.setIncludeLaserIntensity(include_laser_intensity_); // the layout of the segments already in the window must be kept
+
+	if (!laserscan_to_pointcloud_.integrateLaserScanWithShpericalLinearInterpolation(laser_scan, multi_echo_laser_scan)) { // only projects the scan into a new segment of the ring
+		std::string laser_frame = laserscan_to_pointcloud_.getLaserFrame().empty() ? laser_scan->header.frame_id : laserscan_to_pointcloud_.getLaserFrame();
+		ROS_WARN_STREAM("Dropped LaserScan with " << laser_scan->ranges.size() << " points because of missing TFs between [" << laser_frame << "] and [" << laserscan_to_pointcloud_.getTargetFrame() << "]" << " (dropped " << ++number_droped_laserscans_ << " LaserScans so far)");
+	}
+
+	ros::Duration scan_duration((laser_scan->ranges.size() - 1) * laser_scan->time_increment);
+	publishRollingWindowPointCloud(ros::Time(laser_scan->header.stamp) + scan_duration, publish_pointcloud);
+}
+
+
+void LaserScanToPointcloudAssembler::integratePointCloud(const sensor_msgs::PointCloud2ConstPtr& pointcloud) {
+	if (!applyLoadSheddingPolicy(pointcloud->header.stamp)) { return; }
+	size_t number_of_points = (size_t)pointcloud->width * (size_t)pointcloud->height;
+	if (laserscan_to_pointcloud_.isRollingWindowEnabled()) {
+		laserscan_to_pointcloud_.setIncludeLaserIntensity(include_laser_intensity_); // the layout of the segments already in the window must be kept
+	} else {
+		startNewPointCloudIfNeeded(number_of_points);
+	}
+
+	std::string sensor_frame = laserscan_to_pointcloud_.getLaserFrame().empty() ? pointcloud->header.frame_id : laserscan_to_pointcloud_.getLaserFrame();
+
+	ROS_DEBUG_STREAM("Adding PointCloud2 in frame " << sensor_frame << " with " << number_of_points << " points to a point cloud with " << laserscan_to_pointcloud_.getNumberOfPointsInCloud() << " points in frame " << laserscan_to_pointcloud_.getTargetFrame());
+
+	ros::Time scan_end_time = pointcloud->header.stamp;
+	if (laserscan_to_pointcloud_.integratePointCloudWithShpericalLinearInterpolation(pointcloud)) {
+		scan_end_time = laserscan_to_pointcloud_.getCurrentLaserScanEndTime(); // time of the last point of the sweep
+		if (!laserscan_to_pointcloud_.isRollingWindowEnabled()) {
+			addLastScanToAdditionalTargetFrames(laserscan_to_pointcloud_.getCurrentLaserScanStartTime());
+			publishPointCloudChunk(laserscan_to_pointcloud_.getPointCloudLayout().hasTimeField() ? laserscan_to_pointcloud_.getPointCloudStartTime() : laserscan_to_pointcloud_.getCurrentLaserScanStartTime(), false);
+		}
+	} else {
+		ROS_WARN_STREAM("Dropped PointCloud2 with " << number_of_points << " points because of missing TFs between [" << sensor_frame << "] and [" << laserscan_to_pointcloud_.getTargetFrame() << "] or unsupported fields" << " (dropped " << ++number_droped_laserscans_ << " scans so far)");
+	}
+
+	if (laserscan_to_pointcloud_.isRollingWindowEnabled()) {
+		publishRollingWindowPointCloud(scan_end_time, true);
+	} else {
+		publishPointCloudIfAssembled(scan_end_time);
+	}
+}
+
+
+void LaserScanToPointcloudAssembler::startNewPointCloudIfNeeded(size_t number_of_points_per_scan) {
 	int number_of_scans_in_current_pointcloud = (int)laserscan_to_pointcloud_.getNumberOfScansAssembledInCurrentPointcloud();
 	if ((number_of_scans_in_current_pointcloud == 0 && laserscan_to_pointcloud_.getNumberOfPointcloudsCreated() == 0)
 			|| number_of_scans_in_current_pointcloud >= number_of_scans_to_assemble_per_cloud_
-			|| timeout_for_cloud_assembly_reached_) {
-		laserscan_to_pointcloud_.setIncludeLaserIntensity(include_laser_intensity_);
-		laserscan_to_pointcloud_.initNewPointCloud(laser_scan->ranges.size() * number_of_scans_to_assemble_per_cloud_);
-		laser_scans_for_each_topic_frame_id_.clear();
+			|| timeout_for_cloud_assembly_reached_
+			|| pointcloud_published_) { // published clouds are shared with subscribers and must not be changed
+		laserscan_to_pointcloud_.setIncludeLaserIntensity(include_laser_intensity_ && current_load_shedding_level_ < LOAD_SHEDDING_SKIP_INTENSITY);
+		updateLevelsOfDetailWithSubscribers();
+		laserscan_to_pointcloud_.setPointCloudDataEnabled(publish_pointcloud_ && (!lazy_processing_ || hasMainPointCloudSubscribers()));
+		laserscan_to_pointcloud_.getRangeImageBuilder().setIntensityImageEnabled(laserscan_to_pointcloud_.isIncludeLaserIntensity());
+		laserscan_to_pointcloud_.initNewPointCloud(number_of_points_per_scan * number_of_scans_to_assemble_per_cloud_);
+		startAdditionalTargetFramesPointClouds();
 		timeout_for_cloud_assembly_reached_ = false;
+		pointcloud_published_ = false;
+		number_of_pointcloud_chunks_in_current_cloud_ = 0;
+		armCloudAssemblyTimeoutTimer();
 
 		ROS_DEBUG_STREAM("Initializing new point cloud");
 	}
+}
 
-	number_of_scans_in_current_pointcloud = (int)laserscan_to_pointcloud_.getNumberOfScansAssembledInCurrentPointcloud();
 
-	std::string laser_frame = laserscan_to_pointcloud_.getLaserFrame().empty() ? laser_scan->header.frame_id : laserscan_to_pointcloud_.getLaserFrame();
+void LaserScanToPointcloudAssembler::publishPointCloudIfAssembled(const ros::Time& scan_end_time) {
+	last_laser_scan_end_time_ = scan_end_time;
+
+	timeout_for_cloud_assembly_reached_ = (ros::Time::now() - laserscan_to_pointcloud_.getPointcloud()->header.stamp) > timeout_for_cloud_assembly_;
+	int number_of_scans_in_current_pointcloud = (int)laserscan_to_pointcloud_.getNumberOfScansAssembledInCurrentPointcloud();
+	if ((number_of_scans_in_current_pointcloud >= number_of_scans_to_assemble_per_cloud_ || timeout_for_cloud_assembly_reached_) && laserscan_to_pointcloud_.getNumberOfPointsInCloud() > 0) {
+		publishPointCloud(last_laser_scan_end_time_);
+	}
+}
+
+
+void LaserScanToPointcloudAssembler::publishRollingWindowPointCloud(const ros::Time& scan_end_time, bool publish_pointcloud) {
+	last_laser_scan_end_time_ = scan_end_time;
+
+	size_t number_of_points_in_window = laserscan_to_pointcloud_.getPointcloudSegmentRing().getNumberOfPoints();
+	if (publish_pointcloud && number_of_points_in_window > 0) {
+		laserscan_to_pointcloud_.initNewPointCloud(number_of_points_in_window); // the previous window cloud may still be in use by subscribers
+		publishPointCloud(last_laser_scan_end_time_);
+	}
+}
+
+
+LaserScanToPointcloudAssembler::LoadSheddingLevel LaserScanToPointcloudAssembler::computeLoadSheddingLevel(const ros::Time& scan_stamp) const {
+	if (max_laser_scan_age_ <= ros::Duration(0)) { return LOAD_SHEDDING_NONE; }
+
+	// each quarter of the maximum age adds a degradation step (scans older than the maximum age are dropped)
+	double laser_scan_age_ratio = (ros::Time::now() - scan_stamp).toSec() / max_laser_scan_age_.toSec();
+	if (laser_scan_age_ratio > 1.0) { return LOAD_SHEDDING_DROP_LASER_SCAN; }
+	if (laser_scan_age_ratio > 0.75) { return laserscan_to_pointcloud_.isRollingWindowEnabled() ? LOAD_SHEDDING_FEWER_INTERPOLATION_SLICES : LOAD_SHEDDING_SKIP_INTENSITY; } // the segments in the window must keep their layout
+	if (laser_scan_age_ratio > 0.5) { return LOAD_SHEDDING_FEWER_INTERPOLATION_SLICES; }
+	if (laser_scan_age_ratio > 0.25) { return LOAD_SHEDDING_BEAM_DECIMATION; }
+	return LOAD_SHEDDING_NONE;
+}
+
+
+bool LaserScanToPointcloudAssembler::applyLoadSheddingPolicy(const ros::Time& scan_stamp) {
+	current_load_shedding_level_ = computeLoadSheddingLevel(scan_stamp);
+	++number_of_laser_scans_in_each_load_shedding_level_[current_load_shedding_level_];
+
+	if (current_load_shedding_level_ != LOAD_SHEDDING_NONE) {
+		ROS_WARN_STREAM_THROTTLE(5.0, "Laser assembler is overloaded (LaserScans older than " << max_laser_scan_age_.toSec() << " seconds are dropped) -> LaserScans processed with"
+				<< " [beam decimation: " << number_of_laser_scans_in_each_load_shedding_level_[LOAD_SHEDDING_BEAM_DECIMATION] << "]"
+				<< " [fewer interpolation slices: " << number_of_laser_scans_in_each_load_shedding_level_[LOAD_SHEDDING_FEWER_INTERPOLATION_SLICES] << "]"
+				<< " [no intensity: " << number_of_laser_scans_in_each_load_shedding_level_[LOAD_SHEDDING_SKIP_INTENSITY] << "]"
+				<< " [dropped: " << number_of_laser_scans_in_each_load_shedding_level_[LOAD_SHEDDING_DROP_LASER_SCAN] << "]"
+				<< " | point clouds dropped: " << number_of_pointclouds_dropped_by_age_);
+	}
+
+	if (current_load_shedding_level_ == LOAD_SHEDDING_DROP_LASER_SCAN) { return false; }
+
+	laserscan_to_pointcloud_.setBeamDecimationStride(current_load_shedding_level_ >= LOAD_SHEDDING_BEAM_DECIMATION ? (size_t)std::max(load_shedding_beam_decimation_stride_, 1) : 1);
+	laserscan_to_pointcloud_.setNumberOfTfQueriesForSphericalInterpolation(current_load_shedding_level_ >= LOAD_SHEDDING_FEWER_INTERPOLATION_SLICES ?
+			std::min(number_of_tf_queries_for_spherical_interpolation_, 2) : number_of_tf_queries_for_spherical_interpolation_); // only interpolates between the scan start and end
+	return true;
+}
+
 
-	ROS_DEBUG_STREAM((enforce_reception_of_laser_scans_in_all_topics_ ? "Caching" : "Adding") << " laser scan " << number_of_scans_in_current_pointcloud + laser_scans_for_each_topic_frame_id_.size() << " in frame " << laser_frame << " with " << laser_scan->ranges.size() << " points to a point cloud with " << laserscan_to_pointcloud_.getNumberOfPointsInCloud() << " points in frame " << laserscan_to_pointcloud_.getTargetFrame());
+void LaserScanToPointcloudAssembler::publishPointCloud(const ros::Time& pointcloud_stamp) {
+	if (max_laser_scan_age_ > ros::Duration(0) && (ros::Time::now() - pointcloud_stamp) > max_laser_scan_age_) {
+		ROS_WARN_STREAM_THROTTLE(5.0, "Dropped point cloud older than " << max_laser_scan_age_.toSec() << " seconds (dropped " << ++number_of_pointclouds_dropped_by_age_ << " point clouds so far)");
+		publishPointCloudChunk(pointcloud_stamp, true); // consumers of the chunks already have its points
+		pointcloud_published_ = true; // start a new cloud
+		cloud_assembly_timeout_timer_.stop();
+		return;
+	}
 
-	if (enforce_reception_of_laser_scans_in_all_topics_) {
-		if (laser_scans_for_each_topic_frame_id_.find(laser_scan->header.frame_id) != laser_scans_for_each_topic_frame_id_.end())
-			ROS_WARN_STREAM("Discarding previously cached laser scan for frame " << laser_scan->header.frame_id);
+	sensor_msgs::PointCloud2Ptr pointcloud = laserscan_to_pointcloud_.getPointcloud();
+	pointcloud->header.stamp = laserscan_to_pointcloud_.getPointCloudLayout().hasTimeField() ? laserscan_to_pointcloud_.getPointCloudStartTime() : pointcloud_stamp; // reference of the per point time
+	laserscan_to_pointcloud_.finishPointCloud();
+	publishPointCloudChunk(pointcloud->header.stamp, true);
+	if (publish_pointcloud_ && (laserscan_to_pointcloud_.isPointCloudDataEnabled() || laserscan_to_pointcloud_.isRollingWindowEnabled())) {
+		if (laserscan_to_pointcloud_.isWireBufferEnabled()) {
+			pointcloud_publisher_.publish(laserscan_to_pointcloud_.getWireBuffer().getMessage()); // roscpp sends the already serialized buffer
+		} else {
+			pointcloud_publisher_.publish(sensor_msgs::PointCloud2ConstPtr(pointcloud)); // intra-process subscribers receive this pointer without copies
+		}
+		publishPointCloudInSharedMemory(*pointcloud);
+		if (compressed_pointcloud_publisher_.getNumSubscribers() > 0) { queuePointCloudForCompression(pointcloud); }
+		publishAdditionalTargetFramesPointClouds(pointcloud->header.stamp);
+	}
+
+	for (size_t i = 0; !laserscan_to_pointcloud_.isRollingWindowEnabled() && i < level_of_detail_pointcloud_publishers_.size() && i < laserscan_to_pointcloud_.getNumberOfLevelsOfDetail(); ++i) {
+		sensor_msgs::PointCloud2Ptr level_of_detail_pointcloud = laserscan_to_pointcloud_.buildLevelOfDetailPointCloud(i); // NULL when the level had no subscribers
+		if (level_of_detail_pointcloud) {
+			level_of_detail_pointcloud_publishers_[i].publish(sensor_msgs::PointCloud2ConstPtr(level_of_detail_pointcloud));
+		}
+	}
+
+	RangeImageBuilder& range_image_builder = laserscan_to_pointcloud_.getRangeImageBuilder();
+	if (range_image_builder.isEnabled() && range_image_builder.getRangeImage()) { // the builder starts new messages with the next cloud
+		range_image_builder.getRangeImage()->header.stamp = pointcloud_stamp;
+		range_image_publisher_.publish(sensor_msgs::ImageConstPtr(range_image_builder.getRangeImage()));
+		if (range_image_builder.getIntensityImage()) {
+			range_image_builder.getIntensityImage()->header.stamp = pointcloud_stamp;
+			range_image_intensity_publisher_.publish(sensor_msgs::ImageConstPtr(range_image_builder.getIntensityImage()));
+		}
+		range_image_builder.getRowPoses()->header.stamp = pointcloud_stamp;
+		range_image_poses_publisher_.publish(nav_msgs::PathConstPtr(range_image_builder.getRowPoses()));
+	}
+	pointcloud_published_ = true;
+	cloud_assembly_timeout_timer_.stop();
+
+	ROS_DEBUG_STREAM("Publishing cloud with " << (pointcloud->width * pointcloud->height) << " points assembled from " << laserscan_to_pointcloud_.getNumberOfScansAssembledInCurrentPointcloud() << " LaserScans" \
+			<< (timeout_for_cloud_assembly_reached_ ? " (timeout reached)" : ""));
+}
+
+
+void LaserScanToPointcloudAssembler::publishPointCloudInSharedMemory(const sensor_msgs::PointCloud2& pointcloud) {
+	if (!shared_memory_pointcloud_publisher_.isOpen() || shared_memory_descriptor_publisher_.getNumSubscribers() == 0) { return; }
+
+	SharedMemoryPointCloudPtr descriptor(new SharedMemoryPointCloud());
+	bool written;
+	if (laserscan_to_pointcloud_.isWireBufferEnabled()) { // the cloud message only has the header and the fields, the serialized cloud is in the wire buffer
+		const PointCloud2WireMessage& wire_message = laserscan_to_pointcloud_.getWireBuffer().getMessage();
+		written = shared_memory_pointcloud_publisher_.writeSerializedPointCloud(wire_message.buffer_.get() + 4, wire_message.serialized_length_, pointcloud.header, *descriptor);
+	} else {
+		written = shared_memory_pointcloud_publisher_.writePointCloud(pointcloud, *descriptor);
+	}
+
+	if (written) { shared_memory_descriptor_publisher_.publish(SharedMemoryPointCloudConstPtr(descriptor)); }
+}
 
-		laser_scans_for_each_topic_frame_id_[laser_scan->header.frame_id] = laser_scan;
 
-		if (laser_scans_for_each_topic_frame_id_.size() >= laserscan_subscribers_.size()) {
-			for (std::map<std::string, sensor_msgs::LaserScanConstPtr>::iterator it = laser_scans_for_each_topic_frame_id_.begin(); it != laser_scans_for_each_topic_frame_id_.end(); ++it) {
-				if (!laserscan_to_pointcloud_.integrateLaserScanWithShpericalLinearInterpolation(it->second)) {
-					ROS_WARN_STREAM("Dropped LaserScan with " << it->second->ranges.size() << " points because of missing TFs between [" << laser_frame << "] and [" << laserscan_to_pointcloud_.getTargetFrame() << "]" << " (dropped " << ++number_droped_laserscans_ << " LaserScans so far)");
-				}
+void LaserScanToPointcloudAssembler::publishPointCloudChunk(const ros::Time& chunk_stamp, bool end_of_cloud) {
+	if (!publish_pointcloud_chunks_ || !laserscan_to_pointcloud_.isPointCloudDataEnabled() || laserscan_to_pointcloud_.isRollingWindowEnabled()) { return; }
+
+	size_t number_of_points = end_of_cloud ? 0 : laserscan_to_pointcloud_.getLastLaserScanNumberOfPoints();
+	if (!end_of_cloud && number_of_points == 0) { return; }
+
+	uint32_t chunk_index = number_of_pointcloud_chunks_in_current_cloud_;
+	if (!end_of_cloud) { ++number_of_pointcloud_chunks_in_current_cloud_; } // counted even without subscribers, so the indexes do not depend on when they connect
+	if (pointcloud_chunks_publisher_.getNumSubscribers() == 0) { return; }
+
+	const sensor_msgs::PointCloud2& pointcloud = *laserscan_to_pointcloud_.getPointcloud();
+	PointCloudChunkPtr chunk(new PointCloudChunk());
+	chunk->header.stamp = chunk_stamp;
+	chunk->header.frame_id = pointcloud.header.frame_id;
+	chunk->cloud_sequence = pointcloud.header.seq;
+	chunk->chunk_index = chunk_index;
+	chunk->end_of_cloud = end_of_cloud;
+	chunk->points.header = chunk->header;
+	chunk->points.fields = pointcloud.fields;
+	chunk->points.height = number_of_points > 0 ? 1 : 0;
+	chunk->points.width = number_of_points;
+	chunk->points.is_bigendian = false;
+	chunk->points.point_step = pointcloud.point_step;
+	chunk->points.row_step = number_of_points * pointcloud.point_step;
+	chunk->points.is_dense = pointcloud.is_dense;
+	if (number_of_points > 0) {
+		const uint8_t* data = laserscan_to_pointcloud_.getLastLaserScanData(); // in the message or in the wire buffer of the cloud being assembled
+		chunk->points.data.assign(data, data + chunk->points.row_step);
+	}
+	pointcloud_chunks_publisher_.publish(PointCloudChunkConstPtr(chunk));
+}
+
+
+void LaserScanToPointcloudAssembler::setupAdditionalTargetFrames(std::string additional_target_frames) {
+	std::replace(additional_target_frames.begin(), additional_target_frames.end(), '+', ' ');
+
+	std::stringstream ss(additional_target_frames);
+	std::string frame_id;
+
+	additional_target_frames_.clear();
+	while (ss >> frame_id && !frame_id.empty()) {
+		AdditionalTargetFrame additional_target_frame;
+		additional_target_frame.frame_id_ = frame_id;
+		additional_target_frame.number_of_dropped_scans_ = 0;
+		additional_target_frames_.push_back(additional_target_frame);
+		ROS_INFO_STREAM("Laser assembler is also publishing the clouds in frame " << frame_id);
+	}
+}
+
+
+void LaserScanToPointcloudAssembler::startAdditionalTargetFramesPointClouds() {
+	const sensor_msgs::PointCloud2& pointcloud = *laserscan_to_pointcloud_.getPointcloud();
+	for (size_t i = 0; i < additional_target_frames_.size(); ++i) {
+		additional_target_frames_[i].pointcloud_ = additional_target_frames_[i].pointcloud_pool_.acquirePointCloud(); // the previous cloud may still be in use by subscribers
+		sensor_msgs::PointCloud2& frame_pointcloud = *additional_target_frames_[i].pointcloud_;
+		frame_pointcloud.header.seq = pointcloud.header.seq;
+		frame_pointcloud.header.frame_id = additional_target_frames_[i].frame_id_;
+		frame_pointcloud.fields = pointcloud.fields;
+		frame_pointcloud.height = pointcloud.height;
+		frame_pointcloud.width = 0;
+		frame_pointcloud.is_bigendian = false;
+		frame_pointcloud.point_step = pointcloud.point_step;
+		frame_pointcloud.row_step = 0;
+		frame_pointcloud.is_dense = pointcloud.is_dense;
+		frame_pointcloud.data.clear(); // recycled clouds keep the capacity of their data
+	}
+}
+
+
+void LaserScanToPointcloudAssembler::addLastScanToAdditionalTargetFrames(const ros::Time& scan_time) {
+	size_t number_of_points = laserscan_to_pointcloud_.getLastLaserScanNumberOfPoints();
+	if (additional_target_frames_.empty() || number_of_points == 0) { return; }
+
+	// the scan was projected once into the target frame, so each additional frame only needs the rigid transform between the frames
+	// (one transform per scan, so the additional frames must be static relative to the target frame)
+	const uint8_t* scan_data = laserscan_to_pointcloud_.getLastLaserScanData(); // in the message or in the wire buffer of the cloud being assembled
+	uint32_t point_step = laserscan_to_pointcloud_.getPointcloud()->point_step;
+	bool organized_layout = laserscan_to_pointcloud_.isOrganizedLayoutInUse();
+	for (size_t i = 0; i < additional_target_frames_.size(); ++i) {
+		AdditionalTargetFrame& additional_target_frame = additional_target_frames_[i];
+		tf2::Transform target_to_frame_transform;
+		bool transform_available = laserscan_to_pointcloud_.getTfCollector().lookForTransform(target_to_frame_transform, additional_target_frame.frame_id_, laserscan_to_pointcloud_.getTargetFrame(), scan_time, laserscan_to_pointcloud_.getTfLookupTimeout()); // the recovery transform only applies to the target frame
+		if (!transform_available) {
+			ROS_WARN_STREAM_THROTTLE(5.0, "Scan missing in the cloud of frame " << additional_target_frame.frame_id_ << " (dropped " << ++additional_target_frame.number_of_dropped_scans_ << " scans so far)");
+			if (!organized_layout) { continue; } // organized clouds keep a row of invalid points, so their rows stay aligned with the rows of the main cloud
+		}
+
+		sensor_msgs::PointCloud2& frame_pointcloud = *additional_target_frame.pointcloud_;
+		size_t data_offset = frame_pointcloud.data.size();
+		frame_pointcloud.data.insert(frame_pointcloud.data.end(), scan_data, scan_data + number_of_points * point_step);
+		if (transform_available) {
+			PointCloudLayout::transformFloat32Positions(&frame_pointcloud.data[data_offset], number_of_points, point_step, target_to_frame_transform);
+		} else {
+			const PointCloudLayout& layout = laserscan_to_pointcloud_.getPointCloudLayout();
+			for (size_t point_offset = data_offset; point_offset < frame_pointcloud.data.size(); point_offset += point_step) {
+				layout.writeInvalidPoint(&frame_pointcloud.data[point_offset]);
 			}
+		}
+		if (organized_layout) { // one row per scan
+			frame_pointcloud.width = number_of_points;
+			++frame_pointcloud.height;
+		} else {
+			frame_pointcloud.width += number_of_points;
+		}
+		frame_pointcloud.row_step = frame_pointcloud.width * point_step;
+	}
+}
+
+
+void LaserScanToPointcloudAssembler::publishAdditionalTargetFramesPointClouds(const ros::Time& pointcloud_stamp) {
+	for (size_t i = 0; i < additional_target_frames_.size(); ++i) {
+		if (!additional_target_frames_[i].pointcloud_) { continue; }
+		additional_target_frames_[i].pointcloud_->header.stamp = pointcloud_stamp;
+		additional_target_frames_[i].publisher_.publish(sensor_msgs::PointCloud2ConstPtr(additional_target_frames_[i].pointcloud_));
+	}
+}
 
-			laser_scans_for_each_topic_frame_id_.clear();
+
+void LaserScanToPointcloudAssembler::queuePointCloudForCompression(const sensor_msgs::PointCloud2ConstPtr& pointcloud) {
+	boost::mutex::scoped_lock lock(compression_mutex_);
+	if (pointcloud_to_compress_) {
+		ROS_DEBUG_STREAM("Replaced a cloud that was waiting for compression (skipped " << ++number_of_pointclouds_skipped_by_compression_ << " clouds so far)");
+	}
+
+	// published clouds are never changed, so the compression thread can read them while the next cloud is assembled
+	pointcloud_to_compress_ = pointcloud;
+	if (laserscan_to_pointcloud_.isWireBufferEnabled()) {
+		const PointCloud2WireMessage& wire_message = laserscan_to_pointcloud_.getWireBuffer().getMessage();
+		pointcloud_to_compress_wire_buffer_ = wire_message.buffer_;
+		pointcloud_to_compress_data_ = wire_message.buffer_.get() + wire_message.data_offset_;
+	} else {
+		pointcloud_to_compress_wire_buffer_.reset();
+		pointcloud_to_compress_data_ = pointcloud->data.empty() ? NULL : &pointcloud->data[0];
+	}
+	compression_condition_.notify_one();
+}
+
+
+void LaserScanToPointcloudAssembler::compressPointClouds() {
+	for (;;) {
+		sensor_msgs::PointCloud2ConstPtr pointcloud;
+		boost::shared_array<uint8_t> wire_buffer;
+		const uint8_t* data = NULL;
+		ros::Publisher compressed_pointcloud_publisher;
+		{
+			boost::mutex::scoped_lock lock(compression_mutex_);
+			while (!pointcloud_to_compress_ && !compression_thread_shutdown_) { compression_condition_.wait(lock); }
+			if (compression_thread_shutdown_) { return; }
+			pointcloud.swap(pointcloud_to_compress_);
+			wire_buffer.swap(pointcloud_to_compress_wire_buffer_);
+			data = pointcloud_to_compress_data_;
+			compressed_pointcloud_publisher = compressed_pointcloud_publisher_; // the topic may be changed by dynamic reconfigure
+		}
+
+		CompressedPointCloudPtr compressed_pointcloud(new CompressedPointCloud());
+		if (pointcloud_compressor_.compress(*pointcloud, data, *compressed_pointcloud)) {
+			compressed_pointcloud_publisher.publish(CompressedPointCloudConstPtr(compressed_pointcloud));
+		} else {
+			ROS_WARN_STREAM_THROTTLE(5.0, "Failed to compress cloud without float32 or int16 x, y and z fields");
 		}
-	} else if (!laserscan_to_pointcloud_.integrateLaserScanWithShpericalLinearInterpolation(laser_scan)) {
-		ROS_WARN_STREAM("Dropped LaserScan with " << laser_scan->ranges.size() << " points because of missing TFs between [" << laser_frame << "] and [" << laserscan_to_pointcloud_.getTargetFrame() << "]" << " (dropped " << ++number_droped_laserscans_ << " LaserScans so far)");
 	}
+}
 
-	timeout_for_cloud_assembly_reached_ = (ros::Time::now() - laserscan_to_pointcloud_.getPointcloud()->header.stamp) > timeout_for_cloud_assembly_;
-	number_of_scans_in_current_pointcloud = (int)laserscan_to_pointcloud_.getNumberOfScansAssembledInCurrentPointcloud();
-	if ((number_of_scans_in_current_pointcloud >= number_of_scans_to_assemble_per_cloud_ || timeout_for_cloud_assembly_reached_) && laserscan_to_pointcloud_.getNumberOfPointsInCloud() > 0) {
-		ros::Duration scan_duration((laser_scan->ranges.size() - 1) * laser_scan->time_increment);
-		laserscan_to_pointcloud_.getPointcloud()->header.stamp = ros::Time(laser_scan->header.stamp) + scan_duration;
-		pointcloud_publisher_.publish(laserscan_to_pointcloud_.getPointcloud());
 
-		ROS_DEBUG_STREAM("Publishing cloud with " << (laserscan_to_pointcloud_.getPointcloud()->width * laserscan_to_pointcloud_.getPointcloud()->height) << " points assembled from " << number_of_scans_in_current_pointcloud << " LaserScans" \
-				<< (timeout_for_cloud_assembly_reached_ ? " (timeout reached)" : ""));
+void LaserScanToPointcloudAssembler::stopPointCloudCompression() {
+	{
+		boost::mutex::scoped_lock lock(compression_mutex_);
+		compression_thread_shutdown_ = true;
+		pointcloud_to_compress_.reset();
+		pointcloud_to_compress_wire_buffer_.reset();
+	}
+	compression_condition_.notify_one();
+	if (compression_thread_.joinable()) { compression_thread_.join(); }
+}
+
+
+void LaserScanToPointcloudAssembler::armCloudAssemblyTimeoutTimer() {
+	// one shot timer with a deadline set when the cloud starts, so a stalled laser does not delay the publication of the partial cloud
+	ros::WallDuration timeout(timeout_for_cloud_assembly_.toSec());
+	cloud_assembly_deadline_ = ros::SteadyTime::now() + timeout;
+	cloud_assembly_timeout_timer_.stop();
+	cloud_assembly_timeout_timer_.setPeriod(timeout);
+	cloud_assembly_timeout_timer_.start();
+}
+
+
+void LaserScanToPointcloudAssembler::processCloudAssemblyTimeout(const ros::SteadyTimerEvent& timer_event) {
+	boost::recursive_mutex::scoped_lock lock(assembler_mutex_);
+
+	if (pointcloud_published_ || ros::SteadyTime::now() < cloud_assembly_deadline_) { return; } // event from a cloud that was already published or from a timer that was rearmed meanwhile
+
+	timeout_for_cloud_assembly_reached_ = true;
+	if (laserscan_to_pointcloud_.getNumberOfPointsInCloud() > 0) {
+		ROS_DEBUG_STREAM("Cloud assembly timeout reached without receiving the remaining LaserScans");
+		publishPointCloud(last_laser_scan_end_time_);
 	}
 }
 
 
 void LaserScanToPointcloudAssembler::adjustAssemblyConfiguration(const geometry_msgs::Vector3& linear_velocity, const geometry_msgs::Vector3& angular_velocity) {
+	boost::recursive_mutex::scoped_lock lock(assembler_mutex_);
+
 	double inverse_linear_velocity = max_linear_velocity_ - std::min(std::sqrt(linear_velocity.x * linear_velocity.x + linear_velocity.y * linear_velocity.y + linear_velocity.z * linear_velocity.z), max_linear_velocity_);
 	double inverse_angular_velocity = max_angular_velocity_ - std::min(std::sqrt(angular_velocity.x * angular_velocity.x + angular_velocity.y * angular_velocity.y + angular_velocity.z * angular_velocity.z), max_angular_velocity_);
 
@@ -259,6 +1142,8 @@ void LaserScanToPointcloudAssembler::adjustAssemblyConfigurationFromOdometry(con
 
 
 void LaserScanToPointcloudAssembler::adjustAssemblyConfigurationFromIMU(const sensor_msgs::ImuConstPtr& imu) {
+	boost::recursive_mutex::scoped_lock lock(assembler_mutex_);
+
 	if (imu_last_message_stamp_.toSec() > 0.1) {
 		double imu_dt = imu->header.stamp.toSec() - imu_last_message_stamp_.toSec();
 		if (imu_dt > 0) {
@@ -299,7 +1184,10 @@ void LaserScanToPointcloudAssembler::dynamicReconfigureCallback(laserscan_to_poi
 		if (!config.pointcloud_publish_topic.empty() && pointcloud_publish_topic_ != config.pointcloud_publish_topic) {
 			pointcloud_publish_topic_ = config.pointcloud_publish_topic;
 			pointcloud_publisher_.shutdown();
-			pointcloud_publisher_ = node_handle_->advertise<sensor_msgs::PointCloud2>(pointcloud_publish_topic_, 10, true);
+			shared_memory_descriptor_publisher_.shutdown();
+			pointcloud_chunks_publisher_.shutdown();
+			for (size_t i = 0; i < additional_target_frames_.size(); ++i) { additional_target_frames_[i].publisher_.shutdown(); }
+			advertisePointCloudPublishers(); // the derived topics use the cloud topic as prefix
 		}
 
 		number_of_scans_to_assemble_per_cloud_ = config.number_of_scans_to_assemble_per_cloud;
@@ -309,7 +1197,8 @@ void LaserScanToPointcloudAssembler::dynamicReconfigureCallback(laserscan_to_poi
 		laserscan_to_pointcloud_.setTargetFrame(config.target_frame);
 		laserscan_to_pointcloud_.setMinRangeCutoffPercentageOffset(config.min_range_cutoff_percentage_offset);
 		laserscan_to_pointcloud_.setMaxRangeCutoffPercentageOffset(config.max_range_cutoff_percentage_offset);
-		laserscan_to_pointcloud_.setNumberOfTfQueriesForSphericalInterpolation(config.number_of_tf_queries_for_spherical_interpolation);
+		number_of_tf_queries_for_spherical_interpolation_ = config.number_of_tf_queries_for_spherical_interpolation;
+		laserscan_to_pointcloud_.setNumberOfTfQueriesForSphericalInterpolation(number_of_tf_queries_for_spherical_interpolation_);
 		laserscan_to_pointcloud_.setRecoveryFrame(config.recovery_frame);
 	}
 }
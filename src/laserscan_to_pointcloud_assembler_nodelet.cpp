@@ -1,5 +1,5 @@
 /**\file laserscan_to_pointcloud_nodelet.cpp
- * \brief Description...
+ * \brief Nodelet wrapper of the LaserScanToPointcloudAssembler.
  *
  * @version 1.0
  * @author Carlos Miguel Correia da Costa
@@ -7,6 +7,7 @@
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 #include <laserscan_to_pointcloud/laserscan_to_pointcloud_assembler_nodelet.h>
+#include <pluginlib/class_list_macros.h>
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <imports>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -16,17 +17,53 @@
 namespace laserscan_to_pointcloud {
 // =============================================================================   <public-section>   ==========================================================================
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
-LaserScanToPointcloudNodelet::LaserScanToPointcloudNodelet() {
-	// TODO Auto-generated constructor stub
-
-}
+LaserScanToPointcloudNodelet::LaserScanToPointcloudNodelet() {}
 
 LaserScanToPointcloudNodelet::~LaserScanToPointcloudNodelet() {
-	// TODO Auto-generated destructor stub
+	if (laserscan_to_pointcloud_assembler_) {
+		laserscan_to_pointcloud_assembler_->cancelStartup(); // an unload during startup must not wait for the recovery pose TFs
+	}
+
+	if (assembler_startup_thread_.joinable()) {
+		assembler_startup_thread_.join();
+	}
+
+	if (callback_queue_spinner_) {
+		callback_queue_spinner_->stop();
+	}
+
+	if (laserscan_to_pointcloud_assembler_) {
+		laserscan_to_pointcloud_assembler_->stopAssemblingLaserScans();
+	}
+
+	// the assembler subscriptions and the node handles must be gone before the callback queue they use
+	laserscan_to_pointcloud_assembler_.reset();
+	node_handle_.reset();
+	private_node_handle_.reset();
+
+	callback_queue_.disable();
+	callback_queue_.clear();
 }
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <LaserScanToPointcloudNodelet-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+void LaserScanToPointcloudNodelet::onInit() {
+	node_handle_.reset(new ros::NodeHandle(getNodeHandle()));
+	private_node_handle_.reset(new ros::NodeHandle(getPrivateNodeHandle()));
+	node_handle_->setCallbackQueue(&callback_queue_);
+	private_node_handle_->setCallbackQueue(&callback_queue_);
+
+	int number_of_callback_threads;
+	private_node_handle_->param("number_of_callback_threads", number_of_callback_threads, 2);
+	NODELET_INFO_STREAM("Laser assembler nodelet is using " << number_of_callback_threads << " threads in its callback queue");
+
+	laserscan_to_pointcloud_assembler_.reset(new LaserScanToPointcloudAssembler(node_handle_, private_node_handle_));
+	callback_queue_spinner_.reset(new ros::AsyncSpinner((uint32_t)std::max(number_of_callback_threads, 1), &callback_queue_));
+	callback_queue_spinner_->start();
+
+	// the recovery pose setup can wait for TFs for several seconds and onInit must not block the nodelet manager
+	assembler_startup_thread_ = boost::thread(&LaserScanToPointcloudAssembler::startAssemblingLaserScans, laserscan_to_pointcloud_assembler_.get());
+}
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </LaserScanToPointcloudNodelet-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 // ==============================================================================  </public-section>   =========================================================================
 
@@ -36,3 +73,5 @@ LaserScanToPointcloudNodelet::~LaserScanToPointcloudNodelet() {
 // =============================================================================   <private-section>   =========================================================================
 // =============================================================================   </private-section>  =========================================================================
 } /* namespace laserscan_to_pointcloud */
+
+PLUGINLIB_EXPORT_CLASS(laserscan_to_pointcloud::LaserScanToPointcloudNodelet, nodelet::Nodelet)
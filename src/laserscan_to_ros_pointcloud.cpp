@@ -19,7 +19,20 @@ namespace laserscan_to_pointcloud {
 LaserScanToROSPointcloud::LaserScanToROSPointcloud(std::string target_frame, bool include_laser_intensity, double min_range_cutoff_percentage, double max_range_cutoff_percentage) :
 		LaserScanToPointcloud(target_frame, min_range_cutoff_percentage, max_range_cutoff_percentage),
 		include_laser_intensity_(include_laser_intensity),
-		pointcloud_data_position_(NULL) {
+		voxel_grid_(0.0),
+		level_of_detail_voxel_grid_fed_with_points_(NULL),
+		pointcloud_data_position_(NULL),
+		laser_scan_data_start_(NULL),
+		last_laser_scan_data_(NULL),
+		last_laser_scan_number_of_points_(0),
+		laser_scan_time_offset_(0.0),
+		wire_buffer_enabled_(false),
+		extra_fields_(0),
+		pointcloud_data_enabled_(true),
+		organized_pointcloud_(false),
+		organized_layout_(false),
+		rolling_window_duration_(0) {
+	updatePointCloudLayout();
 }
 
 LaserScanToROSPointcloud::~LaserScanToROSPointcloud() {	}
@@ -27,64 +40,236 @@ LaserScanToROSPointcloud::~LaserScanToROSPointcloud() {	}
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <LaserScanToROSPointcloud-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 void LaserScanToROSPointcloud::initNewPointCloud(size_t number_of_reserved_points) {
-	pointcloud_ = sensor_msgs::PointCloud2Ptr(new sensor_msgs::PointCloud2());
+	pointcloud_ = pointcloud_pool_.acquirePointCloud();
 	resetNumberOfPointsInCloud();
 	resetNumberOfScansAsembledInCurrentCloud();
 
+	if (!pointcloud_layout_.matchesFields(pointcloud_->fields)) { // recycled clouds usually already have the right fields
+		pointcloud_->fields = pointcloud_layout_.getFields();
+	}
+	voxel_grid_.clear();
+	last_laser_scan_data_ = NULL;
+	last_laser_scan_number_of_points_ = 0;
+
+	level_of_detail_voxel_grid_fed_with_points_ = NULL;
+	for (size_t i = 0; i < levels_of_detail_.size(); ++i) {
+		levels_of_detail_[i].voxel_grid_.clear();
+		if (levels_of_detail_[i].enabled_ && level_of_detail_voxel_grid_fed_with_points_ == NULL && !isRollingWindowEnabled()) {
+			level_of_detail_voxel_grid_fed_with_points_ = &levels_of_detail_[i].voxel_grid_;
+		}
+	}
+
 	pointcloud_->header.seq = getNumberOfPointcloudsCreated();
 	pointcloud_->header.stamp = ros::Time::now();
 	pointcloud_->header.frame_id = getTargetFrame();
-	pointcloud_->height = 1;
+	pointcloud_->height = organized_layout_ ? 0 : 1; // organized clouds get a new row for each LaserScan
 	pointcloud_->width = 0;
-	pointcloud_->fields.clear();
-	pointcloud_->fields.resize(include_laser_intensity_ ? 4 : 3);
-	pointcloud_->fields[0].name = "x";
-	pointcloud_->fields[0].offset = 0;
-	pointcloud_->fields[0].datatype = sensor_msgs::PointField::FLOAT32;
-	pointcloud_->fields[0].count = 1;
-	pointcloud_->fields[1].name = "y";
-	pointcloud_->fields[1].offset = 4;
-	pointcloud_->fields[1].datatype = sensor_msgs::PointField::FLOAT32;
-	pointcloud_->fields[1].count = 1;
-	pointcloud_->fields[2].name = "z";
-	pointcloud_->fields[2].offset = 8;
-	pointcloud_->fields[2].datatype = sensor_msgs::PointField::FLOAT32;
-	pointcloud_->fields[2].count = 1;
-	pointcloud_->point_step = 12;
-
-	if (include_laser_intensity_) {
-		pointcloud_->fields[3].name = "intensity";
-		pointcloud_->fields[3].offset = 12;
-		pointcloud_->fields[3].datatype = sensor_msgs::PointField::FLOAT32;
-		pointcloud_->fields[3].count = 1;
-		pointcloud_->point_step += 4;
-	}
-
+	pointcloud_->is_bigendian = false;
+	pointcloud_->point_step = pointcloud_layout_.getPointStep();
 	pointcloud_->row_step = 0;
-	pointcloud_->data.reserve(number_of_reserved_points * pointcloud_->point_step);
-	pointcloud_->is_dense = true;
+	pointcloud_->is_dense = !organized_layout_;
+	size_t number_of_reserved_bytes = (!isVoxelGridEnabled() || isRollingWindowEnabled()) ? number_of_reserved_points * pointcloud_->point_step : 0;
+	if (wire_buffer_enabled_) {
+		pointcloud_->data.clear(); // the points go directly into the serialized message
+		wire_buffer_.beginPointCloud(*pointcloud_, number_of_reserved_bytes);
+	} else {
+		pointcloud_->data.reserve(number_of_reserved_bytes);
+	}
 	incrementNumberOfPointCloudsCreated();
 }
 
-void LaserScanToROSPointcloud::addMeasureToPointCloud(const tf2::Vector3& point, float intensity) {
-	*pointcloud_data_position_++ = (float)point.getX();
-	*pointcloud_data_position_++ = (float)point.getY();
-	*pointcloud_data_position_++ = (float)point.getZ();
+void LaserScanToROSPointcloud::addMeasureToPointCloud(const tf2::Vector3& point, float intensity, size_t measurement_index, float range) {
+	if (level_of_detail_voxel_grid_fed_with_points_ != NULL) {
+		level_of_detail_voxel_grid_fed_with_points_->addPoint(point.getX(), point.getY(), point.getZ(), intensity);
+	}
+
+	if (pointcloud_data_position_ == NULL) { // voxel grid mode or only building levels of detail
+		if (pointcloud_data_enabled_ && isVoxelGridEnabled()) {
+			voxel_grid_.addPoint(point.getX(), point.getY(), point.getZ(), intensity);
+		}
+		return;
+	}
 
-	if (include_laser_intensity_) {
-		*pointcloud_data_position_++ = intensity;
+	if (organized_layout_) { // each beam has a fixed column in its row (the row is prefilled with invalid points)
+		if (measurement_index >= pointcloud_->width || isProjectingAdditionalEcho()) { return; } // LaserScan with more beams than the cloud width or echo without a column
+		pointcloud_data_position_ = laser_scan_data_start_ + measurement_index * pointcloud_->point_step;
 	}
+
+	if (!pointcloud_layout_.writePoint(pointcloud_data_position_, (float)point.getX(), (float)point.getY(), (float)point.getZ(), intensity)) { // outside the range of quantized coordinates
+		if (!organized_layout_) { return; }
+		pointcloud_layout_.writeInvalidPoint(pointcloud_data_position_);
+	} else if (pointcloud_layout_.hasExtraFields()) {
+		if (isIntegratingPointCloud()) { point_extra_fields_.laser_scan_time_offset = laser_scan_time_offset_ + getCurrentPointTimeOffset(); } // PointCloud2 points have their own time (and no time increment)
+		point_extra_fields_.beam_index = (uint32_t)measurement_index;
+		point_extra_fields_.range = range;
+		point_extra_fields_.echo = (uint8_t)getCurrentEchoIndex();
+		pointcloud_layout_.writeExtraFields(pointcloud_data_position_, point_extra_fields_);
+	}
+	pointcloud_data_position_ += pointcloud_layout_.getPointStep();
 }
 
-void LaserScanToROSPointcloud::setupPointCloudForNewLaserScan(size_t number_laser_scan_points) {
-	pointcloud_->data.resize((getNumberOfPointsInCloud() + number_laser_scan_points) * pointcloud_->point_step); // resize to fit all points in the LaserScan
-	pointcloud_data_position_ = (float*)(&pointcloud_->data[getNumberOfPointsInCloud() * pointcloud_->point_step]);
+void LaserScanToROSPointcloud::setupPointCloudForNewLaserScan(size_t number_laser_scan_points, size_t number_of_additional_echoes) {
+	if (getNumberOfScansAssembledInCurrentPointcloud() == 0) { pointcloud_start_time_ = getCurrentLaserScanStartTime(); }
+	if (pointcloud_layout_.hasExtraFields()) {
+		laser_scan_time_offset_ = (getCurrentLaserScanStartTime() - pointcloud_start_time_).toSec();
+		point_extra_fields_.laser_scan_time_offset = laser_scan_time_offset_;
+		point_extra_fields_.time_increment = getCurrentLaserScanTimeIncrement();
+		point_extra_fields_.ring = (uint16_t)getLaserId();
+		point_extra_fields_.echo = 0;
+	}
+
+	if (isRollingWindowEnabled()) { // points are projected into the ring (the current cloud may have been published already)
+		size_t point_step = pointcloud_layout_.getPointStep();
+		if (pointcloud_segment_ring_.getPointStep() != point_step) { pointcloud_segment_ring_.clear(point_step); }
+		laser_scan_data_start_ = pointcloud_segment_ring_.beginSegment(number_laser_scan_points + number_of_additional_echoes);
+		pointcloud_data_position_ = laser_scan_data_start_;
+		return;
+	}
+
+	if (isVoxelGridEnabled() || !pointcloud_data_enabled_) {
+		pointcloud_data_position_ = NULL; // points are merged in the voxel grid and only written in finishPointCloud (or only go to the levels of detail)
+		return;
+	}
+
+	if (organized_layout_) { // each LaserScan fills one row at a fixed offset, with one column per beam (only with the selected echo of each beam)
+		size_t number_of_beams = getCurrentLaserScanNumberOfBeams(); // the columns do not depend on the beam decimation and angular subsampling (that may change between scans)
+		if (pointcloud_->height == 0) {
+			pointcloud_->width = number_of_beams;
+			pointcloud_->row_step = pointcloud_->width * pointcloud_->point_step;
+		} else if (number_of_beams != pointcloud_->width) {
+			ROS_WARN_STREAM_THROTTLE(5.0, "Organized point cloud with " << pointcloud_->width << " columns is receiving a LaserScan with " << number_of_beams << " beams (the row will be truncated or padded)");
+		}
+
+		laser_scan_data_start_ = growPointCloudData((pointcloud_->height + 1) * pointcloud_->row_step) + pointcloud_->height * pointcloud_->row_step;
+		for (uint8_t* point_data = laser_scan_data_start_; point_data < laser_scan_data_start_ + pointcloud_->row_step; point_data += pointcloud_->point_step) {
+			pointcloud_layout_.writeInvalidPoint(point_data);
+		}
+		pointcloud_data_position_ = laser_scan_data_start_;
+		return;
+	}
+
+	// the data buffer is only grown (never shrunk between scans) to avoid initializing the same bytes again for every scan
+	// (the cloud width is used instead of the number of points in the cloud because quantized layouts may discard points)
+	laser_scan_data_start_ = growPointCloudData((pointcloud_->width + number_laser_scan_points + number_of_additional_echoes) * pointcloud_->point_step) + pointcloud_->width * pointcloud_->point_step;
+	pointcloud_data_position_ = laser_scan_data_start_;
 }
 
 void LaserScanToROSPointcloud::finishLaserScanIntegration() {
-	pointcloud_->width = getNumberOfPointsInCloud();
+	last_laser_scan_data_ = NULL;
+	last_laser_scan_number_of_points_ = 0;
+	if ((isVoxelGridEnabled() || !pointcloud_data_enabled_) && !isRollingWindowEnabled()) { return; }
+
+	if (isRollingWindowEnabled()) {
+		const ros::Time& laser_scan_start_time = getCurrentLaserScanStartTime();
+		last_laser_scan_data_ = laser_scan_data_start_;
+		last_laser_scan_number_of_points_ = (pointcloud_data_position_ - laser_scan_data_start_) / pointcloud_segment_ring_.getPointStep();
+		pointcloud_segment_ring_.commitSegment(laser_scan_start_time, last_laser_scan_number_of_points_);
+		if (laser_scan_start_time.toSec() > rolling_window_duration_.toSec()) {
+			pointcloud_segment_ring_.evictSegmentsOlderThan(laser_scan_start_time - rolling_window_duration_);
+		}
+		return;
+	}
+
+	if (organized_layout_) {
+		++pointcloud_->height;
+		last_laser_scan_data_ = laser_scan_data_start_;
+		last_laser_scan_number_of_points_ = pointcloud_->width;
+		return;
+	}
+
+	last_laser_scan_data_ = laser_scan_data_start_;
+	last_laser_scan_number_of_points_ = (pointcloud_data_position_ - laser_scan_data_start_) / pointcloud_->point_step;
+	pointcloud_->width += last_laser_scan_number_of_points_;
 	pointcloud_->row_step = pointcloud_->width * pointcloud_->point_step;
-	pointcloud_->data.resize(pointcloud_->height * pointcloud_->row_step); // resize to shrink the vector size to the real number of points inserted
+}
+
+void LaserScanToROSPointcloud::finishPointCloud() {
+	if (isRollingWindowEnabled()) {
+		pointcloud_->width = pointcloud_segment_ring_.getNumberOfPoints();
+		pointcloud_->row_step = pointcloud_->width * pointcloud_->point_step;
+		uint8_t* data = growPointCloudData(pointcloud_->row_step);
+		if (pointcloud_->row_step > 0) { pointcloud_segment_ring_.copyPoints(data); }
+	} else if (isVoxelGridEnabled() && pointcloud_data_enabled_) {
+		pointcloud_->width = writeVoxelCentroids(voxel_grid_, growPointCloudData(voxel_grid_.getVoxels().size() * pointcloud_->point_step), pointcloud_layout_);
+		pointcloud_->row_step = pointcloud_->width * pointcloud_->point_step;
+	}
+
+	// coarser levels of detail are derived from the finer ones (each voxel merges a few voxels instead of all their points)
+	VoxelHashGrid* finer_voxel_grid = level_of_detail_voxel_grid_fed_with_points_;
+	for (size_t i = 0; finer_voxel_grid != NULL && i < levels_of_detail_.size(); ++i) {
+		if (levels_of_detail_[i].enabled_ && &levels_of_detail_[i].voxel_grid_ != level_of_detail_voxel_grid_fed_with_points_) {
+			const std::vector<VoxelHashGrid::Voxel>& finer_voxels = finer_voxel_grid->getVoxels();
+			for (size_t voxel_index = 0; voxel_index < finer_voxels.size(); ++voxel_index) {
+				levels_of_detail_[i].voxel_grid_.addVoxel(finer_voxels[voxel_index]);
+			}
+			finer_voxel_grid = &levels_of_detail_[i].voxel_grid_;
+		}
+	}
+
+	if (wire_buffer_enabled_) {
+		wire_buffer_.finishPointCloud(*pointcloud_, pointcloud_->height * pointcloud_->row_step);
+	} else {
+		pointcloud_->data.resize(pointcloud_->height * pointcloud_->row_step); // shrink the vector size to the real number of points inserted (keeps capacity)
+	}
+}
+
+
+void LaserScanToROSPointcloud::writeVoxelCentroidsToPointCloud(const VoxelHashGrid& voxel_grid, sensor_msgs::PointCloud2& pointcloud, const PointCloudLayout& layout) {
+	size_t number_of_voxels = voxel_grid.getVoxels().size();
+	PointCloudMessagePool::growPointCloudData(pointcloud, number_of_voxels * pointcloud.point_step);
+	pointcloud.width = number_of_voxels > 0 ? writeVoxelCentroids(voxel_grid, &pointcloud.data[0], layout) : 0;
+	pointcloud.row_step = pointcloud.width * pointcloud.point_step;
+}
+
+
+size_t LaserScanToROSPointcloud::writeVoxelCentroids(const VoxelHashGrid& voxel_grid, uint8_t* data, const PointCloudLayout& layout) {
+	const std::vector<VoxelHashGrid::Voxel>& voxels = voxel_grid.getVoxels();
+	size_t point_step = layout.getPointStep();
+	size_t number_of_points_written = 0;
+	for (size_t i = 0; i < voxels.size(); ++i) {
+		const VoxelHashGrid::Voxel& voxel = voxels[i];
+		double inverse_number_of_points = 1.0 / (double)voxel.number_of_points;
+		uint8_t* point_data = data + number_of_points_written * point_step;
+		if (layout.writePoint(point_data,
+				(float)(voxel.sum_x * inverse_number_of_points),
+				(float)(voxel.sum_y * inverse_number_of_points),
+				(float)(voxel.sum_z * inverse_number_of_points),
+				(float)(voxel.sum_intensity * inverse_number_of_points))) {
+			layout.writeCount(point_data, voxel.number_of_points);
+			++number_of_points_written;
+		}
+	}
+	return number_of_points_written;
+}
+
+
+sensor_msgs::PointCloud2Ptr LaserScanToROSPointcloud::buildLevelOfDetailPointCloud(size_t level_of_detail) {
+	PointCloudLevelOfDetail& level = levels_of_detail_[level_of_detail];
+	if (!level.enabled_) { return sensor_msgs::PointCloud2Ptr(); }
+
+	sensor_msgs::PointCloud2Ptr pointcloud = level.pointcloud_pool_.acquirePointCloud();
+	if (!level_of_detail_layout_.matchesFields(pointcloud->fields)) {
+		pointcloud->fields = level_of_detail_layout_.getFields();
+	}
+
+	pointcloud->header = pointcloud_->header;
+	pointcloud->height = 1;
+	pointcloud->is_bigendian = false;
+	pointcloud->point_step = level_of_detail_layout_.getPointStep();
+	pointcloud->is_dense = true;
+	writeVoxelCentroidsToPointCloud(level.voxel_grid_, *pointcloud, level_of_detail_layout_);
+	pointcloud->data.resize(pointcloud->row_step);
+	return pointcloud;
+}
+
+
+void LaserScanToROSPointcloud::updatePointCloudLayout() {
+	bool include_voxel_number_of_points = isVoxelGridEnabled() && !isRollingWindowEnabled();
+	int extra_fields = include_voxel_number_of_points ? 0 : extra_fields_; // voxel centroids have no time, beam, ring or range
+	if (isRollingWindowEnabled()) { extra_fields &= ~(PointCloudLayout::EXTRA_FIELD_TIME | PointCloudLayout::EXTRA_FIELD_TIME_MICROSECONDS); }
+	pointcloud_layout_.updateFields(include_laser_intensity_, include_voxel_number_of_points, extra_fields);
+	level_of_detail_layout_.updateFields(include_laser_intensity_, true);
+	organized_layout_ = organized_pointcloud_ && !isVoxelGridEnabled() && !isRollingWindowEnabled();
 }
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </LaserScanToROSPointcloud-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -93,7 +278,58 @@ void LaserScanToROSPointcloud::finishLaserScanIntegration() {
 void LaserScanToROSPointcloud::setIncludeLaserIntensity(bool include_laser_intensity) {
 	if (include_laser_intensity != include_laser_intensity_) {
 		include_laser_intensity_ = include_laser_intensity;
-		initNewPointCloud();
+		updatePointCloudLayout();
+	}
+}
+
+
+void LaserScanToROSPointcloud::setRollingWindowDuration(double rolling_window_duration) {
+	rolling_window_duration_.fromSec(std::max(rolling_window_duration, 0.0));
+	pointcloud_segment_ring_.clear(pointcloud_segment_ring_.getPointStep());
+	updatePointCloudLayout();
+}
+
+
+void LaserScanToROSPointcloud::setVoxelSize(double voxel_size) {
+	voxel_grid_.setVoxelSize(std::max(voxel_size, 0.0));
+	updatePointCloudLayout();
+}
+
+
+void LaserScanToROSPointcloud::setOrganizedPointCloud(bool organized_pointcloud) {
+	organized_pointcloud_ = organized_pointcloud;
+	updatePointCloudLayout();
+}
+
+
+void LaserScanToROSPointcloud::setPositionEncoding(PointCloudLayout::PositionEncoding position_encoding, double position_resolution, const tf2::Vector3& position_offset) {
+	pointcloud_layout_.setPositionEncoding(position_encoding, position_resolution, position_offset);
+	level_of_detail_layout_.setPositionEncoding(position_encoding, position_resolution, position_offset);
+	pointcloud_segment_ring_.clear(pointcloud_segment_ring_.getPointStep()); // the segments already in the window have the previous layout
+	updatePointCloudLayout();
+}
+
+
+void LaserScanToROSPointcloud::setIntensityEncoding(PointCloudLayout::IntensityEncoding intensity_encoding, double intensity_scale) {
+	pointcloud_layout_.setIntensityEncoding(intensity_encoding, intensity_scale);
+	level_of_detail_layout_.setIntensityEncoding(intensity_encoding, intensity_scale);
+	pointcloud_segment_ring_.clear(pointcloud_segment_ring_.getPointStep());
+	updatePointCloudLayout();
+}
+
+
+void LaserScanToROSPointcloud::setExtraFields(int extra_fields) {
+	extra_fields_ = extra_fields;
+	pointcloud_segment_ring_.clear(pointcloud_segment_ring_.getPointStep());
+	updatePointCloudLayout();
+}
+
+
+void LaserScanToROSPointcloud::setLevelsOfDetail(const std::vector<double>& voxel_sizes) {
+	level_of_detail_voxel_grid_fed_with_points_ = NULL;
+	levels_of_detail_.clear();
+	for (size_t i = 0; i < voxel_sizes.size(); ++i) {
+		levels_of_detail_.push_back(PointCloudLevelOfDetail(voxel_sizes[i]));
 	}
 }
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </sets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -105,6 +341,12 @@ void LaserScanToROSPointcloud::setIncludeLaserIntensity(bool include_laser_inten
 // =============================================================================   </protected-section>  =======================================================================
 
 // =============================================================================   <private-section>   =========================================================================
+uint8_t* LaserScanToROSPointcloud::growPointCloudData(size_t number_of_bytes) {
+	if (wire_buffer_enabled_) { return wire_buffer_.growData(number_of_bytes); }
+
+	PointCloudMessagePool::growPointCloudData(*pointcloud_, number_of_bytes);
+	return pointcloud_->data.empty() ? NULL : &pointcloud_->data[0];
+}
 // =============================================================================   </private-section>  =========================================================================
 
 } /* namespace laserscan_to_pointcloud */
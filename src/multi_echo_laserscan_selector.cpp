@@ -0,0 +1,107 @@
+/**\file multi_echo_laserscan_selector.cpp
+ * \brief Implementation of the selection of the echoes of a MultiEchoLaserScan.
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+#include <laserscan_to_pointcloud/multi_echo_laserscan_selector.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+namespace laserscan_to_pointcloud {
+// =============================================================================  <public-section>   ===========================================================================
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+MultiEchoLaserScanSelector::MultiEchoLaserScanSelector() :
+		echo_policy_(ECHO_POLICY_ALL),
+		number_of_additional_echoes_(0),
+		range_min_(0.0f),
+		range_max_(std::numeric_limits<float>::max()) {}
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <MultiEchoLaserScanSelector-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+sensor_msgs::LaserScanConstPtr MultiEchoLaserScanSelector::selectEchoes(const sensor_msgs::MultiEchoLaserScan& multi_echo_laser_scan) {
+	if (!selected_laser_scan_ || !selected_laser_scan_.unique()) { // the previous scan may still be referenced outside the assembler
+		selected_laser_scan_.reset(new sensor_msgs::LaserScan());
+	}
+
+	sensor_msgs::LaserScan& laser_scan = *selected_laser_scan_;
+	laser_scan.header = multi_echo_laser_scan.header;
+	laser_scan.angle_min = multi_echo_laser_scan.angle_min;
+	laser_scan.angle_max = multi_echo_laser_scan.angle_max;
+	laser_scan.angle_increment = multi_echo_laser_scan.angle_increment;
+	laser_scan.time_increment = multi_echo_laser_scan.time_increment;
+	laser_scan.scan_time = multi_echo_laser_scan.scan_time;
+	laser_scan.range_min = multi_echo_laser_scan.range_min;
+	laser_scan.range_max = multi_echo_laser_scan.range_max;
+	range_min_ = multi_echo_laser_scan.range_min;
+	range_max_ = multi_echo_laser_scan.range_max;
+
+	size_t number_of_beams = multi_echo_laser_scan.ranges.size();
+	bool has_intensities = multi_echo_laser_scan.intensities.size() == number_of_beams;
+	laser_scan.ranges.resize(number_of_beams);
+	laser_scan.intensities.resize(has_intensities ? number_of_beams : 0);
+	selected_echo_indices_.resize(number_of_beams);
+	number_of_additional_echoes_ = 0;
+
+	for (size_t beam_index = 0; beam_index < number_of_beams; ++beam_index) {
+		const std::vector<float>& ranges = multi_echo_laser_scan.ranges[beam_index].echoes;
+		const std::vector<float>* intensities = has_intensities ? &multi_echo_laser_scan.intensities[beam_index].echoes : NULL;
+		size_t echo_index = selectEcho(ranges, intensities);
+		selected_echo_indices_[beam_index] = (uint8_t)std::min(echo_index, (size_t)255);
+		laser_scan.ranges[beam_index] = echo_index < ranges.size() ? ranges[echo_index] : std::numeric_limits<float>::quiet_NaN();
+		if (has_intensities) {
+			laser_scan.intensities[beam_index] = echo_index < intensities->size() ? (*intensities)[echo_index] : 0.0f;
+		}
+
+		if (echo_policy_ == ECHO_POLICY_ALL) {
+			for (size_t i = echo_index + 1; i < ranges.size() && i < 256; ++i) {
+				if (isEchoValid(ranges[i])) { ++number_of_additional_echoes_; }
+			}
+		}
+	}
+
+	return selected_laser_scan_;
+}
+
+
+bool MultiEchoLaserScanSelector::parseEchoPolicy(const std::string& name, EchoPolicy& echo_policy_out) {
+	if (name == "all") {
+		echo_policy_out = ECHO_POLICY_ALL;
+	} else if (name == "first") {
+		echo_policy_out = ECHO_POLICY_FIRST;
+	} else if (name == "last") {
+		echo_policy_out = ECHO_POLICY_LAST;
+	} else if (name == "strongest") {
+		echo_policy_out = ECHO_POLICY_STRONGEST;
+	} else {
+		return false;
+	}
+	return true;
+}
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </MultiEchoLaserScanSelector-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// =============================================================================  </public-section>   ==========================================================================
+
+// =============================================================================   <protected-section>   =======================================================================
+size_t MultiEchoLaserScanSelector::selectEcho(const std::vector<float>& ranges, const std::vector<float>* intensities) const {
+	size_t selected_echo_index = ranges.size();
+	for (size_t i = 0; i < ranges.size(); ++i) {
+		if (!isEchoValid(ranges[i])) { continue; }
+
+		if (selected_echo_index == ranges.size()) {
+			selected_echo_index = i;
+			if (echo_policy_ == ECHO_POLICY_ALL || echo_policy_ == ECHO_POLICY_FIRST) { break; }
+		} else if (echo_policy_ == ECHO_POLICY_LAST) {
+			selected_echo_index = i;
+		} else if (echo_policy_ == ECHO_POLICY_STRONGEST && intensities != NULL && i < intensities->size() && selected_echo_index < intensities->size()
+				&& (*intensities)[i] > (*intensities)[selected_echo_index]) {
+			selected_echo_index = i;
+		}
+	}
+
+	return selected_echo_index < ranges.size() ? selected_echo_index : 0; // beams without valid echoes keep their first echo (rejected by the projection)
+}
+// =============================================================================   </protected-section>  =======================================================================
+} /* namespace laserscan_to_pointcloud */
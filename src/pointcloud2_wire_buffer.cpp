@@ -0,0 +1,120 @@
+/**\file pointcloud2_wire_buffer.cpp
+ * \brief Implementation of the PointCloud2 messages built in their serialized format.
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+#include <laserscan_to_pointcloud/pointcloud2_wire_buffer.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+namespace laserscan_to_pointcloud {
+// =============================================================================  <public-section>   ===========================================================================
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+PointCloud2WireBuffer::PointCloud2WireBuffer(size_t max_number_of_pooled_buffers) :
+		max_number_of_pooled_buffers_(max_number_of_pooled_buffers),
+		number_of_unpooled_allocations_(0),
+		current_buffer_(NULL),
+		stamp_offset_(0),
+		height_offset_(0),
+		row_step_offset_(0),
+		data_length_offset_(0),
+		data_offset_(0),
+		data_size_(0) {
+	pooled_buffers_.reserve(max_number_of_pooled_buffers); // pointers to the pooled buffers must remain valid
+	unpooled_buffer_.capacity_ = 0;
+}
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <PointCloud2WireBuffer-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+void PointCloud2WireBuffer::beginPointCloud(const sensor_msgs::PointCloud2& pointcloud, size_t number_of_reserved_data_bytes) {
+	// layout of the serialized message: [message length] header height width fields is_bigendian point_step row_step [data length] data is_dense
+	stamp_offset_ = 4 + 4;
+	height_offset_ = 4 + ros::serialization::serializationLength(pointcloud.header);
+	size_t is_bigendian_offset = height_offset_ + 8 + ros::serialization::serializationLength(pointcloud.fields);
+	row_step_offset_ = is_bigendian_offset + 1 + 4;
+	data_length_offset_ = row_step_offset_ + 4;
+	data_offset_ = data_length_offset_ + 4;
+	data_size_ = 0;
+
+	message_.buffer_.reset(); // otherwise the previous message would never be seen as released
+	current_buffer_ = acquireBuffer(data_offset_ + number_of_reserved_data_bytes + 1);
+	message_.buffer_ = current_buffer_->buffer_;
+
+	ros::serialization::OStream stream(message_.buffer_.get() + 4, data_offset_ - 4);
+	stream.next(pointcloud.header);
+	stream.next(pointcloud.height);
+	stream.next(pointcloud.width);
+	stream.next(pointcloud.fields);
+	stream.next(pointcloud.is_bigendian);
+	stream.next(pointcloud.point_step);
+	stream.next(pointcloud.row_step);
+	stream.next((uint32_t)0);
+}
+
+
+uint8_t* PointCloud2WireBuffer::growData(size_t number_of_bytes) {
+	size_t required_capacity = data_offset_ + number_of_bytes + 1;
+	if (current_buffer_->capacity_ < required_capacity) { // the buffer was not published yet, so it can be replaced
+		size_t new_capacity = std::max(required_capacity, current_buffer_->capacity_ * 2);
+		boost::shared_array<uint8_t> new_buffer(new uint8_t[new_capacity]);
+		memcpy(new_buffer.get(), current_buffer_->buffer_.get(), data_offset_ + data_size_);
+		message_.buffer_ = new_buffer;
+		current_buffer_->buffer_ = new_buffer;
+		current_buffer_->capacity_ = new_capacity;
+	}
+
+	data_size_ = std::max(data_size_, number_of_bytes);
+	return message_.buffer_.get() + data_offset_;
+}
+
+
+void PointCloud2WireBuffer::finishPointCloud(const sensor_msgs::PointCloud2& pointcloud, size_t data_size) {
+	growData(data_size);
+	patchValue(stamp_offset_, pointcloud.header.stamp);
+	patchValue(height_offset_, pointcloud.height);
+	patchValue(height_offset_ + 4, pointcloud.width);
+	patchValue(row_step_offset_, pointcloud.row_step);
+	patchValue(data_length_offset_, (uint32_t)data_size);
+	patchValue(data_offset_ + data_size, pointcloud.is_dense);
+
+	message_.serialized_length_ = (uint32_t)(data_offset_ + data_size + 1 - 4);
+	message_.data_offset_ = (uint32_t)data_offset_;
+	patchValue(0, message_.serialized_length_);
+}
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </PointCloud2WireBuffer-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// =============================================================================  </public-section>   ==========================================================================
+
+// =============================================================================   <protected-section>   =======================================================================
+PointCloud2WireBuffer::PooledBuffer* PointCloud2WireBuffer::acquireBuffer(size_t capacity) {
+	PooledBuffer* pooled_buffer = NULL;
+	for (size_t i = 0; i < pooled_buffers_.size(); ++i) {
+		if (pooled_buffers_[i].buffer_.unique()) { // roscpp no longer holds the buffer in any publisher queue
+			pooled_buffer = &pooled_buffers_[i];
+			break;
+		}
+	}
+
+	if (pooled_buffer == NULL) {
+		if (pooled_buffers_.size() < max_number_of_pooled_buffers_) {
+			pooled_buffers_.push_back(PooledBuffer());
+			pooled_buffer = &pooled_buffers_.back();
+		} else {
+			++number_of_unpooled_allocations_;
+			ROS_DEBUG_STREAM("All " << pooled_buffers_.size() << " pooled serialization buffers are still in use (allocated " << number_of_unpooled_allocations_ << " buffers outside the pool so far)");
+			pooled_buffer = &unpooled_buffer_;
+		}
+		pooled_buffer->capacity_ = 0;
+	}
+
+	if (pooled_buffer->capacity_ < capacity || !pooled_buffer->buffer_.unique()) {
+		pooled_buffer->buffer_.reset(new uint8_t[capacity]);
+		pooled_buffer->capacity_ = capacity;
+	}
+	return pooled_buffer;
+}
+// =============================================================================   </protected-section>  =======================================================================
+} /* namespace laserscan_to_pointcloud */
@@ -0,0 +1,271 @@
+/**\file pointcloud_compression.cpp
+ * \brief Implementation of the compression of PointCloud2 coordinates and intensities.
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+#include <laserscan_to_pointcloud/pointcloud_compression.h>
+#include <zlib.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+namespace laserscan_to_pointcloud {
+namespace {
+const size_t MAX_VARINT_SIZE = 10;
+const int16_t INVALID_INT16_COORDINATE = -32768;
+
+inline uint8_t* writeVarint(uint8_t* position, uint64_t value) {
+	while (value >= 0x80) {
+		*position++ = (uint8_t)(value | 0x80);
+		value >>= 7;
+	}
+	*position++ = (uint8_t)value;
+	return position;
+}
+
+inline uint8_t* writeZigZagVarint(uint8_t* position, int64_t value) {
+	return writeVarint(position, ((uint64_t)value << 1) ^ (uint64_t)(value >> 63));
+}
+
+inline bool readVarint(const uint8_t*& position, const uint8_t* end, uint64_t& value) {
+	value = 0;
+	for (unsigned shift = 0; position < end && shift < 64; shift += 7) {
+		uint8_t byte = *position++;
+		value |= (uint64_t)(byte & 0x7f) << shift;
+		if ((byte & 0x80) == 0) { return true; }
+	}
+	return false;
+}
+
+inline bool readZigZagVarint(const uint8_t*& position, const uint8_t* end, int64_t& value) {
+	uint64_t zigzag;
+	if (!readVarint(position, end, zigzag)) { return false; }
+	value = (int64_t)(zigzag >> 1) ^ -(int64_t)(zigzag & 1);
+	return true;
+}
+
+template <typename T>
+inline T readValue(const uint8_t* position) {
+	T value;
+	memcpy(&value, position, sizeof(T));
+	return value;
+}
+
+const sensor_msgs::PointField* findField(const sensor_msgs::PointCloud2& pointcloud, const std::string& name) {
+	for (size_t i = 0; i < pointcloud.fields.size(); ++i) {
+		if (pointcloud.fields[i].name == name) { return &pointcloud.fields[i]; }
+	}
+	return NULL;
+}
+}
+
+
+// ##########################################################################   PointCloudCompressor   ########################################################################
+// =============================================================================  <public-section>   ===========================================================================
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+PointCloudCompressor::PointCloudCompressor() :
+		position_resolution_(0.001),
+		intensity_resolution_(0.01),
+		compression_level_(1),
+		input_position_resolution_(0.001),
+		input_position_offset_(0, 0, 0),
+		input_intensity_scale_(1.0) {}
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <PointCloudCompressor-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+bool PointCloudCompressor::compress(const sensor_msgs::PointCloud2& pointcloud, const uint8_t* data, CompressedPointCloud& compressed_pointcloud) {
+	const sensor_msgs::PointField* position_fields[3] = { findField(pointcloud, "x"), findField(pointcloud, "y"), findField(pointcloud, "z") };
+	const sensor_msgs::PointField* intensity_field = findField(pointcloud, "intensity");
+	if (position_fields[0] == NULL || position_fields[1] == NULL || position_fields[2] == NULL) { return false; }
+
+	uint8_t position_datatype = position_fields[0]->datatype;
+	if ((position_datatype != sensor_msgs::PointField::FLOAT32 && position_datatype != sensor_msgs::PointField::INT16)
+			|| position_fields[1]->datatype != position_datatype || position_fields[2]->datatype != position_datatype) { return false; }
+	if (intensity_field != NULL && intensity_field->datatype != sensor_msgs::PointField::FLOAT32
+			&& intensity_field->datatype != sensor_msgs::PointField::UINT16 && intensity_field->datatype != sensor_msgs::PointField::UINT8) { intensity_field = NULL; }
+
+	size_t number_of_points = (size_t)pointcloud.height * (size_t)pointcloud.width;
+	if (number_of_points > 0 && data == NULL) { return false; }
+
+	// int16 coordinates and integer intensities are already quantized (their steps are kept and only the offset is rounded to a whole number of steps)
+	bool int16_positions = (position_datatype == sensor_msgs::PointField::INT16);
+	double position_resolution = int16_positions ? input_position_resolution_ : position_resolution_;
+	int64_t position_offset_steps[3] = { 0, 0, 0 };
+	if (int16_positions) {
+		for (int axis = 0; axis < 3; ++axis) { position_offset_steps[axis] = (int64_t)std::floor(input_position_offset_[axis] / position_resolution + 0.5); }
+	}
+	bool float_intensities = (intensity_field != NULL && intensity_field->datatype == sensor_msgs::PointField::FLOAT32);
+	double intensity_resolution = float_intensities ? intensity_resolution_ : 1.0 / input_intensity_scale_;
+	double inverse_position_resolution = 1.0 / position_resolution;
+	double inverse_intensity_resolution = 1.0 / intensity_resolution;
+	size_t point_step = pointcloud.point_step;
+
+	// runs of valid and invalid points (only written when there are invalid points)
+	varint_stream_.resize(number_of_points * MAX_VARINT_SIZE * 5 + MAX_VARINT_SIZE);
+	uint8_t* stream_position = &varint_stream_[0];
+	size_t number_of_valid_points = 0;
+	size_t run_length = 0;
+	bool run_valid = true;
+	for (size_t i = 0; i < number_of_points; ++i) {
+		const uint8_t* point = data + i * point_step;
+		bool valid = int16_positions ?
+				readValue<int16_t>(point + position_fields[0]->offset) != INVALID_INT16_COORDINATE :
+				(std::isfinite(readValue<float>(point + position_fields[0]->offset)) && std::isfinite(readValue<float>(point + position_fields[1]->offset)) && std::isfinite(readValue<float>(point + position_fields[2]->offset)));
+		if (valid) { ++number_of_valid_points; }
+		if (valid != run_valid) {
+			stream_position = writeVarint(stream_position, run_length);
+			run_valid = valid;
+			run_length = 0;
+		}
+		++run_length;
+	}
+	if (number_of_valid_points == number_of_points) {
+		stream_position = &varint_stream_[0];
+	} else {
+		stream_position = writeVarint(stream_position, run_length);
+	}
+
+	int64_t previous_values[4] = { 0, 0, 0, 0 };
+	for (size_t i = 0; i < number_of_points; ++i) {
+		const uint8_t* point = data + i * point_step;
+		int64_t values[4];
+		if (int16_positions) {
+			if (readValue<int16_t>(point + position_fields[0]->offset) == INVALID_INT16_COORDINATE) { continue; }
+			for (int axis = 0; axis < 3; ++axis) { values[axis] = (int64_t)readValue<int16_t>(point + position_fields[axis]->offset) + position_offset_steps[axis]; }
+		} else {
+			float coordinates[3] = { readValue<float>(point + position_fields[0]->offset), readValue<float>(point + position_fields[1]->offset), readValue<float>(point + position_fields[2]->offset) };
+			if (!std::isfinite(coordinates[0]) || !std::isfinite(coordinates[1]) || !std::isfinite(coordinates[2])) { continue; }
+			for (int axis = 0; axis < 3; ++axis) { values[axis] = (int64_t)std::floor(coordinates[axis] * inverse_position_resolution + 0.5); }
+		}
+
+		int number_of_values = 3;
+		if (intensity_field != NULL) {
+			const uint8_t* intensity = point + intensity_field->offset;
+			if (float_intensities) {
+				float intensity_value = readValue<float>(intensity);
+				values[3] = std::isfinite(intensity_value) ? (int64_t)std::floor(intensity_value * inverse_intensity_resolution + 0.5) : 0;
+			} else {
+				values[3] = (intensity_field->datatype == sensor_msgs::PointField::UINT16) ? (int64_t)readValue<uint16_t>(intensity) : (int64_t)*intensity;
+			}
+			number_of_values = 4;
+		}
+
+		for (int value_index = 0; value_index < number_of_values; ++value_index) {
+			stream_position = writeZigZagVarint(stream_position, values[value_index] - previous_values[value_index]);
+			previous_values[value_index] = values[value_index];
+		}
+	}
+
+	size_t stream_size = stream_position - &varint_stream_[0];
+	compressed_pointcloud.header = pointcloud.header;
+	compressed_pointcloud.height = pointcloud.height;
+	compressed_pointcloud.width = pointcloud.width;
+	compressed_pointcloud.has_intensity = (intensity_field != NULL);
+	compressed_pointcloud.position_resolution = position_resolution;
+	compressed_pointcloud.intensity_resolution = intensity_resolution;
+	compressed_pointcloud.number_of_valid_points = (uint32_t)number_of_valid_points;
+	compressed_pointcloud.uncompressed_size = (uint32_t)stream_size;
+
+	if (compression_level_ > 0) {
+		uLongf compressed_size = compressBound((uLong)stream_size);
+		compressed_pointcloud.data.resize(compressed_size);
+		if (compress2(&compressed_pointcloud.data[0], &compressed_size, &varint_stream_[0], (uLong)stream_size, std::min(compression_level_, 9)) == Z_OK) {
+			compressed_pointcloud.compression = "zlib";
+			compressed_pointcloud.data.resize(compressed_size);
+			return true;
+		}
+	}
+
+	compressed_pointcloud.compression = "none";
+	compressed_pointcloud.data.assign(varint_stream_.begin(), varint_stream_.begin() + stream_size);
+	return true;
+}
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </PointCloudCompressor-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// =============================================================================  </public-section>   ==========================================================================
+
+
+
+// #########################################################################   PointCloudDecompressor   #######################################################################
+// =============================================================================  <public-section>   ===========================================================================
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <PointCloudDecompressor-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+bool PointCloudDecompressor::decompress(const CompressedPointCloud& compressed_pointcloud, sensor_msgs::PointCloud2& pointcloud) {
+	const uint8_t* stream_position = NULL;
+	const uint8_t* stream_end = NULL;
+	if (compressed_pointcloud.compression == "zlib") {
+		varint_stream_.resize(compressed_pointcloud.uncompressed_size + 1);
+		uLongf stream_size = compressed_pointcloud.uncompressed_size;
+		if (compressed_pointcloud.data.empty() || uncompress(&varint_stream_[0], &stream_size, &compressed_pointcloud.data[0], (uLong)compressed_pointcloud.data.size()) != Z_OK
+				|| stream_size != compressed_pointcloud.uncompressed_size) { return false; }
+		stream_position = &varint_stream_[0];
+		stream_end = stream_position + stream_size;
+	} else if (compressed_pointcloud.compression == "none") {
+		stream_position = compressed_pointcloud.data.empty() ? NULL : &compressed_pointcloud.data[0];
+		stream_end = stream_position + compressed_pointcloud.data.size();
+	} else {
+		return false;
+	}
+
+	size_t number_of_points = (size_t)compressed_pointcloud.height * (size_t)compressed_pointcloud.width;
+	std::vector<uint64_t> run_lengths;
+	if (compressed_pointcloud.number_of_valid_points != number_of_points) {
+		for (size_t points_in_runs = 0; points_in_runs < number_of_points;) {
+			uint64_t run_length;
+			if (!readVarint(stream_position, stream_end, run_length) || run_length > number_of_points - points_in_runs) { return false; }
+			run_lengths.push_back(run_length);
+			points_in_runs += run_length;
+		}
+	} else {
+		run_lengths.push_back(number_of_points);
+	}
+
+	pointcloud.header = compressed_pointcloud.header;
+	pointcloud.height = compressed_pointcloud.height;
+	pointcloud.width = compressed_pointcloud.width;
+	pointcloud.fields.clear();
+	const char* field_names[4] = { "x", "y", "z", "intensity" };
+	int number_of_values = compressed_pointcloud.has_intensity ? 4 : 3;
+	for (int i = 0; i < number_of_values; ++i) {
+		sensor_msgs::PointField field;
+		field.name = field_names[i];
+		field.offset = i * sizeof(float);
+		field.datatype = sensor_msgs::PointField::FLOAT32;
+		field.count = 1;
+		pointcloud.fields.push_back(field);
+	}
+	pointcloud.is_bigendian = false;
+	pointcloud.point_step = number_of_values * sizeof(float);
+	pointcloud.row_step = pointcloud.width * pointcloud.point_step;
+	pointcloud.is_dense = (compressed_pointcloud.number_of_valid_points == number_of_points);
+	pointcloud.data.resize(number_of_points * pointcloud.point_step);
+
+	double value_resolutions[4] = { compressed_pointcloud.position_resolution, compressed_pointcloud.position_resolution,
+			compressed_pointcloud.position_resolution, compressed_pointcloud.intensity_resolution };
+	int64_t values[4] = { 0, 0, 0, 0 };
+	float invalid_point[4] = { std::numeric_limits<float>::quiet_NaN(), std::numeric_limits<float>::quiet_NaN(), std::numeric_limits<float>::quiet_NaN(), 0.0f };
+	uint8_t* point = pointcloud.data.empty() ? NULL : &pointcloud.data[0];
+	bool run_valid = true;
+	for (size_t run = 0; run < run_lengths.size(); ++run, run_valid = !run_valid) {
+		for (uint64_t i = 0; i < run_lengths[run]; ++i, point += pointcloud.point_step) {
+			if (!run_valid) {
+				memcpy(point, invalid_point, pointcloud.point_step);
+				continue;
+			}
+
+			float point_values[4];
+			for (int value_index = 0; value_index < number_of_values; ++value_index) {
+				int64_t delta;
+				if (!readZigZagVarint(stream_position, stream_end, delta)) { return false; }
+				values[value_index] += delta;
+				point_values[value_index] = (float)(values[value_index] * value_resolutions[value_index]);
+			}
+			memcpy(point, point_values, pointcloud.point_step);
+		}
+	}
+	return true;
+}
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </PointCloudDecompressor-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// =============================================================================  </public-section>   ==========================================================================
+} /* namespace laserscan_to_pointcloud */
@@ -0,0 +1,62 @@
+/**\file pointcloud_decompressor_node.cpp
+ * \brief Republishes CompressedPointCloud messages as sensor_msgs/PointCloud2.
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+#include <ros/ros.h>
+#include <sensor_msgs/PointCloud2.h>
+#include <laserscan_to_pointcloud/CompressedPointCloud.h>
+#include <laserscan_to_pointcloud/pointcloud_compression.h>
+#include <laserscan_to_pointcloud/pointcloud_message_pool.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+namespace laserscan_to_pointcloud {
+// #######################################################################   PointCloudDecompressorNode   ######################################################################
+class PointCloudDecompressorNode {
+	public:
+		PointCloudDecompressorNode(ros::NodeHandle& node_handle, ros::NodeHandle& private_node_handle) : number_of_corrupted_pointclouds_(0) {
+			std::string compressed_pointcloud_topic, pointcloud_publish_topic;
+			private_node_handle.param("compressed_pointcloud_topic", compressed_pointcloud_topic, std::string("ambient_pointcloud_compressed"));
+			private_node_handle.param("pointcloud_publish_topic", pointcloud_publish_topic, std::string("ambient_pointcloud_decompressed"));
+			pointcloud_publisher_ = node_handle.advertise<sensor_msgs::PointCloud2>(pointcloud_publish_topic, 10);
+			compressed_pointcloud_subscriber_ = node_handle.subscribe(compressed_pointcloud_topic, 10, &laserscan_to_pointcloud::PointCloudDecompressorNode::processCompressedPointCloud, this);
+			ROS_INFO_STREAM("Decompressing the clouds of " << compressed_pointcloud_topic << " into topic " << pointcloud_publish_topic);
+		}
+
+		void processCompressedPointCloud(const CompressedPointCloudConstPtr& compressed_pointcloud) {
+			sensor_msgs::PointCloud2Ptr pointcloud = pointcloud_pool_.acquirePointCloud(); // recycled clouds keep the capacity of their data
+			if (!pointcloud_decompressor_.decompress(*compressed_pointcloud, *pointcloud)) {
+				ROS_WARN_STREAM_THROTTLE(5.0, "Failed to decompress cloud with " << compressed_pointcloud->compression << " compression (" << ++number_of_corrupted_pointclouds_ << " failures so far)");
+				return;
+			}
+			pointcloud_publisher_.publish(sensor_msgs::PointCloud2ConstPtr(pointcloud));
+		}
+
+	private:
+		PointCloudDecompressor pointcloud_decompressor_;
+		PointCloudMessagePool pointcloud_pool_;
+		size_t number_of_corrupted_pointclouds_;
+		ros::Subscriber compressed_pointcloud_subscriber_;
+		ros::Publisher pointcloud_publisher_;
+};
+} /* namespace laserscan_to_pointcloud */
+
+
+
+// ###################################################################################   <main>   ##############################################################################
+int main(int argc, char** argv) {
+	ros::init(argc, argv, "pointcloud_decompressor");
+
+	ros::NodeHandle node_handle;
+	ros::NodeHandle private_node_handle("~");
+	laserscan_to_pointcloud::PointCloudDecompressorNode pointcloud_decompressor(node_handle, private_node_handle);
+
+	ros::spin();
+
+	return 0;
+}
+// ###################################################################################   </main>   #############################################################################
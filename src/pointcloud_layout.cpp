@@ -0,0 +1,282 @@
+/**\file pointcloud_layout.cpp
+ * \brief Implementation of the fields and encodings of the published points.
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+#include <laserscan_to_pointcloud/pointcloud_layout.h>
+#include <Eigen/Core>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+namespace laserscan_to_pointcloud {
+template <>
+PointCloudLayout::ExtraFieldsWriter PointCloudLayout::selectExtraFieldsWriter<0>(int mask) { return NULL; }
+
+
+// =============================================================================  <public-section>   ===========================================================================
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+PointCloudLayout::PointCloudLayout() :
+		position_encoding_(POSITION_FLOAT32),
+		intensity_encoding_(INTENSITY_FLOAT32),
+		position_resolution_(0.001),
+		position_offset_(0, 0, 0),
+		intensity_scale_(1.0),
+		extra_fields_(0),
+		point_step_(0),
+		include_intensity_(false),
+		intensity_offset_(0),
+		count_offset_(0),
+		extra_fields_offset_(0),
+		extra_fields_size_(0),
+		time_offset_(0),
+		beam_offset_(0),
+		ring_offset_(0),
+		range_offset_(0),
+		echo_offset_(0),
+		inverse_position_resolution_(1000.0f),
+		position_offset_x_(0.0f), position_offset_y_(0.0f), position_offset_z_(0.0f),
+		intensity_scale_float_(1.0f),
+		point_writer_(NULL),
+		extra_fields_writer_(NULL) {
+	updateFields(false, false);
+}
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <PointCloudLayout-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+void PointCloudLayout::updateFields(bool include_intensity, bool include_count, int extra_fields) {
+	include_intensity_ = include_intensity;
+	fields_.clear();
+
+	uint8_t position_datatype = (position_encoding_ == POSITION_INT16) ? sensor_msgs::PointField::INT16 : sensor_msgs::PointField::FLOAT32;
+	uint32_t position_size = getDatatypeSize(position_datatype);
+	addField(fields_, "x", 0, position_datatype);
+	addField(fields_, "y", position_size, position_datatype);
+	addField(fields_, "z", 2 * position_size, position_datatype);
+	point_step_ = 3 * position_size;
+
+	if (include_intensity) {
+		uint8_t intensity_datatype = sensor_msgs::PointField::FLOAT32;
+		if (intensity_encoding_ == INTENSITY_UINT16) {
+			intensity_datatype = sensor_msgs::PointField::UINT16;
+		} else if (intensity_encoding_ == INTENSITY_UINT8) {
+			intensity_datatype = sensor_msgs::PointField::UINT8;
+		}
+		intensity_offset_ = point_step_;
+		addField(fields_, "intensity", intensity_offset_, intensity_datatype);
+		point_step_ += getDatatypeSize(intensity_datatype);
+	}
+
+	extra_fields_ = extra_fields & EXTRA_FIELDS_ALL;
+	if (extra_fields_ & EXTRA_FIELD_TIME) { extra_fields_ &= ~EXTRA_FIELD_TIME_MICROSECONDS; }
+	extra_fields_offset_ = point_step_;
+	if (extra_fields_ & EXTRA_FIELD_TIME) {
+		time_offset_ = point_step_;
+		addField(fields_, "time", time_offset_, sensor_msgs::PointField::FLOAT32);
+		point_step_ += 4;
+	} else if (extra_fields_ & EXTRA_FIELD_TIME_MICROSECONDS) {
+		time_offset_ = point_step_;
+		addField(fields_, "time_us", time_offset_, sensor_msgs::PointField::UINT32);
+		point_step_ += 4;
+	}
+	if (extra_fields_ & EXTRA_FIELD_BEAM) {
+		beam_offset_ = point_step_;
+		addField(fields_, "beam", beam_offset_, sensor_msgs::PointField::UINT32); // PointCloud2 inputs can have more than 65535 points
+		point_step_ += 4;
+	}
+	if (extra_fields_ & EXTRA_FIELD_RING) {
+		ring_offset_ = point_step_;
+		addField(fields_, "ring", ring_offset_, sensor_msgs::PointField::UINT16);
+		point_step_ += 2;
+	}
+	if (extra_fields_ & EXTRA_FIELD_RANGE) {
+		range_offset_ = point_step_;
+		addField(fields_, "range", range_offset_, sensor_msgs::PointField::FLOAT32);
+		point_step_ += 4;
+	}
+	if (extra_fields_ & EXTRA_FIELD_ECHO) {
+		echo_offset_ = point_step_;
+		addField(fields_, "echo", echo_offset_, sensor_msgs::PointField::UINT8);
+		point_step_ += 1;
+	}
+	extra_fields_size_ = point_step_ - extra_fields_offset_;
+
+	if (include_count) {
+		count_offset_ = point_step_;
+		addField(fields_, "count", count_offset_, sensor_msgs::PointField::UINT32);
+		point_step_ += 4;
+	}
+
+	inverse_position_resolution_ = (float)(1.0 / position_resolution_);
+	position_offset_x_ = (float)position_offset_.getX();
+	position_offset_y_ = (float)position_offset_.getY();
+	position_offset_z_ = (float)position_offset_.getZ();
+	intensity_scale_float_ = (float)intensity_scale_;
+	point_writer_ = (position_encoding_ == POSITION_INT16) ? selectPointWriter<POSITION_INT16>(intensity_encoding_) : selectPointWriter<POSITION_FLOAT32>(intensity_encoding_);
+	extra_fields_writer_ = selectExtraFieldsWriter<EXTRA_FIELDS_ALL>(extra_fields_);
+}
+
+
+bool PointCloudLayout::matchesFields(const std::vector<sensor_msgs::PointField>& fields) const {
+	if (fields.size() != fields_.size()) { return false; }
+	for (size_t i = 0; i < fields.size(); ++i) {
+		if (fields[i].name != fields_[i].name || fields[i].offset != fields_[i].offset || fields[i].datatype != fields_[i].datatype) { return false; }
+	}
+	return true;
+}
+
+
+void PointCloudLayout::writeInvalidPoint(uint8_t* point_data) const {
+	if (position_encoding_ == POSITION_INT16) {
+		const int16_t invalid_value = std::numeric_limits<int16_t>::min();
+		writeValue(point_data, invalid_value);
+		writeValue(point_data + 2, invalid_value);
+		writeValue(point_data + 4, invalid_value);
+	} else {
+		const float invalid_value = std::numeric_limits<float>::quiet_NaN();
+		writeValue(point_data, invalid_value);
+		writeValue(point_data + 4, invalid_value);
+		writeValue(point_data + 8, invalid_value);
+	}
+
+	if (include_intensity_) {
+		if (intensity_encoding_ == INTENSITY_FLOAT32) {
+			writeValue(point_data + intensity_offset_, std::numeric_limits<float>::quiet_NaN());
+		} else if (intensity_encoding_ == INTENSITY_UINT16) {
+			writeValue(point_data + intensity_offset_, (uint16_t)0);
+		} else {
+			point_data[intensity_offset_] = 0;
+		}
+	}
+
+	if (extra_fields_size_ > 0) {
+		memset(point_data + extra_fields_offset_, 0, extra_fields_size_);
+		if (extra_fields_ & EXTRA_FIELD_RANGE) { writeValue(point_data + range_offset_, std::numeric_limits<float>::quiet_NaN()); }
+	}
+}
+
+
+bool PointCloudLayout::parsePositionEncoding(const std::string& name, PositionEncoding& position_encoding_out) {
+	if (name == "float32") {
+		position_encoding_out = POSITION_FLOAT32;
+	} else if (name == "int16") {
+		position_encoding_out = POSITION_INT16;
+	} else {
+		return false;
+	}
+	return true;
+}
+
+
+bool PointCloudLayout::parseIntensityEncoding(const std::string& name, IntensityEncoding& intensity_encoding_out) {
+	if (name == "float32") {
+		intensity_encoding_out = INTENSITY_FLOAT32;
+	} else if (name == "uint16") {
+		intensity_encoding_out = INTENSITY_UINT16;
+	} else if (name == "uint8") {
+		intensity_encoding_out = INTENSITY_UINT8;
+	} else {
+		return false;
+	}
+	return true;
+}
+
+
+bool PointCloudLayout::parseExtraFields(const std::string& names, int& extra_fields_out) {
+	std::string names_separated_by_spaces = names;
+	std::replace(names_separated_by_spaces.begin(), names_separated_by_spaces.end(), '+', ' ');
+	std::stringstream ss(names_separated_by_spaces);
+
+	extra_fields_out = 0;
+	bool all_names_valid = true;
+	std::string name;
+	while (ss >> name) {
+		if (name == "time") {
+			extra_fields_out |= EXTRA_FIELD_TIME;
+		} else if (name == "time_us") {
+			extra_fields_out |= EXTRA_FIELD_TIME_MICROSECONDS;
+		} else if (name == "beam") {
+			extra_fields_out |= EXTRA_FIELD_BEAM;
+		} else if (name == "ring") {
+			extra_fields_out |= EXTRA_FIELD_RING;
+		} else if (name == "range") {
+			extra_fields_out |= EXTRA_FIELD_RANGE;
+		} else if (name == "echo") {
+			extra_fields_out |= EXTRA_FIELD_ECHO;
+		} else {
+			all_names_valid = false;
+		}
+	}
+	return all_names_valid;
+}
+
+
+void PointCloudLayout::transformFloat32Positions(uint8_t* points_data, size_t number_of_points, uint32_t point_step, const tf2::Transform& transform) {
+	if (number_of_points == 0) { return; }
+
+	Eigen::Matrix3f rotation;
+	for (int row = 0; row < 3; ++row) {
+		for (int column = 0; column < 3; ++column) {
+			rotation(row, column) = (float)transform.getBasis()[row][column];
+		}
+	}
+	Eigen::Vector3f translation((float)transform.getOrigin().x(), (float)transform.getOrigin().y(), (float)transform.getOrigin().z());
+
+	if (point_step % sizeof(float) == 0 && ((size_t)points_data) % sizeof(float) == 0) { // positions as the columns of a strided matrix (transformed in one vectorized product)
+		Eigen::Map<Eigen::Matrix3Xf, Eigen::Unaligned, Eigen::OuterStride<> > positions((float*)points_data, 3, number_of_points, Eigen::OuterStride<>(point_step / sizeof(float)));
+		positions = (rotation * positions).colwise() + translation;
+		return;
+	}
+
+	for (size_t i = 0; i < number_of_points; ++i) { // layouts with uint8 fields may leave the positions unaligned
+		uint8_t* point_data = points_data + i * point_step;
+		Eigen::Vector3f position;
+		memcpy(position.data(), point_data, 3 * sizeof(float));
+		position = rotation * position + translation;
+		memcpy(point_data, position.data(), 3 * sizeof(float));
+	}
+}
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </PointCloudLayout-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <sets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+void PointCloudLayout::setPositionEncoding(PositionEncoding position_encoding, double position_resolution, const tf2::Vector3& position_offset) {
+	position_encoding_ = position_encoding;
+	position_resolution_ = position_resolution > 0.0 ? position_resolution : 0.001;
+	position_offset_ = position_offset;
+}
+
+
+void PointCloudLayout::setIntensityEncoding(IntensityEncoding intensity_encoding, double intensity_scale) {
+	intensity_encoding_ = intensity_encoding;
+	intensity_scale_ = intensity_scale;
+}
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </sets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// =============================================================================  </public-section>   ==========================================================================
+
+// =============================================================================   <protected-section>   =======================================================================
+void PointCloudLayout::addField(std::vector<sensor_msgs::PointField>& fields, const std::string& name, uint32_t offset, uint8_t datatype) {
+	sensor_msgs::PointField field;
+	field.name = name;
+	field.offset = offset;
+	field.datatype = datatype;
+	field.count = 1;
+	fields.push_back(field);
+}
+
+
+uint32_t PointCloudLayout::getDatatypeSize(uint8_t datatype) {
+	switch (datatype) {
+		case sensor_msgs::PointField::INT8:
+		case sensor_msgs::PointField::UINT8: return 1;
+		case sensor_msgs::PointField::INT16:
+		case sensor_msgs::PointField::UINT16: return 2;
+		case sensor_msgs::PointField::FLOAT64: return 8;
+		default: return 4;
+	}
+}
+// =============================================================================   </protected-section>  =======================================================================
+} /* namespace laserscan_to_pointcloud */
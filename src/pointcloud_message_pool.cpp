@@ -0,0 +1,60 @@
+/**\file pointcloud_message_pool.cpp
+ * \brief Implementation of a pool of PointCloud2 messages.
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+#include <laserscan_to_pointcloud/pointcloud_message_pool.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+namespace laserscan_to_pointcloud {
+// =============================================================================  <public-section>   ===========================================================================
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+PointCloudMessagePool::PointCloudMessagePool(size_t max_number_of_pooled_pointclouds) :
+		max_number_of_pooled_pointclouds_(max_number_of_pooled_pointclouds),
+		next_pointcloud_to_check_(0),
+		number_of_unpooled_allocations_(0) {
+	pooled_pointclouds_.reserve(max_number_of_pooled_pointclouds);
+}
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <PointCloudMessagePool-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+sensor_msgs::PointCloud2Ptr PointCloudMessagePool::acquirePointCloud() {
+	// round robin search starting after the last returned message (the most recent ones are the most likely to still be in use)
+	for (size_t i = 0; i < pooled_pointclouds_.size(); ++i) {
+		size_t pointcloud_index = (next_pointcloud_to_check_ + i) % pooled_pointclouds_.size();
+		if (pooled_pointclouds_[pointcloud_index].unique()) { // only the pool holds the message -> no subscriber / publisher queue can see it
+			next_pointcloud_to_check_ = (pointcloud_index + 1) % pooled_pointclouds_.size();
+			return pooled_pointclouds_[pointcloud_index];
+		}
+	}
+
+	sensor_msgs::PointCloud2Ptr pointcloud(new sensor_msgs::PointCloud2());
+	if (pooled_pointclouds_.size() < max_number_of_pooled_pointclouds_) {
+		pooled_pointclouds_.push_back(pointcloud);
+		next_pointcloud_to_check_ = pooled_pointclouds_.size() % max_number_of_pooled_pointclouds_;
+	} else {
+		++number_of_unpooled_allocations_;
+		ROS_DEBUG_STREAM("All " << pooled_pointclouds_.size() << " pooled point clouds are still in use (allocated " << number_of_unpooled_allocations_ << " point clouds outside the pool so far)");
+	}
+
+	return pointcloud;
+}
+
+
+void PointCloudMessagePool::growPointCloudData(sensor_msgs::PointCloud2& pointcloud, size_t number_of_bytes) {
+	if (pointcloud.data.size() >= number_of_bytes) { return; }
+
+	if (pointcloud.data.capacity() < number_of_bytes) {
+		pointcloud.data.reserve(std::max(number_of_bytes, pointcloud.data.capacity() * 2));
+	}
+
+	pointcloud.data.resize(number_of_bytes);
+}
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </PointCloudMessagePool-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// =============================================================================  </public-section>   ==========================================================================
+} /* namespace laserscan_to_pointcloud */
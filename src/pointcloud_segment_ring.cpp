@@ -0,0 +1,126 @@
+/**\file pointcloud_segment_ring.cpp
+ * \brief Implementation of a ring buffer of point cloud segments.
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+#include <laserscan_to_pointcloud/pointcloud_segment_ring.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+namespace laserscan_to_pointcloud {
+// =============================================================================  <public-section>   ===========================================================================
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+PointCloudSegmentRing::PointCloudSegmentRing(size_t point_step) :
+		point_step_(point_step),
+		number_of_points_(0),
+		pending_segment_offset_(0) {}
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <PointCloudSegmentRing-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+void PointCloudSegmentRing::clear(size_t point_step) {
+	segments_.clear();
+	point_step_ = point_step;
+	number_of_points_ = 0;
+	pending_segment_offset_ = 0;
+}
+
+
+uint8_t* PointCloudSegmentRing::beginSegment(size_t max_number_of_points) {
+	size_t number_of_bytes = max_number_of_points * point_step_;
+
+	if (segments_.empty()) {
+		pending_segment_offset_ = 0;
+		if (number_of_bytes > buffer_.size()) { growAndLinearize(number_of_bytes); }
+	} else {
+		const Segment& oldest_segment = segments_.front();
+		const Segment& newest_segment = segments_.back();
+		size_t newest_segment_end = newest_segment.offset + newest_segment.number_of_points * point_step_;
+
+		if (newest_segment.offset >= oldest_segment.offset) { // used memory is [oldest, newest_end) -> free memory at the end and at the beginning of the buffer
+			if (newest_segment_end + number_of_bytes <= buffer_.size()) {
+				pending_segment_offset_ = newest_segment_end;
+			} else if (number_of_bytes <= oldest_segment.offset) {
+				pending_segment_offset_ = 0; // wrap around
+			} else {
+				growAndLinearize(number_of_bytes);
+			}
+		} else { // wrapped -> free memory is [newest_end, oldest)
+			if (newest_segment_end + number_of_bytes <= oldest_segment.offset) {
+				pending_segment_offset_ = newest_segment_end;
+			} else {
+				growAndLinearize(number_of_bytes);
+			}
+		}
+	}
+
+	return buffer_.empty() ? NULL : &buffer_[pending_segment_offset_];
+}
+
+
+void PointCloudSegmentRing::commitSegment(const ros::Time& stamp, size_t number_of_points) {
+	if (number_of_points == 0) { return; } // empty segments would make the wrap around detection ambiguous
+
+	Segment segment;
+	segment.stamp = stamp;
+	segment.offset = pending_segment_offset_;
+	segment.number_of_points = number_of_points;
+	segments_.push_back(segment);
+	number_of_points_ += number_of_points;
+}
+
+
+size_t PointCloudSegmentRing::evictSegmentsOlderThan(const ros::Time& stamp) {
+	size_t number_of_evicted_segments = 0;
+	while (!segments_.empty() && segments_.front().stamp < stamp) {
+		number_of_points_ -= segments_.front().number_of_points;
+		segments_.pop_front();
+		++number_of_evicted_segments;
+	}
+	return number_of_evicted_segments;
+}
+
+
+void PointCloudSegmentRing::copyPoints(uint8_t* destination) const {
+	if (segments_.empty()) { return; }
+
+	// segments written one after the other are copied together (usually there are at most two runs: before and after the wrap around)
+	size_t run_offset = segments_.front().offset;
+	size_t run_size = 0;
+	for (std::deque<Segment>::const_iterator it = segments_.begin(); it != segments_.end(); ++it) {
+		size_t segment_size = it->number_of_points * point_step_;
+		if (it->offset != run_offset + run_size) {
+			std::memcpy(destination, &buffer_[run_offset], run_size);
+			destination += run_size;
+			run_offset = it->offset;
+			run_size = 0;
+		}
+		run_size += segment_size;
+	}
+	std::memcpy(destination, &buffer_[run_offset], run_size);
+}
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </PointCloudSegmentRing-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// =============================================================================  </public-section>   ==========================================================================
+
+// =============================================================================   <protected-section>   =======================================================================
+void PointCloudSegmentRing::growAndLinearize(size_t number_of_bytes) {
+	size_t used_bytes = number_of_points_ * point_step_;
+	std::vector<uint8_t> new_buffer(std::max(buffer_.size() * 2, used_bytes + number_of_bytes));
+
+	copyPoints(new_buffer.empty() ? NULL : &new_buffer[0]);
+
+	size_t offset = 0;
+	for (std::deque<Segment>::iterator it = segments_.begin(); it != segments_.end(); ++it) {
+		it->offset = offset;
+		offset += it->number_of_points * point_step_;
+	}
+
+	buffer_.swap(new_buffer);
+	pending_segment_offset_ = used_bytes;
+	ROS_DEBUG_STREAM("Point cloud segment ring grew to " << buffer_.size() << " bytes");
+}
+// =============================================================================   </protected-section>  =======================================================================
+} /* namespace laserscan_to_pointcloud */
@@ -14,11 +14,16 @@ namespace laserscan_to_pointcloud {
 // =============================================================================  <public-section>   ===========================================================================
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <PolarToCartesianCache-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 const Eigen::Array2Xf& PolarToCartesianCache::getPolarToCartesianMatrix(size_t polar_to_cartesian_matrix_number_measurements, float polar_to_cartesian_matrix_angle_min, float polar_to_cartesian_matrix_angle_increment) {
+	return getPolarToCartesianMatrixEntry(polar_to_cartesian_matrix_number_measurements, polar_to_cartesian_matrix_angle_min, polar_to_cartesian_matrix_angle_increment).polar_to_cartesian_matrix_;
+}
+
+
+PolarToCartesianMatrix& PolarToCartesianCache::getPolarToCartesianMatrixEntry(size_t polar_to_cartesian_matrix_number_measurements, float polar_to_cartesian_matrix_angle_min, float polar_to_cartesian_matrix_angle_increment) {
 	for (int i = 0; i < matrices_cache_.size(); ++i) {
 		if (matrices_cache_[i].polar_to_cartesian_matrix_number_measurements_ 	== polar_to_cartesian_matrix_number_measurements &&
 			matrices_cache_[i].polar_to_cartesian_matrix_angle_min_ 			== polar_to_cartesian_matrix_angle_min &&
 			matrices_cache_[i].polar_to_cartesian_matrix_angle_increment_ 		== polar_to_cartesian_matrix_angle_increment) {
-			return matrices_cache_[i].polar_to_cartesian_matrix_;
+			return matrices_cache_[i];
 		}
 	}
 
@@ -39,7 +44,26 @@ const Eigen::Array2Xf& PolarToCartesianCache::getPolarToCartesianMatrix(size_t p
 		current_angle += polar_to_cartesian_matrix_angle_increment;
 	}
 
-	return polar_to_cartesian_matrix;
+	return matrices_cache_.back();
+}
+
+
+const std::vector<size_t>& PolarToCartesianCache::getBeamIndices(PolarToCartesianMatrix& polar_to_cartesian_matrix_entry, double beam_stride) {
+	beam_stride = std::max(beam_stride, 1.0);
+	if (polar_to_cartesian_matrix_entry.beam_indices_stride_ != beam_stride) {
+		std::vector<size_t>& beam_indices = polar_to_cartesian_matrix_entry.beam_indices_;
+		size_t number_of_measurements = polar_to_cartesian_matrix_entry.polar_to_cartesian_matrix_number_measurements_;
+		beam_indices.clear();
+		beam_indices.reserve((size_t)std::ceil((double)number_of_measurements / beam_stride));
+		for (size_t i = 0; ; ++i) {
+			size_t beam_index = (size_t)((double)i * beam_stride + 0.5);
+			if (beam_index >= number_of_measurements) { break; }
+			beam_indices.push_back(beam_index);
+		}
+		polar_to_cartesian_matrix_entry.beam_indices_stride_ = beam_stride;
+	}
+
+	return polar_to_cartesian_matrix_entry.beam_indices_;
 }
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </PolarToCartesianCache-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 // =============================================================================  </public-section>   ==========================================================================
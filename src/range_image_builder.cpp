@@ -0,0 +1,97 @@
+/**\file range_image_builder.cpp
+ * \brief Implementation of the range and intensity images built during the LaserScan projection.
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+#include <laserscan_to_pointcloud/range_image_builder.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+namespace laserscan_to_pointcloud {
+// =============================================================================  <public-section>   ===========================================================================
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+RangeImageBuilder::RangeImageBuilder() :
+		enabled_(false),
+		intensity_image_enabled_(false),
+		intensity_scale_(1.0f),
+		number_of_reserved_rows_(0),
+		range_row_(NULL),
+		intensity_row_(NULL) {}
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <RangeImageBuilder-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+void RangeImageBuilder::clear(const std::string& frame_id, size_t number_of_reserved_rows) {
+	// new messages, because the previous ones may still be referenced by subscribers
+	range_image_.reset(new sensor_msgs::Image());
+	initImage(*range_image_, frame_id);
+
+	intensity_image_.reset();
+	if (intensity_image_enabled_) {
+		intensity_image_.reset(new sensor_msgs::Image());
+		initImage(*intensity_image_, frame_id);
+	}
+
+	row_poses_.reset(new nav_msgs::Path());
+	row_poses_->header.frame_id = frame_id;
+	row_poses_->poses.reserve(number_of_reserved_rows);
+
+	number_of_reserved_rows_ = number_of_reserved_rows;
+	range_row_ = NULL;
+	intensity_row_ = NULL;
+}
+
+
+void RangeImageBuilder::beginRow(size_t number_of_beams, const ros::Time& stamp, const tf2::Transform& sensor_pose) {
+	if (range_image_->height == 0) {
+		range_image_->width = number_of_beams;
+		range_image_->step = number_of_beams * sizeof(uint16_t);
+		range_image_->data.reserve(number_of_reserved_rows_ * range_image_->step);
+		if (intensity_image_) {
+			intensity_image_->width = range_image_->width;
+			intensity_image_->step = range_image_->step;
+			intensity_image_->data.reserve(number_of_reserved_rows_ * intensity_image_->step);
+		}
+	}
+
+	range_row_ = addImageRow(*range_image_);
+	intensity_row_ = intensity_image_ ? addImageRow(*intensity_image_) : NULL;
+
+	geometry_msgs::PoseStamped row_pose;
+	row_pose.header.frame_id = row_poses_->header.frame_id;
+	row_pose.header.stamp = stamp;
+	tf_rosmsg_eigen_conversions::transformTF2ToMsg(sensor_pose, row_pose.pose);
+	row_poses_->poses.push_back(row_pose);
+}
+
+
+void RangeImageBuilder::endRow() {
+	range_row_ = NULL;
+	intensity_row_ = NULL;
+}
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </RangeImageBuilder-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// =============================================================================  </public-section>   ==========================================================================
+
+// =============================================================================   <protected-section>   =======================================================================
+void RangeImageBuilder::initImage(sensor_msgs::Image& image, const std::string& frame_id) {
+	image.header.frame_id = frame_id;
+	image.height = 0;
+	image.width = 0;
+	image.encoding = "16UC1";
+	image.is_bigendian = false;
+	image.step = 0;
+	image.data.clear();
+}
+
+
+uint16_t* RangeImageBuilder::addImageRow(sensor_msgs::Image& image) {
+	size_t row_offset = image.height * image.step;
+	image.data.resize(row_offset + image.step, 0); // discarded beams are kept as 0 (invalid depth)
+	++image.height;
+	return image.step > 0 ? (uint16_t*)(&image.data[row_offset]) : NULL;
+}
+// =============================================================================   </protected-section>  =======================================================================
+} /* namespace laserscan_to_pointcloud */
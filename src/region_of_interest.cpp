@@ -0,0 +1,83 @@
+/**\file region_of_interest.cpp
+ * \brief Implementation of a region of interest used to crop point clouds.
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+#include <laserscan_to_pointcloud/region_of_interest.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+namespace laserscan_to_pointcloud {
+// =============================================================================  <public-section>   ===========================================================================
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+RegionOfInterest::RegionOfInterest() {
+	clear();
+}
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <RegionOfInterest-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+void RegionOfInterest::clear() {
+	use_box_ = false;
+	box_min_.setZero();
+	box_max_.setZero();
+
+	use_cylinder_ = false;
+	cylinder_center_x_ = 0;
+	cylinder_center_y_ = 0;
+	cylinder_squared_radius_ = 0;
+	cylinder_min_z_ = 0;
+	cylinder_max_z_ = 0;
+
+	use_height_band_ = false;
+	height_band_min_ = 0;
+	height_band_max_ = 0;
+
+	use_max_radius_ = false;
+	max_squared_radius_ = 0;
+}
+
+
+bool RegionOfInterest::setBox(const std::vector<double>& box) {
+	use_box_ = (box.size() == 6);
+	if (use_box_) {
+		box_min_.setValue(box[0], box[1], box[2]);
+		box_max_.setValue(box[3], box[4], box[5]);
+	}
+	return use_box_ || box.empty();
+}
+
+
+bool RegionOfInterest::setCylinder(const std::vector<double>& cylinder) {
+	use_cylinder_ = (cylinder.size() == 5);
+	if (use_cylinder_) {
+		cylinder_center_x_ = cylinder[0];
+		cylinder_center_y_ = cylinder[1];
+		cylinder_squared_radius_ = cylinder[2] * cylinder[2];
+		cylinder_min_z_ = cylinder[3];
+		cylinder_max_z_ = cylinder[4];
+	}
+	return use_cylinder_ || cylinder.empty();
+}
+
+
+bool RegionOfInterest::setHeightBand(const std::vector<double>& height_band) {
+	use_height_band_ = (height_band.size() == 2);
+	if (use_height_band_) {
+		height_band_min_ = height_band[0];
+		height_band_max_ = height_band[1];
+	}
+	return use_height_band_ || height_band.empty();
+}
+
+
+void RegionOfInterest::setMaxRadius(double max_radius) {
+	use_max_radius_ = (max_radius > 0.0);
+	max_squared_radius_ = max_radius * max_radius;
+}
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </RegionOfInterest-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// =============================================================================  </public-section>   ==========================================================================
+} /* namespace laserscan_to_pointcloud */
@@ -0,0 +1,114 @@
+/**\file self_filter.cpp
+ * \brief Implementation of the removal of points inside collision primitives attached to TF frames.
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+#include <laserscan_to_pointcloud/self_filter.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+namespace laserscan_to_pointcloud {
+// =============================================================================  <public-section>   ===========================================================================
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <SelfFilter-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+bool SelfFilter::addPrimitive(const std::string& shape, const std::string& frame_id, const std::vector<double>& dimensions, const std::vector<double>& offset, double padding) {
+	SelfFilterPrimitive primitive;
+	primitive.frame_id_ = frame_id;
+
+	if (shape == "box" && dimensions.size() == 3) {
+		primitive.shape_ = SelfFilterPrimitive::BOX;
+		primitive.half_extents_.setValue(dimensions[0] * 0.5 + padding, dimensions[1] * 0.5 + padding, dimensions[2] * 0.5 + padding);
+	} else if (shape == "cylinder" && dimensions.size() == 2) {
+		primitive.shape_ = SelfFilterPrimitive::CYLINDER;
+		primitive.half_extents_.setValue(dimensions[0] + padding, dimensions[0] + padding, dimensions[1] * 0.5 + padding);
+	} else if (shape == "sphere" && dimensions.size() == 1) {
+		primitive.shape_ = SelfFilterPrimitive::SPHERE;
+		primitive.half_extents_.setValue(dimensions[0] + padding, dimensions[0] + padding, dimensions[0] + padding);
+	} else {
+		return false;
+	}
+
+	if (offset.size() != 0 && offset.size() != 3 && offset.size() != 6) { return false; }
+
+	tf2::Quaternion offset_rotation(0, 0, 0, 1);
+	if (offset.size() == 6) { offset_rotation.setRPY(offset[3], offset[4], offset[5]); }
+	primitive.offset_ = tf2::Transform(offset_rotation, offset.empty() ? tf2::Vector3(0, 0, 0) : tf2::Vector3(offset[0], offset[1], offset[2]));
+
+	primitive.squared_radius_ = primitive.half_extents_.x() * primitive.half_extents_.x();
+	if (primitive.shape_ == SelfFilterPrimitive::BOX) {
+		primitive.bounding_sphere_squared_radius_ = primitive.half_extents_.length2();
+	} else if (primitive.shape_ == SelfFilterPrimitive::CYLINDER) {
+		primitive.bounding_sphere_squared_radius_ = primitive.squared_radius_ + primitive.half_extents_.z() * primitive.half_extents_.z();
+	} else {
+		primitive.bounding_sphere_squared_radius_ = primitive.squared_radius_;
+	}
+
+	primitives_.push_back(primitive);
+	setPrimitiveFrameTransform(primitives_.size() - 1, tf2::Transform::getIdentity());
+	return true;
+}
+
+
+bool SelfFilter::loadPrimitives(XmlRpc::XmlRpcValue& primitives, double default_padding) {
+	if (primitives.getType() != XmlRpc::XmlRpcValue::TypeArray) {
+		ROS_WARN("The self filter primitives must be a list");
+		return false;
+	}
+
+	bool all_primitives_loaded = true;
+	for (int i = 0; i < primitives.size(); ++i) {
+		XmlRpc::XmlRpcValue& primitive = primitives[i];
+		std::vector<double> dimensions;
+		std::vector<double> offset;
+		double padding = default_padding;
+
+		if (primitive.getType() != XmlRpc::XmlRpcValue::TypeStruct ||
+				!primitive.hasMember("frame_id") || primitive["frame_id"].getType() != XmlRpc::XmlRpcValue::TypeString ||
+				!primitive.hasMember("shape") || primitive["shape"].getType() != XmlRpc::XmlRpcValue::TypeString ||
+				!primitive.hasMember("dimensions") || !readDoubles(primitive["dimensions"], dimensions) ||
+				(primitive.hasMember("offset") && !readDoubles(primitive["offset"], offset)) ||
+				(primitive.hasMember("padding") && !readDouble(primitive["padding"], padding)) ||
+				!addPrimitive(static_cast<std::string&>(primitive["shape"]), static_cast<std::string&>(primitive["frame_id"]), dimensions, offset, padding)) {
+			ROS_WARN_STREAM("Skipping invalid self filter primitive " << i << " (expected frame_id, shape [box | cylinder | sphere], dimensions and optionally offset and padding)");
+			all_primitives_loaded = false;
+		}
+	}
+
+	return all_primitives_loaded;
+}
+
+
+void SelfFilter::setPrimitiveFrameTransform(size_t primitive_index, const tf2::Transform& frame_to_target_frame_transform) {
+	SelfFilterPrimitive& primitive = primitives_[primitive_index];
+	tf2::Transform primitive_pose = frame_to_target_frame_transform * primitive.offset_;
+	primitive.target_frame_to_primitive_transform_ = primitive_pose.inverse();
+	primitive.bounding_sphere_center_ = primitive_pose.getOrigin();
+}
+
+
+bool SelfFilter::readDouble(XmlRpc::XmlRpcValue& value, double& number_out) {
+	if (value.getType() == XmlRpc::XmlRpcValue::TypeDouble) {
+		number_out = static_cast<double&>(value);
+		return true;
+	} else if (value.getType() == XmlRpc::XmlRpcValue::TypeInt) {
+		number_out = static_cast<int&>(value);
+		return true;
+	}
+	return false;
+}
+
+
+bool SelfFilter::readDoubles(XmlRpc::XmlRpcValue& values, std::vector<double>& numbers_out) {
+	if (values.getType() != XmlRpc::XmlRpcValue::TypeArray) { return false; }
+
+	numbers_out.resize(values.size());
+	for (int i = 0; i < values.size(); ++i) {
+		if (!readDouble(values[i], numbers_out[i])) { return false; }
+	}
+	return true;
+}
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </SelfFilter-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// =============================================================================  </public-section>   ==========================================================================
+} /* namespace laserscan_to_pointcloud */
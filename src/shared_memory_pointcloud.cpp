@@ -0,0 +1,205 @@
+/**\file shared_memory_pointcloud.cpp
+ * \brief Implementation of the shared memory ring of serialized PointCloud2 messages.
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+#include <laserscan_to_pointcloud/shared_memory_pointcloud.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+namespace laserscan_to_pointcloud {
+using namespace shared_memory_pointcloud_layout;
+
+// #################################################################   SharedMemoryPointCloudPublisher   ######################################################################
+// =============================================================================  <public-section>   ===========================================================================
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+SharedMemoryPointCloudPublisher::SharedMemoryPointCloudPublisher() :
+		number_of_slots_(0),
+		slot_size_(0),
+		sequence_(0),
+		nonce_(0),
+		number_of_dropped_pointclouds_(0) {}
+
+SharedMemoryPointCloudPublisher::~SharedMemoryPointCloudPublisher() {
+	close();
+}
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <SharedMemoryPointCloudPublisher-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+bool SharedMemoryPointCloudPublisher::open(const std::string& shared_memory_name, size_t number_of_slots, size_t slot_size) {
+	close();
+	if (number_of_slots < 2 || slot_size == 0) {
+		ROS_WARN_STREAM("The shared memory ring [" << shared_memory_name << "] needs at least 2 slots with more than 0 bytes");
+		return false;
+	}
+
+	try {
+		boost::interprocess::shared_memory_object::remove(shared_memory_name.c_str()); // left by a process that did not exit cleanly
+		boost::interprocess::shared_memory_object shared_memory(boost::interprocess::create_only, shared_memory_name.c_str(), boost::interprocess::read_write);
+		shared_memory.truncate((boost::interprocess::offset_t)getSharedMemorySize((uint32_t)number_of_slots, slot_size));
+		region_.reset(new boost::interprocess::mapped_region(shared_memory, boost::interprocess::read_write)); // the mapping remains valid after the shared_memory_object is destroyed
+	} catch (const boost::interprocess::interprocess_exception& exception) {
+		ROS_ERROR_STREAM("Failed to create the shared memory ring [" << shared_memory_name << "]: " << exception.what());
+		region_.reset();
+		return false;
+	}
+
+	shared_memory_name_ = shared_memory_name;
+	number_of_slots_ = number_of_slots;
+	slot_size_ = slot_size;
+	sequence_ = 0;
+	nonce_ = ((uint64_t)getpid() << 32) ^ (uint64_t)ros::WallTime::now().toNSec(); // a ring created again with the same name gets a different nonce
+
+	uint8_t* memory = (uint8_t*)region_->get_address();
+	memset(memory, 0, region_->get_size());
+	RingHeader* ring_header = (RingHeader*)memory;
+	ring_header->version = VERSION;
+	ring_header->number_of_slots = (uint32_t)number_of_slots;
+	ring_header->slot_size = slot_size;
+	ring_header->nonce = nonce_;
+	memoryBarrier();
+	ring_header->magic = MAGIC; // readers only accept the ring after it is initialized
+	return true;
+}
+
+
+void SharedMemoryPointCloudPublisher::close() {
+	if (region_) {
+		region_.reset();
+		boost::interprocess::shared_memory_object::remove(shared_memory_name_.c_str()); // readers keep their mappings until they close them
+	}
+}
+
+
+bool SharedMemoryPointCloudPublisher::writePointCloud(const sensor_msgs::PointCloud2& pointcloud, SharedMemoryPointCloud& descriptor) {
+	size_t size = ros::serialization::serializationLength(pointcloud);
+	SlotHeader* slot = beginSlotWrite(size);
+	if (slot == NULL) { return false; }
+
+	ros::serialization::OStream stream((uint8_t*)slot + ALIGNMENT, (uint32_t)size);
+	ros::serialization::serialize(stream, pointcloud);
+	finishSlotWrite(slot, size, pointcloud.header, descriptor);
+	return true;
+}
+
+
+bool SharedMemoryPointCloudPublisher::writeSerializedPointCloud(const uint8_t* serialized_pointcloud, size_t size, const std_msgs::Header& header, SharedMemoryPointCloud& descriptor) {
+	SlotHeader* slot = beginSlotWrite(size);
+	if (slot == NULL) { return false; }
+
+	memcpy((uint8_t*)slot + ALIGNMENT, serialized_pointcloud, size);
+	finishSlotWrite(slot, size, header, descriptor);
+	return true;
+}
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </SharedMemoryPointCloudPublisher-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// =============================================================================  </public-section>   ==========================================================================
+
+// =============================================================================   <protected-section>   =======================================================================
+SlotHeader* SharedMemoryPointCloudPublisher::beginSlotWrite(size_t size) {
+	if (!region_) { return NULL; }
+	if (size > slot_size_) {
+		ROS_WARN_STREAM_THROTTLE(5.0, "Dropped cloud with " << size << " bytes that does not fit in the " << slot_size_ << " bytes slots of the shared memory ring ["
+				<< shared_memory_name_ << "] (dropped " << ++number_of_dropped_pointclouds_ << " clouds so far)");
+		return NULL;
+	}
+
+	++sequence_;
+	SlotHeader* slot = (SlotHeader*)((uint8_t*)region_->get_address() + getRingHeaderSize() + (sequence_ % number_of_slots_) * getSlotStride(slot_size_));
+	slot->sequence = 0; // readers of the previous cloud in this slot will see that it was overwritten
+	memoryBarrier();
+	return slot;
+}
+
+
+void SharedMemoryPointCloudPublisher::finishSlotWrite(SlotHeader* slot, size_t size, const std_msgs::Header& header, SharedMemoryPointCloud& descriptor) {
+	slot->size = size;
+	memoryBarrier();
+	slot->sequence = sequence_;
+
+	descriptor.header = header;
+	descriptor.shared_memory_name = shared_memory_name_;
+	descriptor.slot = (uint32_t)(sequence_ % number_of_slots_);
+	descriptor.sequence = sequence_;
+	descriptor.size = (uint32_t)size;
+	descriptor.ring_nonce = nonce_;
+}
+// =============================================================================   </protected-section>  =======================================================================
+
+
+
+// ##################################################################   SharedMemoryPointCloudReader   #######################################################################
+// =============================================================================  <public-section>   ===========================================================================
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+SharedMemoryPointCloudReader::SharedMemoryPointCloudReader() :
+		number_of_slots_(0),
+		slot_size_(0),
+		nonce_(0) {}
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <SharedMemoryPointCloudReader-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+bool SharedMemoryPointCloudReader::open(const std::string& shared_memory_name) {
+	close();
+	try {
+		boost::interprocess::shared_memory_object shared_memory(boost::interprocess::open_only, shared_memory_name.c_str(), boost::interprocess::read_only);
+		region_.reset(new boost::interprocess::mapped_region(shared_memory, boost::interprocess::read_only));
+	} catch (const boost::interprocess::interprocess_exception& exception) {
+		ROS_WARN_STREAM_THROTTLE(5.0, "Failed to open the shared memory ring [" << shared_memory_name << "]: " << exception.what());
+		region_.reset();
+		return false;
+	}
+
+	const RingHeader* ring_header = (const RingHeader*)region_->get_address();
+	if (region_->get_size() < getRingHeaderSize() || ring_header->magic != MAGIC || ring_header->version != VERSION
+			|| region_->get_size() < getSharedMemorySize(ring_header->number_of_slots, ring_header->slot_size)) {
+		ROS_WARN_STREAM_THROTTLE(5.0, "The shared memory object [" << shared_memory_name << "] is not an initialized point cloud ring (version " << VERSION << ")");
+		region_.reset();
+		return false;
+	}
+
+	shared_memory_name_ = shared_memory_name;
+	number_of_slots_ = ring_header->number_of_slots;
+	slot_size_ = ring_header->slot_size;
+	nonce_ = ring_header->nonce;
+	return true;
+}
+
+
+void SharedMemoryPointCloudReader::close() {
+	region_.reset();
+	shared_memory_name_.clear();
+}
+
+
+bool SharedMemoryPointCloudReader::readPointCloud(const SharedMemoryPointCloud& descriptor, sensor_msgs::PointCloud2& pointcloud) {
+	// the publisher may have restarted and created a new ring with the same name (the current mapping would never receive its clouds)
+	if ((descriptor.shared_memory_name != shared_memory_name_ || descriptor.ring_nonce != nonce_ || !region_) && !open(descriptor.shared_memory_name)) { return false; }
+	return readPointCloudFromSlot(descriptor, pointcloud);
+}
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </SharedMemoryPointCloudReader-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// =============================================================================  </public-section>   ==========================================================================
+
+// =============================================================================   <protected-section>   =======================================================================
+bool SharedMemoryPointCloudReader::readPointCloudFromSlot(const SharedMemoryPointCloud& descriptor, sensor_msgs::PointCloud2& pointcloud) {
+	if (descriptor.slot >= number_of_slots_ || descriptor.size > slot_size_) { return false; }
+
+	const SlotHeader* slot = (const SlotHeader*)((const uint8_t*)region_->get_address() + getRingHeaderSize() + descriptor.slot * getSlotStride(slot_size_));
+	if (slot->sequence != descriptor.sequence) { return false; }
+	memoryBarrier();
+
+	try { // a slot overwritten during the deserialization can have invalid lengths (detected by the stream bounds)
+		ros::serialization::IStream stream((uint8_t*)slot + ALIGNMENT, descriptor.size);
+		ros::serialization::deserialize(stream, pointcloud);
+	} catch (const ros::serialization::StreamOverrunException&) {
+		return false;
+	}
+
+	memoryBarrier();
+	return slot->sequence == descriptor.sequence;
+}
+// =============================================================================   </protected-section>  =======================================================================
+} /* namespace laserscan_to_pointcloud */
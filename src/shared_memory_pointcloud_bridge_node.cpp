@@ -0,0 +1,63 @@
+/**\file shared_memory_pointcloud_bridge_node.cpp
+ * \brief Republishes the clouds of a shared memory ring (announced by SharedMemoryPointCloud descriptors) as sensor_msgs/PointCloud2.
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+#include <ros/ros.h>
+#include <sensor_msgs/PointCloud2.h>
+#include <laserscan_to_pointcloud/SharedMemoryPointCloud.h>
+#include <laserscan_to_pointcloud/shared_memory_pointcloud.h>
+#include <laserscan_to_pointcloud/pointcloud_message_pool.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+namespace laserscan_to_pointcloud {
+// ##################################################################   SharedMemoryPointCloudBridge   ########################################################################
+class SharedMemoryPointCloudBridge {
+	public:
+		SharedMemoryPointCloudBridge(ros::NodeHandle& node_handle, ros::NodeHandle& private_node_handle) : number_of_failed_reads_(0) {
+			std::string descriptor_topic, pointcloud_publish_topic;
+			private_node_handle.param("shared_memory_descriptor_topic", descriptor_topic, std::string("ambient_pointcloud_shared_memory"));
+			private_node_handle.param("pointcloud_publish_topic", pointcloud_publish_topic, std::string("ambient_pointcloud_from_shared_memory"));
+			pointcloud_publisher_ = node_handle.advertise<sensor_msgs::PointCloud2>(pointcloud_publish_topic, 10);
+			descriptor_subscriber_ = node_handle.subscribe(descriptor_topic, 10, &laserscan_to_pointcloud::SharedMemoryPointCloudBridge::processDescriptor, this);
+			ROS_INFO_STREAM("Republishing the clouds announced in " << descriptor_topic << " in topic " << pointcloud_publish_topic);
+		}
+
+		void processDescriptor(const SharedMemoryPointCloudConstPtr& descriptor) {
+			sensor_msgs::PointCloud2Ptr pointcloud = pointcloud_pool_.acquirePointCloud(); // recycled clouds keep the capacity of their data
+			if (!shared_memory_reader_.readPointCloud(*descriptor, *pointcloud)) {
+				ROS_WARN_STREAM_THROTTLE(5.0, "Failed to read cloud " << descriptor->sequence << " from the shared memory ring [" << descriptor->shared_memory_name
+						<< "] (failed " << ++number_of_failed_reads_ << " reads so far)");
+				return;
+			}
+			pointcloud_publisher_.publish(sensor_msgs::PointCloud2ConstPtr(pointcloud));
+		}
+
+	private:
+		SharedMemoryPointCloudReader shared_memory_reader_;
+		PointCloudMessagePool pointcloud_pool_;
+		size_t number_of_failed_reads_;
+		ros::Subscriber descriptor_subscriber_;
+		ros::Publisher pointcloud_publisher_;
+};
+} /* namespace laserscan_to_pointcloud */
+
+
+
+// ###################################################################################   <main>   ##############################################################################
+int main(int argc, char** argv) {
+	ros::init(argc, argv, "shared_memory_pointcloud_bridge");
+
+	ros::NodeHandle node_handle;
+	ros::NodeHandle private_node_handle("~");
+	laserscan_to_pointcloud::SharedMemoryPointCloudBridge shared_memory_pointcloud_bridge(node_handle, private_node_handle);
+
+	ros::spin();
+
+	return 0;
+}
+// ###################################################################################   </main>   #############################################################################
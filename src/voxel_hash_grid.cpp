@@ -0,0 +1,130 @@
+/**\file voxel_hash_grid.cpp
+ * \brief Implementation of an open addressing hash of voxels.
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+#include <laserscan_to_pointcloud/voxel_hash_grid.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+namespace laserscan_to_pointcloud {
+// =============================================================================  <public-section>   ===========================================================================
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+VoxelHashGrid::VoxelHashGrid(double voxel_size) :
+		voxel_size_(voxel_size),
+		inverse_voxel_size_(voxel_size > 0.0 ? 1.0 / voxel_size : 0.0),
+		hash_table_number_of_bits_(0) {
+	rehash(10);
+}
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <VoxelHashGrid-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+void VoxelHashGrid::clear() {
+	if (voxels_.empty()) { return; }
+
+	if (voxels_.size() * 8 < hash_table_.size()) { // sparse table -> only reset the used slots
+		// in reverse insertion order the probing path of each voxel only crosses slots of voxels that were not reset yet
+		size_t mask = hash_table_.size() - 1;
+		for (size_t i = voxels_.size(); i > 0; --i) {
+			size_t slot = computeHashTableSlot(voxels_[i - 1].key);
+			while (hash_table_[slot] != i) { slot = (slot + 1) & mask; }
+			hash_table_[slot] = 0;
+		}
+	} else {
+		std::fill(hash_table_.begin(), hash_table_.end(), 0);
+	}
+
+	voxels_.clear();
+}
+
+
+void VoxelHashGrid::reserve(size_t number_of_voxels) {
+	voxels_.reserve(number_of_voxels);
+	size_t number_of_bits = hash_table_number_of_bits_;
+	while (((size_t)1 << number_of_bits) < number_of_voxels * 2) { ++number_of_bits; }
+	if (number_of_bits != hash_table_number_of_bits_) { rehash(number_of_bits); }
+}
+
+
+void VoxelHashGrid::addPoint(double x, double y, double z, double intensity) {
+	if (!std::isfinite(x) || !std::isfinite(y) || !std::isfinite(z)) { return; } // infinite or NaN coordinates have no voxel (and their integer conversion is undefined)
+	accumulate(computeVoxelKey(x, y, z), x, y, z, intensity, 1);
+}
+
+
+void VoxelHashGrid::addVoxel(const Voxel& voxel) {
+	double inverse_number_of_points = 1.0 / (double)voxel.number_of_points;
+	uint64_t key = computeVoxelKey(voxel.sum_x * inverse_number_of_points, voxel.sum_y * inverse_number_of_points, voxel.sum_z * inverse_number_of_points);
+	accumulate(key, voxel.sum_x, voxel.sum_y, voxel.sum_z, voxel.sum_intensity, voxel.number_of_points);
+}
+
+
+uint64_t VoxelHashGrid::computeVoxelKey(double x, double y, double z) const {
+	const int64_t offset = (int64_t)1 << 20;
+	const uint64_t mask = ((uint64_t)1 << 21) - 1;
+	uint64_t voxel_x = (uint64_t)((int64_t)std::floor(x * inverse_voxel_size_) + offset) & mask;
+	uint64_t voxel_y = (uint64_t)((int64_t)std::floor(y * inverse_voxel_size_) + offset) & mask;
+	uint64_t voxel_z = (uint64_t)((int64_t)std::floor(z * inverse_voxel_size_) + offset) & mask;
+	return (voxel_x << 42) | (voxel_y << 21) | voxel_z;
+}
+
+
+void VoxelHashGrid::setVoxelSize(double voxel_size) {
+	if (voxel_size != voxel_size_) {
+		clear();
+		voxel_size_ = voxel_size;
+		inverse_voxel_size_ = voxel_size > 0.0 ? 1.0 / voxel_size : 0.0;
+	}
+}
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </VoxelHashGrid-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// =============================================================================  </public-section>   ==========================================================================
+
+// =============================================================================   <protected-section>   =======================================================================
+void VoxelHashGrid::rehash(size_t number_of_bits) {
+	hash_table_number_of_bits_ = number_of_bits;
+	hash_table_.assign((size_t)1 << number_of_bits, 0);
+	size_t mask = hash_table_.size() - 1;
+
+	for (size_t i = 0; i < voxels_.size(); ++i) {
+		size_t slot = computeHashTableSlot(voxels_[i].key);
+		while (hash_table_[slot] != 0) { slot = (slot + 1) & mask; }
+		hash_table_[slot] = (uint32_t)(i + 1);
+	}
+}
+
+
+void VoxelHashGrid::accumulate(uint64_t key, double sum_x, double sum_y, double sum_z, double sum_intensity, uint32_t number_of_points) {
+	size_t mask = hash_table_.size() - 1;
+	size_t slot = computeHashTableSlot(key);
+
+	while (hash_table_[slot] != 0) {
+		Voxel& voxel = voxels_[hash_table_[slot] - 1];
+		if (voxel.key == key) {
+			voxel.sum_x += sum_x;
+			voxel.sum_y += sum_y;
+			voxel.sum_z += sum_z;
+			voxel.sum_intensity += sum_intensity;
+			voxel.number_of_points += number_of_points;
+			return;
+		}
+		slot = (slot + 1) & mask;
+	}
+
+	Voxel voxel;
+	voxel.key = key;
+	voxel.sum_x = sum_x;
+	voxel.sum_y = sum_y;
+	voxel.sum_z = sum_z;
+	voxel.sum_intensity = sum_intensity;
+	voxel.number_of_points = number_of_points;
+	voxels_.push_back(voxel);
+	hash_table_[slot] = (uint32_t)voxels_.size();
+
+	if (voxels_.size() * 2 > hash_table_.size()) { rehash(hash_table_number_of_bits_ + 1); }
+}
+// =============================================================================   </protected-section>  =======================================================================
+} /* namespace laserscan_to_pointcloud */
@@ -0,0 +1,108 @@
+/**\file test_compact_laserscan_decoder.cpp
+ * \brief Tests of the decoding of compact LaserScans.
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+#include <gtest/gtest.h>
+#include <laserscan_to_pointcloud/compact_laserscan_decoder.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+using laserscan_to_pointcloud::CompactLaserScan;
+using laserscan_to_pointcloud::CompactLaserScanDecoder;
+using laserscan_to_pointcloud::CompactLaserScanGeometry;
+
+CompactLaserScanGeometry createGeometry(uint32_t geometry_id) {
+	CompactLaserScanGeometry geometry;
+	geometry.geometry_id = geometry_id;
+	geometry.angle_min = -1.0f;
+	geometry.angle_max = 1.0f;
+	geometry.angle_increment = 0.5f;
+	geometry.time_increment = 0.001f;
+	geometry.scan_time = 0.1f;
+	geometry.range_min = 0.05f;
+	geometry.range_max = 30.0f;
+	return geometry;
+}
+
+
+CompactLaserScan createCompactLaserScan(uint32_t geometry_id) {
+	CompactLaserScan compact_laser_scan;
+	compact_laser_scan.header.frame_id = "laser";
+	compact_laser_scan.geometry_id = geometry_id;
+	uint16_t ranges[5] = { 0, 1, 1500, 30000, 65535 };
+	compact_laser_scan.ranges.assign(ranges, ranges + 5);
+	return compact_laser_scan;
+}
+
+
+TEST(CompactLaserScanDecoder, WaitsForGeometry) {
+	CompactLaserScanDecoder decoder;
+	EXPECT_FALSE(decoder.decode(createCompactLaserScan(3)));
+	decoder.addGeometry(createGeometry(4));
+	EXPECT_FALSE(decoder.hasGeometry(3));
+	EXPECT_FALSE(decoder.decode(createCompactLaserScan(3)));
+}
+
+
+TEST(CompactLaserScanDecoder, ConvertsMillimetersToMeters) {
+	CompactLaserScanDecoder decoder;
+	decoder.addGeometry(createGeometry(3));
+	CompactLaserScan compact_laser_scan = createCompactLaserScan(3);
+	uint8_t intensities[5] = { 0, 10, 20, 30, 255 };
+	compact_laser_scan.intensities_uint8.assign(intensities, intensities + 5);
+
+	sensor_msgs::LaserScanConstPtr laser_scan = decoder.decode(compact_laser_scan);
+	ASSERT_TRUE(laser_scan);
+	EXPECT_EQ("laser", laser_scan->header.frame_id);
+	EXPECT_EQ(0.5f, laser_scan->angle_increment);
+	EXPECT_EQ(30.0f, laser_scan->range_max);
+	ASSERT_EQ(5u, laser_scan->ranges.size());
+	EXPECT_FLOAT_EQ(0.0f, laser_scan->ranges[0]);
+	EXPECT_FLOAT_EQ(0.001f, laser_scan->ranges[1]);
+	EXPECT_FLOAT_EQ(1.5f, laser_scan->ranges[2]);
+	EXPECT_FLOAT_EQ(65.535f, laser_scan->ranges[4]);
+	ASSERT_EQ(5u, laser_scan->intensities.size());
+	EXPECT_EQ(255.0f, laser_scan->intensities[4]);
+}
+
+
+TEST(CompactLaserScanDecoder, PrefersUint16IntensitiesAndIgnoresMismatchedSizes) {
+	CompactLaserScanDecoder decoder;
+	decoder.addGeometry(createGeometry(3));
+	CompactLaserScan compact_laser_scan = createCompactLaserScan(3);
+	compact_laser_scan.intensities_uint8.assign(5, 1);
+	compact_laser_scan.intensities_uint16.assign(5, 1000);
+	sensor_msgs::LaserScanConstPtr laser_scan = decoder.decode(compact_laser_scan);
+	ASSERT_EQ(5u, laser_scan->intensities.size());
+	EXPECT_EQ(1000.0f, laser_scan->intensities[0]);
+
+	compact_laser_scan.intensities_uint16.assign(4, 1000);
+	compact_laser_scan.intensities_uint8.clear();
+	laser_scan.reset();
+	laser_scan = decoder.decode(compact_laser_scan);
+	EXPECT_TRUE(laser_scan->intensities.empty());
+}
+
+
+TEST(CompactLaserScanDecoder, ReusesLaserScanOnlyWhenNotHeld) {
+	CompactLaserScanDecoder decoder;
+	decoder.addGeometry(createGeometry(3));
+	sensor_msgs::LaserScanConstPtr first_laser_scan = decoder.decode(createCompactLaserScan(3));
+	sensor_msgs::LaserScanConstPtr second_laser_scan = decoder.decode(createCompactLaserScan(3));
+	EXPECT_NE(first_laser_scan.get(), second_laser_scan.get()); // first one is still held
+
+	const sensor_msgs::LaserScan* second_laser_scan_address = second_laser_scan.get();
+	first_laser_scan.reset();
+	second_laser_scan.reset();
+	EXPECT_EQ(second_laser_scan_address, decoder.decode(createCompactLaserScan(3)).get());
+}
+
+
+int main(int argc, char** argv) {
+	testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,130 @@
+/**\file test_laserscan_prefilter.cpp
+ * \brief Tests of the shadow, median and intensity filters of LaserScans.
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+#include <gtest/gtest.h>
+#include <cmath>
+#include <limits>
+#include <laserscan_to_pointcloud/laserscan_prefilter.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+using laserscan_to_pointcloud::LaserScanPrefilter;
+
+/** Wall at 2 m with a box at 1 m in front of it and veiling points along the edges of the box */
+sensor_msgs::LaserScan createDepthDiscontinuityLaserScan() {
+	sensor_msgs::LaserScan laser_scan;
+	laser_scan.angle_min = -0.5f;
+	laser_scan.angle_increment = 0.01f;
+	laser_scan.ranges.resize(100, 2.0f);
+	for (size_t i = 40; i < 60; ++i) { laser_scan.ranges[i] = 1.0f; }
+	laser_scan.ranges[38] = 1.7f;
+	laser_scan.ranges[39] = 1.35f;
+	laser_scan.ranges[60] = 1.4f;
+	laser_scan.ranges[61] = 1.8f;
+	laser_scan.ranges[75] = std::numeric_limits<float>::quiet_NaN();
+	laser_scan.ranges[76] = std::numeric_limits<float>::infinity();
+	laser_scan.angle_max = laser_scan.angle_min + laser_scan.angle_increment * (float)(laser_scan.ranges.size() - 1);
+	return laser_scan;
+}
+
+
+/** Rejects the measurements whose angle to a neighbor within the window, computed with atan2, is outside [min_angle, max_angle] */
+std::vector<bool> computeShadowReference(const sensor_msgs::LaserScan& laser_scan, double min_angle, double max_angle, int shadow_window) {
+	int number_of_measurements = (int)laser_scan.ranges.size();
+	std::vector<bool> rejected(number_of_measurements, false);
+	for (int i = 0; i < number_of_measurements; ++i) {
+		for (int j = std::max(i - shadow_window, 0); j <= std::min(i + shadow_window, number_of_measurements - 1); ++j) {
+			if (j == i) { continue; }
+			double r1 = laser_scan.ranges[i];
+			double r2 = laser_scan.ranges[j];
+			double k_angle = std::abs(j - i) * laser_scan.angle_increment;
+			double angle = std::atan2(r2 * std::sin(k_angle), r1 - r2 * std::cos(k_angle));
+			if (angle < min_angle || angle > max_angle) { rejected[i] = true; }
+		}
+	}
+	return rejected;
+}
+
+
+TEST(LaserScanPrefilter, RejectsShadowMeasurementsLikeAtan2Reference) {
+	sensor_msgs::LaserScan laser_scan = createDepthDiscontinuityLaserScan();
+	const double min_angle = 0.17, max_angle = 2.97;
+
+	for (int shadow_window = 1; shadow_window <= 3; ++shadow_window) {
+		LaserScanPrefilter prefilter;
+		prefilter.setShadowFilter(min_angle, max_angle, (size_t)shadow_window);
+		ASSERT_TRUE(prefilter.computeValidityMask(laser_scan));
+
+		std::vector<bool> reference_rejected = computeShadowReference(laser_scan, min_angle, max_angle, shadow_window);
+		size_t number_of_reference_rejections = 0;
+		for (size_t i = 0; i < laser_scan.ranges.size(); ++i) {
+			EXPECT_EQ(!reference_rejected[i], prefilter.isMeasurementValid(i)) << "measurement " << i << " with shadow window " << shadow_window;
+			if (reference_rejected[i]) { ++number_of_reference_rejections; }
+		}
+		EXPECT_EQ(number_of_reference_rejections, prefilter.getNumberOfRejectedMeasurements());
+		EXPECT_FALSE(prefilter.isMeasurementValid(39)); // veiling points between the box and the wall
+		EXPECT_FALSE(prefilter.isMeasurementValid(60));
+		EXPECT_TRUE(prefilter.isMeasurementValid(20)); // wall and box surfaces
+		EXPECT_TRUE(prefilter.isMeasurementValid(50));
+	}
+}
+
+
+TEST(LaserScanPrefilter, RejectsMedianOutliers) {
+	sensor_msgs::LaserScan laser_scan;
+	laser_scan.angle_increment = 0.01f;
+	laser_scan.ranges.resize(30, 2.0f);
+	laser_scan.ranges[10] = 5.0f;
+	laser_scan.ranges[11] = 2.05f;
+	laser_scan.ranges[20] = std::numeric_limits<float>::quiet_NaN();
+	laser_scan.ranges[21] = 2.5f;
+
+	LaserScanPrefilter prefilter;
+	prefilter.setMedianFilter(2, 0.1);
+	ASSERT_TRUE(prefilter.computeValidityMask(laser_scan));
+	EXPECT_FALSE(prefilter.isMeasurementValid(10));
+	EXPECT_TRUE(prefilter.isMeasurementValid(11)); // within the max range difference
+	EXPECT_TRUE(prefilter.isMeasurementValid(20)); // non finite ranges are left to remove_invalid_measurements
+	EXPECT_FALSE(prefilter.isMeasurementValid(21)); // the median ignores the NaN neighbor
+	EXPECT_EQ(2u, prefilter.getNumberOfRejectedMeasurements());
+}
+
+
+TEST(LaserScanPrefilter, RejectsMeasurementsOutsideIntensityThresholds) {
+	sensor_msgs::LaserScan laser_scan;
+	laser_scan.angle_increment = 0.01f;
+	laser_scan.ranges.resize(5, 2.0f);
+	float intensities[] = { 5.0f, 10.0f, 50.0f, 100.0f, 150.0f };
+	laser_scan.intensities.assign(intensities, intensities + 5);
+
+	LaserScanPrefilter prefilter;
+	EXPECT_FALSE(prefilter.computeValidityMask(laser_scan)); // no filter enabled
+
+	prefilter.setIntensityThresholds(10.0, 100.0);
+	ASSERT_TRUE(prefilter.computeValidityMask(laser_scan));
+	EXPECT_FALSE(prefilter.isMeasurementValid(0));
+	EXPECT_TRUE(prefilter.isMeasurementValid(1));
+	EXPECT_TRUE(prefilter.isMeasurementValid(2));
+	EXPECT_TRUE(prefilter.isMeasurementValid(3));
+	EXPECT_FALSE(prefilter.isMeasurementValid(4));
+
+	prefilter.setIntensityThresholds(10.0, 0.0); // disabled max threshold
+	ASSERT_TRUE(prefilter.computeValidityMask(laser_scan));
+	EXPECT_EQ(1u, prefilter.getNumberOfRejectedMeasurements());
+	EXPECT_TRUE(prefilter.isMeasurementValid(4));
+
+	laser_scan.intensities.clear(); // LaserScans without intensities are not filtered by intensity
+	ASSERT_TRUE(prefilter.computeValidityMask(laser_scan));
+	EXPECT_EQ(0u, prefilter.getNumberOfRejectedMeasurements());
+}
+
+
+int main(int argc, char** argv) {
+	testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
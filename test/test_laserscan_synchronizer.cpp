@@ -0,0 +1,85 @@
+/**\file test_laserscan_synchronizer.cpp
+ * \brief Tests of the approximate time synchronizer of LaserScans.
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+#include <gtest/gtest.h>
+#include <laserscan_to_pointcloud/laserscan_synchronizer.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+using laserscan_to_pointcloud::LaserScanSynchronizer;
+
+sensor_msgs::LaserScanConstPtr createLaserScan(double stamp) {
+	sensor_msgs::LaserScanPtr laser_scan(new sensor_msgs::LaserScan());
+	laser_scan->header.stamp.fromSec(stamp);
+	return laser_scan;
+}
+
+
+TEST(LaserScanSynchronizer, CompletesGroupWithinMaxTimeSkew) {
+	LaserScanSynchronizer synchronizer(2, 0.1);
+	EXPECT_FALSE(synchronizer.addLaserScan(0, createLaserScan(10.0)));
+	EXPECT_TRUE(synchronizer.addLaserScan(1, createLaserScan(10.05)));
+	EXPECT_EQ(2u, synchronizer.getNumberOfFilledSlots());
+	EXPECT_EQ(0u, synchronizer.getTotalNumberOfDroppedLaserScans());
+
+	synchronizer.clearSynchronizedLaserScans();
+	EXPECT_EQ(0u, synchronizer.getNumberOfFilledSlots());
+}
+
+
+TEST(LaserScanSynchronizer, DropsOlderScansWhenNewerScanArrives) {
+	LaserScanSynchronizer synchronizer(2, 0.1);
+	EXPECT_FALSE(synchronizer.addLaserScan(0, createLaserScan(9.0)));
+	EXPECT_FALSE(synchronizer.addLaserScan(1, createLaserScan(10.0)));
+	EXPECT_EQ(1u, synchronizer.getNumberOfFilledSlots());
+	EXPECT_EQ(1u, synchronizer.getNumberOfDroppedLaserScans(0));
+	EXPECT_TRUE(synchronizer.addLaserScan(0, createLaserScan(10.02)));
+}
+
+
+TEST(LaserScanSynchronizer, DropsOutOfOrderScansOlderThanMaxTimeSkew) {
+	LaserScanSynchronizer synchronizer(2, 0.1);
+	EXPECT_FALSE(synchronizer.addLaserScan(0, createLaserScan(10.0)));
+	EXPECT_FALSE(synchronizer.addLaserScan(1, createLaserScan(9.0))); // arrives later but 1 s older than the scan waiting in the other slot
+	EXPECT_EQ(1u, synchronizer.getNumberOfFilledSlots());
+	EXPECT_EQ(1u, synchronizer.getNumberOfDroppedLaserScans(1));
+	EXPECT_EQ(0u, synchronizer.getNumberOfDroppedLaserScans(0));
+	EXPECT_TRUE(synchronizer.addLaserScan(1, createLaserScan(9.95)));
+}
+
+
+TEST(LaserScanSynchronizer, ReplacesScanOfSameTopic) {
+	LaserScanSynchronizer synchronizer(3, 0.1);
+	EXPECT_FALSE(synchronizer.addLaserScan(0, createLaserScan(10.0)));
+	EXPECT_FALSE(synchronizer.addLaserScan(0, createLaserScan(10.01)));
+	EXPECT_EQ(1u, synchronizer.getNumberOfFilledSlots());
+	EXPECT_EQ(1u, synchronizer.getNumberOfDroppedLaserScans(0));
+	EXPECT_FALSE(synchronizer.addLaserScan(5, createLaserScan(10.0)));
+	EXPECT_FALSE(synchronizer.addLaserScan(1, createLaserScan(10.02)));
+	EXPECT_TRUE(synchronizer.addLaserScan(2, createLaserScan(10.03)));
+	EXPECT_NEAR(10.01, synchronizer.getSynchronizedLaserScans()[0]->header.stamp.toSec(), 1e-6);
+}
+
+
+TEST(LaserScanSynchronizer, KeepsNewerScanOfSameTopic) {
+	LaserScanSynchronizer synchronizer(3, 0.1);
+	EXPECT_FALSE(synchronizer.addLaserScan(0, createLaserScan(10.0)));
+	EXPECT_FALSE(synchronizer.addLaserScan(0, createLaserScan(9.5))); // out of order scan of the same topic
+	EXPECT_EQ(1u, synchronizer.getNumberOfFilledSlots());
+	EXPECT_EQ(1u, synchronizer.getNumberOfDroppedLaserScans(0));
+	EXPECT_FALSE(synchronizer.addLaserScan(1, createLaserScan(10.02)));
+	EXPECT_TRUE(synchronizer.addLaserScan(2, createLaserScan(10.03)));
+	EXPECT_NEAR(10.0, synchronizer.getSynchronizedLaserScans()[0]->header.stamp.toSec(), 1e-6);
+	EXPECT_EQ(1u, synchronizer.getTotalNumberOfDroppedLaserScans());
+}
+
+
+int main(int argc, char** argv) {
+	testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,99 @@
+/**\file test_multi_echo_laserscan_selector.cpp
+ * \brief Tests of the selection of the echoes of MultiEchoLaserScans.
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+#include <gtest/gtest.h>
+#include <laserscan_to_pointcloud/multi_echo_laserscan_selector.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+using laserscan_to_pointcloud::MultiEchoLaserScanSelector;
+
+void addBeam(sensor_msgs::MultiEchoLaserScan& multi_echo_laser_scan, const std::vector<float>& ranges, const std::vector<float>& intensities) {
+	sensor_msgs::LaserEcho range_echoes, intensity_echoes;
+	range_echoes.echoes = ranges;
+	intensity_echoes.echoes = intensities;
+	multi_echo_laser_scan.ranges.push_back(range_echoes);
+	multi_echo_laser_scan.intensities.push_back(intensity_echoes);
+}
+
+
+std::vector<float> createEchoes(float first, float second, float third) {
+	std::vector<float> echoes;
+	echoes.push_back(first);
+	echoes.push_back(second);
+	echoes.push_back(third);
+	return echoes;
+}
+
+
+/** Beam 0: three valid echoes (strongest is the second) | beam 1: first echo below range_min | beam 2: no valid echoes */
+sensor_msgs::MultiEchoLaserScan createMultiEchoLaserScan() {
+	sensor_msgs::MultiEchoLaserScan multi_echo_laser_scan;
+	multi_echo_laser_scan.angle_min = -0.1f;
+	multi_echo_laser_scan.angle_max = 0.1f;
+	multi_echo_laser_scan.angle_increment = 0.1f;
+	multi_echo_laser_scan.range_min = 0.1f;
+	multi_echo_laser_scan.range_max = 10.0f;
+	float nan = std::numeric_limits<float>::quiet_NaN();
+	addBeam(multi_echo_laser_scan, createEchoes(1.0f, 2.0f, 3.0f), createEchoes(10.0f, 50.0f, 20.0f));
+	addBeam(multi_echo_laser_scan, createEchoes(0.01f, 4.0f, nan), createEchoes(90.0f, 30.0f, 0.0f));
+	addBeam(multi_echo_laser_scan, createEchoes(nan, 20.0f, 0.0f), createEchoes(0.0f, 0.0f, 0.0f));
+	return multi_echo_laser_scan;
+}
+
+
+TEST(MultiEchoLaserScanSelector, SelectsEchoesWithPolicy) {
+	sensor_msgs::MultiEchoLaserScan multi_echo_laser_scan = createMultiEchoLaserScan();
+	MultiEchoLaserScanSelector selector;
+
+	selector.setEchoPolicy(MultiEchoLaserScanSelector::ECHO_POLICY_FIRST);
+	sensor_msgs::LaserScanConstPtr laser_scan = selector.selectEchoes(multi_echo_laser_scan);
+	ASSERT_EQ(3u, laser_scan->ranges.size());
+	EXPECT_EQ(1.0f, laser_scan->ranges[0]);
+	EXPECT_EQ(4.0f, laser_scan->ranges[1]);
+	EXPECT_EQ(30.0f, laser_scan->intensities[1]);
+	EXPECT_EQ(1, selector.getSelectedEchoIndex(1));
+	EXPECT_FALSE(selector.isEchoValid(laser_scan->ranges[2])); // rejected later by the projection
+	EXPECT_EQ(0u, selector.getNumberOfAdditionalEchoes());
+
+	selector.setEchoPolicy(MultiEchoLaserScanSelector::ECHO_POLICY_LAST);
+	laser_scan = selector.selectEchoes(multi_echo_laser_scan);
+	EXPECT_EQ(3.0f, laser_scan->ranges[0]);
+	EXPECT_EQ(4.0f, laser_scan->ranges[1]);
+
+	selector.setEchoPolicy(MultiEchoLaserScanSelector::ECHO_POLICY_STRONGEST);
+	laser_scan = selector.selectEchoes(multi_echo_laser_scan);
+	EXPECT_EQ(2.0f, laser_scan->ranges[0]);
+	EXPECT_EQ(50.0f, laser_scan->intensities[0]);
+	EXPECT_EQ(4.0f, laser_scan->ranges[1]);
+}
+
+
+TEST(MultiEchoLaserScanSelector, CountsAdditionalEchoesWhenProjectingAll) {
+	sensor_msgs::MultiEchoLaserScan multi_echo_laser_scan = createMultiEchoLaserScan();
+	MultiEchoLaserScanSelector selector;
+	selector.setEchoPolicy(MultiEchoLaserScanSelector::ECHO_POLICY_ALL);
+	sensor_msgs::LaserScanConstPtr laser_scan = selector.selectEchoes(multi_echo_laser_scan);
+	EXPECT_TRUE(selector.isProjectingAllEchoes());
+	EXPECT_EQ(1.0f, laser_scan->ranges[0]);
+	EXPECT_EQ(2u, selector.getNumberOfAdditionalEchoes());
+}
+
+
+TEST(MultiEchoLaserScanSelector, ParsesEchoPolicy) {
+	MultiEchoLaserScanSelector::EchoPolicy echo_policy;
+	EXPECT_TRUE(MultiEchoLaserScanSelector::parseEchoPolicy("strongest", echo_policy));
+	EXPECT_EQ(MultiEchoLaserScanSelector::ECHO_POLICY_STRONGEST, echo_policy);
+	EXPECT_FALSE(MultiEchoLaserScanSelector::parseEchoPolicy("second", echo_policy));
+}
+
+
+int main(int argc, char** argv) {
+	testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,144 @@
+/**\file test_pointcloud2_wire_buffer.cpp
+ * \brief Tests of the PointCloud2 messages built directly in serialization buffers.
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+#include <gtest/gtest.h>
+#include <cstring>
+#include <laserscan_to_pointcloud/pointcloud2_wire_buffer.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+using laserscan_to_pointcloud::PointCloud2WireBuffer;
+using laserscan_to_pointcloud::PointCloud2WireMessage;
+
+void addField(sensor_msgs::PointCloud2& pointcloud, const std::string& name, uint32_t offset, uint8_t datatype) {
+	sensor_msgs::PointField field;
+	field.name = name;
+	field.offset = offset;
+	field.datatype = datatype;
+	field.count = 1;
+	pointcloud.fields.push_back(field);
+}
+
+
+sensor_msgs::PointCloud2 createPointCloud(uint32_t number_of_points) {
+	sensor_msgs::PointCloud2 pointcloud;
+	pointcloud.header.seq = 7;
+	pointcloud.header.frame_id = "odom";
+	addField(pointcloud, "x", 0, sensor_msgs::PointField::FLOAT32);
+	addField(pointcloud, "y", 4, sensor_msgs::PointField::FLOAT32);
+	addField(pointcloud, "z", 8, sensor_msgs::PointField::FLOAT32);
+	addField(pointcloud, "intensity", 12, sensor_msgs::PointField::UINT16);
+	pointcloud.is_bigendian = false;
+	pointcloud.point_step = 14;
+	pointcloud.height = 1;
+	pointcloud.width = number_of_points;
+	pointcloud.row_step = number_of_points * pointcloud.point_step;
+	pointcloud.data.resize(pointcloud.row_step);
+	for (size_t i = 0; i < pointcloud.data.size(); ++i) {
+		pointcloud.data[i] = (uint8_t)(i * 31 + 5);
+	}
+	pointcloud.is_dense = true;
+	return pointcloud;
+}
+
+
+sensor_msgs::PointCloud2 deserializeWireMessage(const PointCloud2WireMessage& message) {
+	uint32_t message_length;
+	memcpy(&message_length, message.buffer_.get(), 4);
+	EXPECT_EQ(message.serialized_length_, message_length);
+
+	sensor_msgs::PointCloud2 pointcloud;
+	ros::serialization::IStream stream(message.buffer_.get() + 4, message.serialized_length_);
+	ros::serialization::deserialize(stream, pointcloud);
+	EXPECT_EQ(0u, stream.getLength());
+	return pointcloud;
+}
+
+
+TEST(PointCloud2WireBuffer, DeserializesAsTheSourcePointCloud) {
+	sensor_msgs::PointCloud2 source_pointcloud = createPointCloud(40);
+	sensor_msgs::PointCloud2 empty_pointcloud = source_pointcloud; // the assembler begins the cloud before knowing its size
+	empty_pointcloud.width = 0;
+	empty_pointcloud.row_step = 0;
+	empty_pointcloud.data.clear();
+
+	PointCloud2WireBuffer wire_buffer;
+	wire_buffer.beginPointCloud(empty_pointcloud, 2 * source_pointcloud.point_step);
+	const uint8_t* reserved_buffer = wire_buffer.getMessage().buffer_.get();
+
+	// the points are written in two steps and the second one reallocates the buffer (keeping the first points)
+	size_t first_points_size = 2 * source_pointcloud.point_step;
+	memcpy(wire_buffer.growData(first_points_size), &source_pointcloud.data[0], first_points_size);
+	uint8_t* data = wire_buffer.growData(source_pointcloud.data.size());
+	EXPECT_NE(reserved_buffer, wire_buffer.getMessage().buffer_.get());
+	memcpy(data + first_points_size, &source_pointcloud.data[first_points_size], source_pointcloud.data.size() - first_points_size);
+
+	source_pointcloud.header.stamp.fromSec(123.25);
+	wire_buffer.finishPointCloud(source_pointcloud, source_pointcloud.data.size());
+
+	const PointCloud2WireMessage& message = wire_buffer.getMessage();
+	EXPECT_EQ(0, memcmp(message.buffer_.get() + message.data_offset_, &source_pointcloud.data[0], source_pointcloud.data.size()));
+
+	sensor_msgs::PointCloud2 pointcloud = deserializeWireMessage(message);
+	EXPECT_EQ(source_pointcloud.header.seq, pointcloud.header.seq);
+	EXPECT_EQ(source_pointcloud.header.stamp.sec, pointcloud.header.stamp.sec);
+	EXPECT_EQ(source_pointcloud.header.stamp.nsec, pointcloud.header.stamp.nsec);
+	EXPECT_EQ(source_pointcloud.header.frame_id, pointcloud.header.frame_id);
+	EXPECT_EQ(source_pointcloud.height, pointcloud.height);
+	EXPECT_EQ(source_pointcloud.width, pointcloud.width);
+	ASSERT_EQ(source_pointcloud.fields.size(), pointcloud.fields.size());
+	for (size_t i = 0; i < pointcloud.fields.size(); ++i) {
+		EXPECT_EQ(source_pointcloud.fields[i].name, pointcloud.fields[i].name);
+		EXPECT_EQ(source_pointcloud.fields[i].offset, pointcloud.fields[i].offset);
+		EXPECT_EQ(source_pointcloud.fields[i].datatype, pointcloud.fields[i].datatype);
+		EXPECT_EQ(source_pointcloud.fields[i].count, pointcloud.fields[i].count);
+	}
+	EXPECT_EQ(source_pointcloud.is_bigendian, pointcloud.is_bigendian);
+	EXPECT_EQ(source_pointcloud.point_step, pointcloud.point_step);
+	EXPECT_EQ(source_pointcloud.row_step, pointcloud.row_step);
+	EXPECT_TRUE(source_pointcloud.data == pointcloud.data);
+	EXPECT_EQ(source_pointcloud.is_dense, pointcloud.is_dense);
+}
+
+
+TEST(PointCloud2WireBuffer, ReusesOnlyReleasedBuffers) {
+	sensor_msgs::PointCloud2 source_pointcloud = createPointCloud(4);
+	PointCloud2WireBuffer wire_buffer(1);
+
+	wire_buffer.beginPointCloud(source_pointcloud, source_pointcloud.data.size());
+	memcpy(wire_buffer.growData(source_pointcloud.data.size()), &source_pointcloud.data[0], source_pointcloud.data.size());
+	wire_buffer.finishPointCloud(source_pointcloud, source_pointcloud.data.size());
+	boost::shared_array<uint8_t> published_buffer = wire_buffer.getMessage().buffer_; // still in a publisher queue
+
+	sensor_msgs::PointCloud2 next_pointcloud = createPointCloud(2);
+	wire_buffer.beginPointCloud(next_pointcloud, next_pointcloud.data.size());
+	EXPECT_NE(published_buffer.get(), wire_buffer.getMessage().buffer_.get());
+	EXPECT_EQ(1u, wire_buffer.getNumberOfUnpooledAllocations());
+	memcpy(wire_buffer.growData(next_pointcloud.data.size()), &next_pointcloud.data[0], next_pointcloud.data.size());
+	wire_buffer.finishPointCloud(next_pointcloud, next_pointcloud.data.size());
+
+	// the published message was not changed by the next cloud
+	PointCloud2WireMessage published_message;
+	published_message.buffer_ = published_buffer;
+	memcpy(&published_message.serialized_length_, published_buffer.get(), 4);
+	EXPECT_TRUE(source_pointcloud.data == deserializeWireMessage(published_message).data);
+	EXPECT_TRUE(next_pointcloud.data == deserializeWireMessage(wire_buffer.getMessage()).data);
+
+	const uint8_t* released_buffer = published_buffer.get();
+	published_buffer.reset();
+	published_message.buffer_.reset();
+	wire_buffer.beginPointCloud(next_pointcloud, next_pointcloud.data.size());
+	EXPECT_EQ(released_buffer, wire_buffer.getMessage().buffer_.get());
+	EXPECT_EQ(1u, wire_buffer.getNumberOfUnpooledAllocations());
+}
+
+
+int main(int argc, char** argv) {
+	testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
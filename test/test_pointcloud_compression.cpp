@@ -0,0 +1,141 @@
+/**\file test_pointcloud_compression.cpp
+ * \brief Tests of the compression and decompression of clouds.
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+#include <gtest/gtest.h>
+#include <laserscan_to_pointcloud/pointcloud_compression.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+using laserscan_to_pointcloud::CompressedPointCloud;
+using laserscan_to_pointcloud::PointCloudCompressor;
+using laserscan_to_pointcloud::PointCloudDecompressor;
+
+void addFloat32Field(sensor_msgs::PointCloud2& pointcloud, const std::string& name) {
+	sensor_msgs::PointField field;
+	field.name = name;
+	field.offset = pointcloud.point_step;
+	field.datatype = sensor_msgs::PointField::FLOAT32;
+	field.count = 1;
+	pointcloud.fields.push_back(field);
+	pointcloud.point_step += sizeof(float);
+}
+
+
+/** Organized cloud with x, y, z, intensity and a padding field, with invalid points at the start, in the middle and at the end */
+sensor_msgs::PointCloud2 createOrganizedPointCloud(size_t height, size_t width) {
+	sensor_msgs::PointCloud2 pointcloud;
+	pointcloud.height = (uint32_t)height;
+	pointcloud.width = (uint32_t)width;
+	pointcloud.point_step = 0;
+	addFloat32Field(pointcloud, "x");
+	addFloat32Field(pointcloud, "y");
+	addFloat32Field(pointcloud, "z");
+	addFloat32Field(pointcloud, "intensity");
+	addFloat32Field(pointcloud, "range"); // not kept in the compressed cloud
+	pointcloud.row_step = pointcloud.width * pointcloud.point_step;
+	pointcloud.is_bigendian = false;
+	pointcloud.is_dense = false;
+
+	size_t number_of_points = height * width;
+	pointcloud.data.resize(number_of_points * pointcloud.point_step);
+	for (size_t i = 0; i < number_of_points; ++i) {
+		bool valid = (i >= 3 && (i < 10 || i > 14) && i + 1 < number_of_points);
+		float nan = std::numeric_limits<float>::quiet_NaN();
+		float values[5] = { nan, nan, nan, nan, nan };
+		if (valid) {
+			values[0] = 1.0f + 0.0123f * (float)i;
+			values[1] = -2.0f + 0.0456f * (float)i;
+			values[2] = 0.5f - 0.001f * (float)i;
+			values[3] = 100.0f + (float)i;
+			values[4] = 3.0f;
+		}
+		memcpy(&pointcloud.data[i * pointcloud.point_step], values, sizeof(values));
+	}
+	return pointcloud;
+}
+
+
+void expectRoundTrip(int compression_level) {
+	sensor_msgs::PointCloud2 pointcloud = createOrganizedPointCloud(4, 8);
+	PointCloudCompressor compressor;
+	compressor.setPositionResolution(0.001);
+	compressor.setIntensityResolution(1.0);
+	compressor.setCompressionLevel(compression_level);
+
+	CompressedPointCloud compressed_pointcloud;
+	ASSERT_TRUE(compressor.compress(pointcloud, compressed_pointcloud));
+	EXPECT_EQ(compression_level > 0 ? std::string("zlib") : std::string("none"), compressed_pointcloud.compression);
+	EXPECT_EQ(23u, compressed_pointcloud.number_of_valid_points);
+
+	PointCloudDecompressor decompressor;
+	sensor_msgs::PointCloud2 decompressed_pointcloud;
+	ASSERT_TRUE(decompressor.decompress(compressed_pointcloud, decompressed_pointcloud));
+	ASSERT_EQ(pointcloud.height, decompressed_pointcloud.height);
+	ASSERT_EQ(pointcloud.width, decompressed_pointcloud.width);
+	ASSERT_EQ(4u, decompressed_pointcloud.fields.size());
+	EXPECT_FALSE(decompressed_pointcloud.is_dense);
+
+	for (size_t i = 0; i < (size_t)pointcloud.height * pointcloud.width; ++i) {
+		float original_values[4], decompressed_values[4];
+		memcpy(original_values, &pointcloud.data[i * pointcloud.point_step], sizeof(original_values));
+		memcpy(decompressed_values, &decompressed_pointcloud.data[i * decompressed_pointcloud.point_step], sizeof(decompressed_values));
+		if (std::isnan(original_values[0])) {
+			EXPECT_TRUE(std::isnan(decompressed_values[0]) && std::isnan(decompressed_values[1]) && std::isnan(decompressed_values[2])) << "point " << i;
+		} else {
+			for (int axis = 0; axis < 3; ++axis) {
+				EXPECT_NEAR(original_values[axis], decompressed_values[axis], 0.0005 + 1e-6) << "point " << i;
+			}
+			EXPECT_NEAR(original_values[3], decompressed_values[3], 0.5) << "point " << i;
+		}
+	}
+}
+
+
+TEST(PointCloudCompression, RoundTripWithZlib) {
+	expectRoundTrip(1);
+}
+
+
+TEST(PointCloudCompression, RoundTripWithoutZlib) {
+	expectRoundTrip(0);
+}
+
+
+TEST(PointCloudCompression, RejectsCorruptedData) {
+	sensor_msgs::PointCloud2 pointcloud = createOrganizedPointCloud(2, 16);
+	PointCloudCompressor compressor;
+	compressor.setCompressionLevel(0);
+	CompressedPointCloud compressed_pointcloud;
+	ASSERT_TRUE(compressor.compress(pointcloud, compressed_pointcloud));
+
+	compressed_pointcloud.data.resize(compressed_pointcloud.data.size() / 2);
+	PointCloudDecompressor decompressor;
+	sensor_msgs::PointCloud2 decompressed_pointcloud;
+	EXPECT_FALSE(decompressor.decompress(compressed_pointcloud, decompressed_pointcloud));
+
+	compressed_pointcloud.compression = "unknown";
+	EXPECT_FALSE(decompressor.decompress(compressed_pointcloud, decompressed_pointcloud));
+}
+
+
+TEST(PointCloudCompression, RejectsCloudsWithoutPositions) {
+	sensor_msgs::PointCloud2 pointcloud;
+	pointcloud.height = 1;
+	pointcloud.width = 0;
+	pointcloud.point_step = 0;
+	addFloat32Field(pointcloud, "intensity");
+	PointCloudCompressor compressor;
+	CompressedPointCloud compressed_pointcloud;
+	EXPECT_FALSE(compressor.compress(pointcloud, compressed_pointcloud));
+}
+
+
+int main(int argc, char** argv) {
+	testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,189 @@
+/**\file test_pointcloud_layout.cpp
+ * \brief Tests of the fields and writers of the point layouts.
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+#include <gtest/gtest.h>
+#include <laserscan_to_pointcloud/pointcloud_layout.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+using laserscan_to_pointcloud::PointCloudLayout;
+
+template <typename T>
+T readValue(const std::vector<uint8_t>& data, size_t offset) {
+	T value;
+	memcpy(&value, &data[offset], sizeof(T));
+	return value;
+}
+
+
+const sensor_msgs::PointField* findField(const PointCloudLayout& layout, const std::string& name) {
+	for (size_t i = 0; i < layout.getFields().size(); ++i) {
+		if (layout.getFields()[i].name == name) { return &layout.getFields()[i]; }
+	}
+	return NULL;
+}
+
+
+TEST(PointCloudLayout, WritesFloat32Points) {
+	PointCloudLayout layout;
+	layout.updateFields(true, false);
+	ASSERT_EQ(16u, layout.getPointStep());
+	ASSERT_EQ(4u, layout.getFields().size());
+
+	std::vector<uint8_t> data(layout.getPointStep());
+	EXPECT_TRUE(layout.writePoint(&data[0], 1.5f, -2.5f, 3.25f, 42.0f));
+	EXPECT_EQ(1.5f, readValue<float>(data, 0));
+	EXPECT_EQ(-2.5f, readValue<float>(data, 4));
+	EXPECT_EQ(3.25f, readValue<float>(data, 8));
+	EXPECT_EQ(42.0f, readValue<float>(data, findField(layout, "intensity")->offset));
+
+	layout.writeInvalidPoint(&data[0]);
+	EXPECT_TRUE(std::isnan(readValue<float>(data, 0)));
+	EXPECT_TRUE(std::isnan(readValue<float>(data, 12)));
+}
+
+
+TEST(PointCloudLayout, QuantizesInt16PositionsAndIntegerIntensities) {
+	PointCloudLayout layout;
+	layout.setPositionEncoding(PointCloudLayout::POSITION_INT16, 0.01, tf2::Vector3(1.0, 0.0, 0.0));
+	layout.setIntensityEncoding(PointCloudLayout::INTENSITY_UINT8, 0.5);
+	layout.updateFields(true, false);
+	ASSERT_EQ(7u, layout.getPointStep());
+	EXPECT_EQ(sensor_msgs::PointField::INT16, findField(layout, "x")->datatype);
+	EXPECT_EQ(sensor_msgs::PointField::UINT8, findField(layout, "intensity")->datatype);
+
+	std::vector<uint8_t> data(layout.getPointStep());
+	EXPECT_TRUE(layout.writePoint(&data[0], 1.5f, -0.254f, 0.0f, 100.0f));
+	EXPECT_EQ(50, readValue<int16_t>(data, 0));
+	EXPECT_EQ(-25, readValue<int16_t>(data, 2));
+	EXPECT_EQ(0, readValue<int16_t>(data, 4));
+	EXPECT_EQ(50, data[6]);
+
+	EXPECT_TRUE(layout.writePoint(&data[0], 1.0f, 0.0f, 0.0f, 1000.0f));
+	EXPECT_EQ(255, data[6]); // clamped
+
+	EXPECT_FALSE(layout.writePoint(&data[0], 400.0f, 0.0f, 0.0f, 1.0f)); // outside of +- 32767 * resolution
+	EXPECT_FALSE(layout.writePoint(&data[0], std::numeric_limits<float>::quiet_NaN(), 0.0f, 0.0f, 1.0f));
+
+	layout.writeInvalidPoint(&data[0]);
+	EXPECT_EQ(std::numeric_limits<int16_t>::min(), readValue<int16_t>(data, 0));
+	EXPECT_EQ(0, data[6]);
+}
+
+
+TEST(PointCloudLayout, WritesExtraFields) {
+	PointCloudLayout layout;
+	int extra_fields = 0;
+	ASSERT_TRUE(PointCloudLayout::parseExtraFields("time+beam+ring+range+echo", extra_fields));
+	layout.updateFields(false, true, extra_fields);
+	ASSERT_EQ(12u + 4u + 4u + 2u + 4u + 1u + 4u, layout.getPointStep());
+	EXPECT_TRUE(layout.hasTimeField());
+
+	PointCloudLayout::PointExtraFields point_extra_fields;
+	point_extra_fields.laser_scan_time_offset = 0.5;
+	point_extra_fields.time_increment = 0.000001;
+	point_extra_fields.beam_index = 70000; // beyond the uint16 range
+	point_extra_fields.ring = 3;
+	point_extra_fields.range = 7.5f;
+	point_extra_fields.echo = 2;
+
+	std::vector<uint8_t> data(layout.getPointStep());
+	layout.writeExtraFields(&data[0], point_extra_fields);
+	layout.writeCount(&data[0], 9);
+	EXPECT_FLOAT_EQ(0.57f, readValue<float>(data, findField(layout, "time")->offset));
+	EXPECT_EQ(70000u, readValue<uint32_t>(data, findField(layout, "beam")->offset));
+	EXPECT_EQ(3, readValue<uint16_t>(data, findField(layout, "ring")->offset));
+	EXPECT_EQ(7.5f, readValue<float>(data, findField(layout, "range")->offset));
+	EXPECT_EQ(2, data[findField(layout, "echo")->offset]);
+	EXPECT_EQ(9u, readValue<uint32_t>(data, findField(layout, "count")->offset));
+
+	layout.writeInvalidPoint(&data[0]);
+	EXPECT_EQ(0u, readValue<uint32_t>(data, findField(layout, "beam")->offset));
+	EXPECT_TRUE(std::isnan(readValue<float>(data, findField(layout, "range")->offset)));
+}
+
+
+TEST(PointCloudLayout, WritesTimeInMicroseconds) {
+	PointCloudLayout layout;
+	layout.updateFields(false, false, PointCloudLayout::EXTRA_FIELD_TIME_MICROSECONDS);
+	ASSERT_EQ(16u, layout.getPointStep());
+	EXPECT_EQ(sensor_msgs::PointField::UINT32, findField(layout, "time_us")->datatype);
+
+	PointCloudLayout::PointExtraFields point_extra_fields;
+	point_extra_fields.laser_scan_time_offset = 0.25;
+	point_extra_fields.time_increment = 0.0001;
+	point_extra_fields.beam_index = 5;
+	std::vector<uint8_t> data(layout.getPointStep());
+	layout.writeExtraFields(&data[0], point_extra_fields);
+	EXPECT_EQ(250500u, readValue<uint32_t>(data, 12));
+}
+
+
+TEST(PointCloudLayout, ParsesEncodingsAndExtraFields) {
+	PointCloudLayout::PositionEncoding position_encoding;
+	EXPECT_TRUE(PointCloudLayout::parsePositionEncoding("int16", position_encoding));
+	EXPECT_EQ(PointCloudLayout::POSITION_INT16, position_encoding);
+	EXPECT_FALSE(PointCloudLayout::parsePositionEncoding("double", position_encoding));
+
+	PointCloudLayout::IntensityEncoding intensity_encoding;
+	EXPECT_TRUE(PointCloudLayout::parseIntensityEncoding("uint16", intensity_encoding));
+	EXPECT_EQ(PointCloudLayout::INTENSITY_UINT16, intensity_encoding);
+
+	int extra_fields = 0;
+	EXPECT_TRUE(PointCloudLayout::parseExtraFields("", extra_fields));
+	EXPECT_EQ(0, extra_fields);
+	EXPECT_TRUE(PointCloudLayout::parseExtraFields("time_us+range", extra_fields));
+	EXPECT_EQ(PointCloudLayout::EXTRA_FIELD_TIME_MICROSECONDS | PointCloudLayout::EXTRA_FIELD_RANGE, extra_fields);
+	EXPECT_FALSE(PointCloudLayout::parseExtraFields("time+color", extra_fields));
+}
+
+
+TEST(PointCloudLayout, MatchesOnlyItsOwnFields) {
+	PointCloudLayout layout;
+	layout.updateFields(true, false);
+	std::vector<sensor_msgs::PointField> fields = layout.getFields();
+	EXPECT_TRUE(layout.matchesFields(fields));
+	fields[3].datatype = sensor_msgs::PointField::UINT16;
+	EXPECT_FALSE(layout.matchesFields(fields));
+}
+
+
+void expectTransformedPositions(uint32_t point_step, size_t data_offset) {
+	const size_t number_of_points = 5;
+	std::vector<uint8_t> data(data_offset + number_of_points * point_step, 7);
+	for (size_t i = 0; i < number_of_points; ++i) {
+		float position[3] = { (float)i, 1.0f, 2.0f };
+		memcpy(&data[data_offset + i * point_step], position, sizeof(position));
+	}
+
+	tf2::Transform transform(tf2::Matrix3x3(0, -1, 0, 1, 0, 0, 0, 0, 1), tf2::Vector3(10.0, 20.0, 30.0)); // 90 degrees around z
+	PointCloudLayout::transformFloat32Positions(&data[data_offset], number_of_points, point_step, transform);
+
+	for (size_t i = 0; i < number_of_points; ++i) {
+		size_t offset = data_offset + i * point_step;
+		EXPECT_FLOAT_EQ(9.0f, readValue<float>(data, offset));
+		EXPECT_FLOAT_EQ(20.0f + (float)i, readValue<float>(data, offset + 4));
+		EXPECT_FLOAT_EQ(32.0f, readValue<float>(data, offset + 8));
+		for (size_t byte = 12; byte < point_step; ++byte) {
+			EXPECT_EQ(7, data[offset + byte]); // other fields are kept
+		}
+	}
+}
+
+
+TEST(PointCloudLayout, TransformsFloat32Positions) {
+	expectTransformedPositions(16, 0);
+	expectTransformedPositions(19, 0);
+	expectTransformedPositions(16, 1);
+}
+
+
+int main(int argc, char** argv) {
+	testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,100 @@
+/**\file test_pointcloud_segment_ring.cpp
+ * \brief Tests of the ring of per scan segments of the sliding window clouds.
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+#include <gtest/gtest.h>
+#include <laserscan_to_pointcloud/pointcloud_segment_ring.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+using laserscan_to_pointcloud::PointCloudSegmentRing;
+
+/** Writes a segment with points [first_value, first_value + number_of_points) (one uint32 per point) */
+void addSegment(PointCloudSegmentRing& ring, double stamp, uint32_t first_value, size_t number_of_points) {
+	uint8_t* data = ring.beginSegment(number_of_points);
+	for (size_t i = 0; i < number_of_points; ++i) {
+		uint32_t value = first_value + (uint32_t)i;
+		memcpy(data + i * sizeof(uint32_t), &value, sizeof(uint32_t));
+	}
+	ring.commitSegment(ros::Time(stamp), number_of_points);
+}
+
+
+std::vector<uint32_t> copyPoints(const PointCloudSegmentRing& ring) {
+	std::vector<uint32_t> points(ring.getNumberOfPoints());
+	ring.copyPoints((uint8_t*)&points[0]);
+	return points;
+}
+
+
+void expectSequence(const std::vector<uint32_t>& points, uint32_t first_value) {
+	for (size_t i = 0; i < points.size(); ++i) {
+		EXPECT_EQ(first_value + i, points[i]);
+	}
+}
+
+
+TEST(PointCloudSegmentRing, EvictsOldestSegments) {
+	PointCloudSegmentRing ring(sizeof(uint32_t));
+	addSegment(ring, 1.0, 0, 10);
+	addSegment(ring, 2.0, 10, 10);
+	addSegment(ring, 3.0, 20, 10);
+	EXPECT_EQ(30u, ring.getNumberOfPoints());
+
+	EXPECT_EQ(2u, ring.evictSegmentsOlderThan(ros::Time(2.5)));
+	EXPECT_EQ(1u, ring.getNumberOfSegments());
+	EXPECT_EQ(10u, ring.getNumberOfPoints());
+	expectSequence(copyPoints(ring), 20);
+}
+
+
+TEST(PointCloudSegmentRing, WrapsAroundWithoutGrowing) {
+	PointCloudSegmentRing ring(sizeof(uint32_t));
+	addSegment(ring, 1.0, 0, 10);
+	addSegment(ring, 2.0, 10, 10);
+	addSegment(ring, 3.0, 20, 10);
+	size_t capacity = ring.getCapacityInBytes();
+
+	ring.evictSegmentsOlderThan(ros::Time(2.5));
+	addSegment(ring, 4.0, 30, 10);
+	addSegment(ring, 5.0, 40, 10); // reuses the memory of the evicted segments at the beginning of the buffer
+	EXPECT_EQ(capacity, ring.getCapacityInBytes());
+	EXPECT_LT(ring.getSegments().back().offset, ring.getSegments().front().offset);
+	expectSequence(copyPoints(ring), 20);
+}
+
+
+TEST(PointCloudSegmentRing, GrowsAndKeepsOrderOfWrappedSegments) {
+	PointCloudSegmentRing ring(sizeof(uint32_t));
+	addSegment(ring, 1.0, 0, 10);
+	addSegment(ring, 2.0, 10, 10);
+	addSegment(ring, 3.0, 20, 10);
+	ring.evictSegmentsOlderThan(ros::Time(1.5));
+	addSegment(ring, 4.0, 30, 5); // wrapped
+	addSegment(ring, 5.0, 35, 100); // does not fit -> linearized in a larger buffer
+
+	EXPECT_EQ(125u, ring.getNumberOfPoints());
+	EXPECT_EQ(0u, ring.getSegments().front().offset);
+	expectSequence(copyPoints(ring), 10);
+}
+
+
+TEST(PointCloudSegmentRing, IgnoresEmptySegments) {
+	PointCloudSegmentRing ring(sizeof(uint32_t));
+	addSegment(ring, 1.0, 0, 0);
+	EXPECT_EQ(0u, ring.getNumberOfSegments());
+
+	ring.clear(8);
+	EXPECT_EQ(8u, ring.getPointStep());
+	EXPECT_EQ(0u, ring.getNumberOfPoints());
+}
+
+
+int main(int argc, char** argv) {
+	testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
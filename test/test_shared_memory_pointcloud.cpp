@@ -0,0 +1,140 @@
+/**\file test_shared_memory_pointcloud.cpp
+ * \brief Tests of the clouds exchanged through a shared memory ring.
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <sstream>
+#include <laserscan_to_pointcloud/shared_memory_pointcloud.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+using laserscan_to_pointcloud::SharedMemoryPointCloud;
+using laserscan_to_pointcloud::SharedMemoryPointCloudPublisher;
+using laserscan_to_pointcloud::SharedMemoryPointCloudReader;
+
+/** Name unique to the test process, so that parallel test runs do not share rings */
+std::string createSharedMemoryName(const std::string& test_name) {
+	std::stringstream ss;
+	ss << "test_shared_memory_pointcloud_" << test_name << "_" << getpid();
+	return ss.str();
+}
+
+
+sensor_msgs::PointCloud2 createPointCloud(uint32_t number_of_points, uint8_t first_byte) {
+	sensor_msgs::PointCloud2 pointcloud;
+	pointcloud.header.seq = number_of_points;
+	pointcloud.header.stamp.fromSec(100.5);
+	pointcloud.header.frame_id = "odom";
+	sensor_msgs::PointField field;
+	field.name = "x";
+	field.offset = 0;
+	field.datatype = sensor_msgs::PointField::FLOAT32;
+	field.count = 1;
+	pointcloud.fields.push_back(field);
+	pointcloud.point_step = 4;
+	pointcloud.height = 1;
+	pointcloud.width = number_of_points;
+	pointcloud.row_step = number_of_points * pointcloud.point_step;
+	pointcloud.data.resize(pointcloud.row_step);
+	for (size_t i = 0; i < pointcloud.data.size(); ++i) {
+		pointcloud.data[i] = (uint8_t)(first_byte + i);
+	}
+	pointcloud.is_dense = true;
+	return pointcloud;
+}
+
+
+void expectEqualPointClouds(const sensor_msgs::PointCloud2& expected_pointcloud, const sensor_msgs::PointCloud2& pointcloud) {
+	EXPECT_EQ(expected_pointcloud.header.seq, pointcloud.header.seq);
+	EXPECT_EQ(expected_pointcloud.header.stamp.sec, pointcloud.header.stamp.sec);
+	EXPECT_EQ(expected_pointcloud.header.stamp.nsec, pointcloud.header.stamp.nsec);
+	EXPECT_EQ(expected_pointcloud.header.frame_id, pointcloud.header.frame_id);
+	EXPECT_EQ(expected_pointcloud.height, pointcloud.height);
+	EXPECT_EQ(expected_pointcloud.width, pointcloud.width);
+	ASSERT_EQ(expected_pointcloud.fields.size(), pointcloud.fields.size());
+	EXPECT_EQ(expected_pointcloud.fields[0].name, pointcloud.fields[0].name);
+	EXPECT_EQ(expected_pointcloud.point_step, pointcloud.point_step);
+	EXPECT_EQ(expected_pointcloud.row_step, pointcloud.row_step);
+	EXPECT_TRUE(expected_pointcloud.data == pointcloud.data);
+	EXPECT_EQ(expected_pointcloud.is_dense, pointcloud.is_dense);
+}
+
+
+TEST(SharedMemoryPointCloud, ReadsWrittenPointCloud) {
+	SharedMemoryPointCloudPublisher publisher;
+	ASSERT_TRUE(publisher.open(createSharedMemoryName("read"), 3, 4096));
+
+	sensor_msgs::PointCloud2 written_pointcloud = createPointCloud(100, 7);
+	SharedMemoryPointCloud descriptor;
+	ASSERT_TRUE(publisher.writePointCloud(written_pointcloud, descriptor));
+	EXPECT_EQ(publisher.getSharedMemoryName(), descriptor.shared_memory_name);
+	EXPECT_EQ(written_pointcloud.header.frame_id, descriptor.header.frame_id);
+
+	SharedMemoryPointCloudReader reader;
+	sensor_msgs::PointCloud2 read_pointcloud;
+	ASSERT_TRUE(reader.readPointCloud(descriptor, read_pointcloud));
+	expectEqualPointClouds(written_pointcloud, read_pointcloud);
+
+	EXPECT_FALSE(publisher.writePointCloud(createPointCloud(2000, 0), descriptor)); // does not fit in a slot
+	EXPECT_EQ(1u, publisher.getNumberOfDroppedPointClouds());
+}
+
+
+TEST(SharedMemoryPointCloud, FailsToReadOverwrittenSlot) {
+	SharedMemoryPointCloudPublisher publisher;
+	ASSERT_TRUE(publisher.open(createSharedMemoryName("overwritten"), 2, 4096));
+
+	SharedMemoryPointCloud first_descriptor, second_descriptor, third_descriptor;
+	ASSERT_TRUE(publisher.writePointCloud(createPointCloud(10, 1), first_descriptor));
+	ASSERT_TRUE(publisher.writePointCloud(createPointCloud(20, 2), second_descriptor));
+
+	SharedMemoryPointCloudReader reader;
+	sensor_msgs::PointCloud2 read_pointcloud;
+	EXPECT_TRUE(reader.readPointCloud(first_descriptor, read_pointcloud));
+
+	sensor_msgs::PointCloud2 third_pointcloud = createPointCloud(30, 3);
+	ASSERT_TRUE(publisher.writePointCloud(third_pointcloud, third_descriptor));
+	EXPECT_EQ(first_descriptor.slot, third_descriptor.slot);
+	EXPECT_FALSE(reader.readPointCloud(first_descriptor, read_pointcloud));
+
+	ASSERT_TRUE(reader.readPointCloud(third_descriptor, read_pointcloud));
+	expectEqualPointClouds(third_pointcloud, read_pointcloud);
+}
+
+
+TEST(SharedMemoryPointCloud, ReopensRingCreatedAgainWithSameName) {
+	std::string shared_memory_name = createSharedMemoryName("reopen");
+	SharedMemoryPointCloudReader reader;
+	sensor_msgs::PointCloud2 read_pointcloud;
+
+	SharedMemoryPointCloudPublisher first_publisher;
+	ASSERT_TRUE(first_publisher.open(shared_memory_name, 2, 4096));
+	SharedMemoryPointCloud first_descriptor;
+	ASSERT_TRUE(first_publisher.writePointCloud(createPointCloud(10, 1), first_descriptor));
+	ASSERT_TRUE(reader.readPointCloud(first_descriptor, read_pointcloud));
+	first_publisher.close(); // the reader keeps its mapping of the removed ring
+
+	// a restarted publisher writes its first cloud in the same slot and with the same sequence, but in a new ring
+	SharedMemoryPointCloudPublisher second_publisher;
+	ASSERT_TRUE(second_publisher.open(shared_memory_name, 2, 4096));
+	sensor_msgs::PointCloud2 second_pointcloud = createPointCloud(10, 100);
+	SharedMemoryPointCloud second_descriptor;
+	ASSERT_TRUE(second_publisher.writePointCloud(second_pointcloud, second_descriptor));
+	EXPECT_EQ(first_descriptor.slot, second_descriptor.slot);
+	EXPECT_EQ(first_descriptor.sequence, second_descriptor.sequence);
+	EXPECT_NE(first_descriptor.ring_nonce, second_descriptor.ring_nonce);
+
+	ASSERT_TRUE(reader.readPointCloud(second_descriptor, read_pointcloud));
+	expectEqualPointClouds(second_pointcloud, read_pointcloud);
+}
+
+
+int main(int argc, char** argv) {
+	testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,101 @@
+/**\file test_voxel_hash_grid.cpp
+ * \brief Tests of the hash grid that merges points into voxel centroids.
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+#include <gtest/gtest.h>
+#include <limits>
+#include <laserscan_to_pointcloud/voxel_hash_grid.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+using laserscan_to_pointcloud::VoxelHashGrid;
+
+/** Gives access to the hash table to check that clear() resets all the used slots */
+class VoxelHashGridTester : public VoxelHashGrid {
+	public:
+		VoxelHashGridTester(double voxel_size) : VoxelHashGrid(voxel_size) {}
+		size_t getNumberOfUsedHashTableSlots() const { return hash_table_.size() - std::count(hash_table_.begin(), hash_table_.end(), 0); }
+		size_t getHashTableSize() const { return hash_table_.size(); }
+};
+
+
+TEST(VoxelHashGrid, MergesPointsOfSameVoxel) {
+	VoxelHashGrid grid(1.0);
+	grid.addPoint(0.1, 0.1, 0.1, 1.0);
+	grid.addPoint(0.9, 0.9, 0.9, 3.0);
+	grid.addPoint(-0.1, 0.1, 0.1, 5.0);
+	ASSERT_EQ(2u, grid.getNumberOfOccupiedVoxels());
+
+	const VoxelHashGrid::Voxel& voxel = grid.getVoxels()[0];
+	EXPECT_EQ(2u, voxel.number_of_points);
+	EXPECT_DOUBLE_EQ(1.0, voxel.sum_x);
+	EXPECT_DOUBLE_EQ(4.0, voxel.sum_intensity);
+	EXPECT_NE(grid.getVoxels()[0].key, grid.getVoxels()[1].key);
+}
+
+
+TEST(VoxelHashGrid, IgnoresNonFinitePoints) {
+	VoxelHashGrid grid(1.0);
+	grid.addPoint(std::numeric_limits<double>::infinity(), 0.5, 0.5, 1.0);
+	grid.addPoint(0.5, -std::numeric_limits<double>::infinity(), 0.5, 1.0);
+	grid.addPoint(0.5, 0.5, std::numeric_limits<double>::quiet_NaN(), 1.0);
+	EXPECT_EQ(0u, grid.getNumberOfOccupiedVoxels());
+
+	grid.addPoint(0.5, 0.5, 0.5, 1.0);
+	EXPECT_EQ(1u, grid.getNumberOfOccupiedVoxels());
+}
+
+
+TEST(VoxelHashGrid, MergesVoxelsIntoVoxelOfCentroid) {
+	VoxelHashGrid fine_grid(0.1);
+	fine_grid.addPoint(0.05, 0.05, 0.05, 1.0);
+	fine_grid.addPoint(0.15, 0.05, 0.05, 1.0);
+
+	VoxelHashGrid coarse_grid(1.0);
+	for (size_t i = 0; i < fine_grid.getNumberOfOccupiedVoxels(); ++i) {
+		coarse_grid.addVoxel(fine_grid.getVoxels()[i]);
+	}
+	ASSERT_EQ(1u, coarse_grid.getNumberOfOccupiedVoxels());
+	EXPECT_EQ(2u, coarse_grid.getVoxels()[0].number_of_points);
+	EXPECT_DOUBLE_EQ(0.2, coarse_grid.getVoxels()[0].sum_x);
+}
+
+
+TEST(VoxelHashGrid, ClearResetsUsedSlotsOfSparseTable) {
+	VoxelHashGridTester grid(0.01);
+	grid.reserve(100000); // sparse table -> clear() only resets the slots of the voxels in reverse insertion order
+	for (size_t i = 0; i < 1000; ++i) {
+		grid.addPoint(((double)(i % 37) + 0.5) * 0.01, ((double)(i / 37) + 0.5) * 0.01, 0.0, 1.0);
+	}
+	ASSERT_EQ(1000u, grid.getNumberOfOccupiedVoxels());
+	ASSERT_LT(grid.getNumberOfOccupiedVoxels() * 8, grid.getHashTableSize());
+	EXPECT_EQ(1000u, grid.getNumberOfUsedHashTableSlots());
+
+	grid.clear();
+	EXPECT_EQ(0u, grid.getNumberOfOccupiedVoxels());
+	EXPECT_EQ(0u, grid.getNumberOfUsedHashTableSlots());
+
+	grid.addPoint(0.0, 0.0, 0.0, 1.0);
+	grid.addPoint(0.001, 0.0, 0.0, 1.0);
+	EXPECT_EQ(1u, grid.getNumberOfOccupiedVoxels());
+}
+
+
+TEST(VoxelHashGrid, ClearResetsDenseTable) {
+	VoxelHashGridTester grid(0.01);
+	for (size_t i = 0; i < 300; ++i) {
+		grid.addPoint(((double)i + 0.5) * 0.01, 0.0, 0.0, 1.0);
+	}
+	grid.clear();
+	EXPECT_EQ(0u, grid.getNumberOfUsedHashTableSlots());
+}
+
+
+int main(int argc, char** argv) {
+	testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}